@@ -0,0 +1,664 @@
+#include "syntheticlibrary.h"
+#include "calibreimporter.h"
+#include "cataloguesnapshot.h"
+#include "namecompletionindex.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QRegularExpression>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+#include <cstdio>
+#include <functional>
+#include <utility>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+/**
+ * @file benchmark.cpp
+ * @brief Benchmarks of the database hot paths on a synthetic library.
+ *
+ * Every benchmark prints one JSON object per line to standard output, e.g.
+ *
+ *   {"benchmark":"GetAllBooks","operations":5,"rows":10000,"total_ms":212.4,
+ *    "ns_per_op":42480000,"ops_per_sec":23.5,"rows_per_sec":47080,
+ *    "books":10000,"seed":42,"profile":"balanced"}
+ *
+ * so runs can be appended to a file and compared across commits. Logging
+ * goes to standard error. Memory benchmarks add "heap_bytes", the growth of
+ * the heap while their structures are alive, where the C library reports it.
+ *
+ * Benchmarks ending in "/Legacy" replay an implementation that has since been
+ * replaced, so the gain can be measured on the same library.
+ */
+
+namespace {
+
+/**
+ * @brief Runs benchmarks and prints their results.
+ */
+class BenchmarkRunner
+{
+public:
+    BenchmarkRunner(const QJsonObject& context, const QRegularExpression& filter)
+        : context(context),
+          filter(filter)
+    {
+    }
+
+    /**
+     * @brief Times a benchmark.
+     * 
+     * @param name Name of the benchmark.
+     * @param operations Number of operations the body performs.
+     * @param body Performs the operations, returns the rows it produced or -1 on failure.
+     * @return bool false if the benchmark failed.
+     */
+    bool Run(const QString& name, qint64 operations, const std::function<qint64()>& body)
+    {
+        if (!filter.match(name).hasMatch()) {
+            return true;
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        qint64 rows = body();
+        qint64 elapsed_ns = timer.nsecsElapsed();
+
+        if (rows < 0) {
+            qCritical() << "Benchmark" << name << "failed";
+            return false;
+        }
+
+        QJsonObject result = context;
+        result.insert("benchmark", name);
+        result.insert("operations", operations);
+        result.insert("rows", rows);
+        result.insert("total_ms", elapsed_ns / 1e6);
+        result.insert("ns_per_op", operations > 0 ? static_cast<double>(elapsed_ns) / operations : 0.0);
+        result.insert("ops_per_sec", elapsed_ns > 0 ? operations * 1e9 / elapsed_ns : 0.0);
+        result.insert("rows_per_sec", elapsed_ns > 0 ? rows * 1e9 / elapsed_ns : 0.0);
+        for (auto it = fields.constBegin(); it != fields.constEnd(); ++it) {
+            result.insert(it.key(), it.value());
+        }
+        fields = QJsonObject();
+
+        std::fputs(QJsonDocument(result).toJson(QJsonDocument::Compact).constData(), stdout);
+        std::fputc('\n', stdout);
+        std::fflush(stdout);
+        return true;
+    }
+
+    /**
+     * @brief Adds a field to the result of the running benchmark.
+     * 
+     * @param key Name of the field.
+     * @param value Value of the field.
+     */
+    void Report(const QString& key, const QJsonValue& value)
+    {
+        fields.insert(key, value);
+    }
+
+private:
+    QJsonObject context; ///< Fields added to every result
+    QJsonObject fields; ///< Fields reported by the running benchmark
+    QRegularExpression filter; ///< Benchmarks whose names do not match are skipped
+};
+
+// Lists the book labels as GetAllBooks() did before ListBooks(): one author query per book
+qint64 LegacyGetAllBooks(DatabaseManager* database_manager, BookManager* book_manager)
+{
+    QSqlQuery query(database_manager->GetDatabase());
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT id, title FROM Book")) {
+        qCritical() << "LegacyGetAllBooks:" << query.lastError().text();
+        return -1;
+    }
+
+    QMap<int, QString> books;
+    while (query.next()) {
+        int book_id = query.value(0).toInt();
+        QStringList authors = book_manager->GetAuthorsForBook(book_id);
+        books.insert(book_id, BookManager::BookLabel(BookListRow{book_id, query.value(1).toString(), authors}));
+    }
+    return books.size();
+}
+
+// Inserts a book as InsertBook() did before ScopedTransaction: every statement autocommits
+int LegacyInsertBook(Library* library, const BookData& book_data)
+{
+    QSqlQuery query(library->database_manager->GetDatabase());
+    query.prepare("INSERT INTO Book (title, org_lang_id, country_id, type) VALUES (:title, :org_lang_id, :country_id, :type)");
+    query.bindValue(":title", book_data.title);
+    query.bindValue(":org_lang_id", QVariant(QVariant::Int));
+    query.bindValue(":country_id", QVariant(QVariant::Int));
+    query.bindValue(":type", QVariant(QVariant::String));
+    if (!query.exec()) {
+        qCritical() << "LegacyInsertBook:" << query.lastError().text();
+        return -1;
+    }
+    int book_id = query.lastInsertId().toInt();
+
+    auto link = [&query, book_id](const QString& sql, int id) {
+        query.prepare(sql);
+        query.bindValue(":book_id", book_id);
+        query.bindValue(":id", id);
+        return id != -1 && query.exec();
+    };
+
+    for (const QString& author : book_data.authors) {
+        if (!link("INSERT OR IGNORE INTO Book2Author (book_id, author_id) VALUES (:book_id, :id)",
+                  library->author_manager->InsertIfNotExists(author))) {
+            return -1;
+        }
+    }
+    for (const QString& genre : book_data.genres) {
+        if (!genre.trimmed().isEmpty()
+            && !link("INSERT OR IGNORE INTO Book2Genre (book_id, genre_id) VALUES (:book_id, :id)",
+                     library->genre_manager->InsertIfNotExists(genre))) {
+            return -1;
+        }
+    }
+    return book_id;
+}
+
+// Bytes allocated on the heap, -1 where the C library does not report them
+qint64 HeapInUse()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    return static_cast<qint64>(info.uordblks + info.hblkhd);
+#else
+    return -1;
+#endif
+}
+
+// Writes records as a Goodreads style CSV file
+bool WriteCsv(const QString& path, SyntheticLibrary& generator, int count)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qCritical() << "Cannot write" << path << ":" << file.errorString();
+        return false;
+    }
+
+    auto quote = [](QString value) {
+        return "\"" + value.replace('"', "\"\"") + "\"";
+    };
+
+    QTextStream out(&file);
+    out << "Title,Author,Additional Authors,Publisher,Number of Pages,ISBN13,Year Published,Binding,Date Added,Shelf\n";
+    for (int i = 0; i < count; ++i) {
+        ImportRecord record = generator.NextRecord();
+        out << quote(record.title) << ','
+            << quote(record.authors.value(0)) << ','
+            << quote(record.authors.mid(1).join(", ")) << ','
+            << quote(record.publisher) << ','
+            << record.page_count << ','
+            << "=\"" << record.isbn << "\","
+            << record.publication_date << ','
+            << record.edition_type << ','
+            << record.acquired_date.toString("yyyy/MM/dd") << ','
+            << quote(record.shelf) << '\n';
+    }
+
+    return true;
+}
+
+// Writes records as the metadata.db of a Calibre library, with the tables and indexes CalibreImporter reads
+bool WriteCalibreLibrary(const QString& path, SyntheticLibrary& generator, int count)
+{
+    const QString connection_name = "benchmark-calibre";
+    bool ok = true;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connection_name);
+        db.setDatabaseName(path);
+        if (!db.open()) {
+            qCritical() << "Cannot write" << path << ":" << db.lastError().text();
+            ok = false;
+        }
+
+        QSqlQuery query(db);
+        const QStringList schema = {
+            "CREATE TABLE books (id INTEGER PRIMARY KEY AUTOINCREMENT, title TEXT NOT NULL DEFAULT 'Unknown', "
+            "sort TEXT, timestamp TIMESTAMP, pubdate TIMESTAMP, series_index REAL NOT NULL DEFAULT 1.0, "
+            "author_sort TEXT, isbn TEXT DEFAULT '', lccn TEXT DEFAULT '', path TEXT NOT NULL DEFAULT '', "
+            "flags INTEGER NOT NULL DEFAULT 1, uuid TEXT, has_cover BOOL DEFAULT 0, last_modified TIMESTAMP)",
+            "CREATE TABLE authors (id INTEGER PRIMARY KEY, name TEXT NOT NULL COLLATE NOCASE, sort TEXT, link TEXT NOT NULL DEFAULT '', UNIQUE(name))",
+            "CREATE TABLE books_authors_link (id INTEGER PRIMARY KEY, book INTEGER NOT NULL, author INTEGER NOT NULL, UNIQUE(book, author))",
+            "CREATE TABLE tags (id INTEGER PRIMARY KEY, name TEXT NOT NULL COLLATE NOCASE, UNIQUE(name))",
+            "CREATE TABLE books_tags_link (id INTEGER PRIMARY KEY, book INTEGER NOT NULL, tag INTEGER NOT NULL, UNIQUE(book, tag))",
+            "CREATE TABLE publishers (id INTEGER PRIMARY KEY, name TEXT NOT NULL COLLATE NOCASE, sort TEXT, UNIQUE(name))",
+            "CREATE TABLE books_publishers_link (id INTEGER PRIMARY KEY, book INTEGER NOT NULL, publisher INTEGER NOT NULL, UNIQUE(book))",
+            "CREATE TABLE series (id INTEGER PRIMARY KEY, name TEXT NOT NULL COLLATE NOCASE, sort TEXT, UNIQUE(name))",
+            "CREATE TABLE books_series_link (id INTEGER PRIMARY KEY, book INTEGER NOT NULL, series INTEGER NOT NULL, UNIQUE(book))",
+            "CREATE TABLE languages (id INTEGER PRIMARY KEY, lang_code TEXT NOT NULL COLLATE NOCASE, UNIQUE(lang_code))",
+            "CREATE TABLE books_languages_link (id INTEGER PRIMARY KEY, book INTEGER NOT NULL, lang_code INTEGER NOT NULL, "
+            "item_order INTEGER NOT NULL DEFAULT 0, UNIQUE(book, lang_code))",
+            "CREATE TABLE identifiers (id INTEGER PRIMARY KEY, book INTEGER NOT NULL, type TEXT NOT NULL DEFAULT 'isbn' COLLATE NOCASE, "
+            "val TEXT NOT NULL COLLATE NOCASE, UNIQUE(book, type))",
+            "CREATE TABLE library_id (id INTEGER PRIMARY KEY, uuid TEXT NOT NULL, UNIQUE(uuid))",
+            "CREATE INDEX books_authors_link_aidx ON books_authors_link (author)",
+            "CREATE INDEX books_tags_link_aidx ON books_tags_link (tag)",
+            "INSERT INTO library_id (uuid) VALUES ('00000000-0000-4000-8000-000000000042')",
+        };
+        for (const QString& statement : schema) {
+            ok = ok && query.exec(statement);
+        }
+
+        // Names are numbered in order of appearance, as Calibre assigns them
+        QHash<QString, int> author_ids, tag_ids, publisher_ids, series_ids, language_ids;
+        auto link = [&](const QString& table, const QString& link_table, const QString& column,
+                        QHash<QString, int>& ids, const QString& name, int book_id) {
+            int id = ids.value(name);
+            if (id == 0) {
+                id = ids.size() + 1;
+                ids.insert(name, id);
+                query.prepare(QString("INSERT INTO %1 (id, %2) VALUES (:id, :name)").arg(table, table == "languages" ? "lang_code" : "name"));
+                query.bindValue(":id", id);
+                query.bindValue(":name", name);
+                if (!query.exec()) {
+                    return false;
+                }
+            }
+            query.prepare(QString("INSERT INTO %1 (book, %2) VALUES (:book, :id)").arg(link_table, column));
+            query.bindValue(":book", book_id);
+            query.bindValue(":id", id);
+            return query.exec();
+        };
+
+        ok = ok && db.transaction();
+        for (int book_id = 1; ok && book_id <= count; ++book_id) {
+            ImportRecord record = generator.NextRecord();
+
+            query.prepare("INSERT INTO books (id, title, sort, timestamp, pubdate, author_sort, path, uuid, has_cover) "
+                          "VALUES (:id, :title, :title, :timestamp, :pubdate, :author_sort, :path, :uuid, 0)");
+            query.bindValue(":id", book_id);
+            query.bindValue(":title", record.title);
+            query.bindValue(":timestamp", record.acquired_date.toString("yyyy-MM-dd hh:mm:ss+00:00"));
+            query.bindValue(":pubdate", record.publication_date + "-01-01 00:00:00+00:00");
+            query.bindValue(":author_sort", record.authors.value(0));
+            query.bindValue(":path", QString("%1/%2 (%3)").arg(record.authors.value(0), record.title).arg(book_id));
+            query.bindValue(":uuid", QString("00000000-0000-4000-8000-%1").arg(book_id, 12, 10, QChar('0')));
+            ok = query.exec();
+
+            for (const QString& author : std::as_const(record.authors)) {
+                ok = ok && link("authors", "books_authors_link", "author", author_ids, author, book_id);
+            }
+            for (const QString& genre : std::as_const(record.genres)) {
+                ok = ok && link("tags", "books_tags_link", "tag", tag_ids, genre, book_id);
+            }
+            ok = ok && link("publishers", "books_publishers_link", "publisher", publisher_ids, record.publisher, book_id);
+            if (!record.series.isEmpty()) {
+                ok = ok && link("series", "books_series_link", "series", series_ids, record.series, book_id);
+            }
+            // Calibre stores ISO 639 codes; the names pass through the importer's mapping unchanged
+            ok = ok && link("languages", "books_languages_link", "lang_code", language_ids, record.language, book_id);
+
+            if (ok) {
+                query.prepare("INSERT INTO identifiers (book, type, val) VALUES (:book, 'isbn', :val)");
+                query.bindValue(":book", book_id);
+                query.bindValue(":val", record.isbn);
+                ok = query.exec();
+            }
+        }
+        if (ok && !db.commit()) {
+            qCritical() << "WriteCalibreLibrary:" << db.lastError().text();
+            ok = false;
+        }
+        else if (!ok && db.isOpen()) {
+            qCritical() << "WriteCalibreLibrary:" << query.lastError().text();
+        }
+
+        query.finish();
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connection_name);
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("reading-tracker-bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmarks the reading tracker database on a synthetic library.");
+    parser.addHelpOption();
+    QCommandLineOption books_option("books", "Books in the synthetic library.", "count", "10000");
+    QCommandLineOption operations_option("operations", "Operations of the insert and lookup benchmarks.", "count", "1000");
+    QCommandLineOption iterations_option("iterations", "Repetitions of the list benchmarks.", "count", "5");
+    QCommandLineOption seed_option("seed", "Seed of the generator.", "seed", "42");
+    QCommandLineOption zipf_option("zipf", "Zipf exponent of the author and publisher frequencies.", "exponent", "1.07");
+    QCommandLineOption profile_option("profile", "Database profile: " + DatabaseProfile::Names().join(", ") + ".", "name", "balanced");
+    QCommandLineOption database_option("database", "Database file to create, a temporary file by default.", "path");
+    QCommandLineOption filter_option("filter", "Only run the benchmarks matching a regular expression.", "regex", ".");
+    QCommandLineOption verbose_option("verbose", "Keep debug and info logging.");
+    parser.addOptions({books_option, operations_option, iterations_option, seed_option, zipf_option,
+                       profile_option, database_option, filter_option, verbose_option});
+    parser.process(app);
+
+    if (!parser.isSet(verbose_option)) {
+        QLoggingCategory::setFilterRules("*.debug=false\n*.info=false");
+    }
+
+    SyntheticLibraryOptions options;
+    options.book_count = parser.value(books_option).toInt();
+    options.seed = parser.value(seed_option).toUInt();
+    options.zipf_exponent = parser.value(zipf_option).toDouble();
+    const int operations = qMax(1, parser.value(operations_option).toInt());
+    const int iterations = qMax(1, parser.value(iterations_option).toInt());
+
+    bool profile_ok = false;
+    DatabaseProfile profile = DatabaseProfile::Named(parser.value(profile_option), &profile_ok);
+    if (!profile_ok) {
+        qCritical() << "Unknown profile" << parser.value(profile_option);
+        return 1;
+    }
+
+    QRegularExpression filter(parser.value(filter_option));
+    if (!filter.isValid()) {
+        qCritical() << "Invalid filter:" << filter.errorString();
+        return 1;
+    }
+
+    // Every run starts from an empty database, so results are comparable
+    QTemporaryDir temporary_dir;
+    QString database_path = parser.isSet(database_option)
+        ? parser.value(database_option)
+        : temporary_dir.filePath("benchmark.db");
+    if (QFile::exists(database_path)) {
+        qCritical() << "Refusing to reuse the existing database" << database_path;
+        return 1;
+    }
+
+    DatabaseManager database_manager("benchmark", database_path, profile, ConnectionRole::Writer);
+    if (!database_manager.GetDatabase().isOpen()) {
+        return 1;
+    }
+    Library library(&database_manager);
+
+    QJsonObject context;
+    context.insert("books", options.book_count);
+    context.insert("seed", static_cast<qint64>(options.seed));
+    context.insert("zipf", options.zipf_exponent);
+    context.insert("profile", profile.name);
+    BenchmarkRunner runner(context, filter);
+
+    SyntheticLibrary generator(options);
+    bool ok = true;
+
+    // Populating is always timed, every other benchmark needs the library
+    ok &= BenchmarkRunner(context, QRegularExpression(".")).Run("Populate", options.book_count, [&]() -> qint64 {
+        return generator.Populate(&library);
+    });
+    if (!ok) {
+        return 1;
+    }
+
+    // One fsync per statement, against one per book below
+    ok &= runner.Run("InsertBook/Legacy", operations, [&]() -> qint64 {
+        for (int i = 0; i < operations; ++i) {
+            if (LegacyInsertBook(&library, generator.NextBook()) == -1) {
+                return -1;
+            }
+        }
+        return operations;
+    });
+
+    ok &= runner.Run("InsertBook", operations, [&]() -> qint64 {
+        for (int i = 0; i < operations; ++i) {
+            if (library.book_manager->InsertBook(generator.NextBook()) == -1) {
+                return -1;
+            }
+        }
+        return operations;
+    });
+
+    ok &= runner.Run("InsertEdition", operations, [&]() -> qint64 {
+        for (int i = 0; i < operations; ++i) {
+            int book_id = 1 + generator.Uniform(qMax(1, options.book_count));
+            if (library.edition_manager->InsertEdition(generator.NextEdition(book_id)) == -1) {
+                return -1;
+            }
+        }
+        return operations;
+    });
+
+    ok &= runner.Run("GetAllBooks", iterations, [&]() -> qint64 {
+        qint64 rows = 0;
+        for (int i = 0; i < iterations; ++i) {
+            rows = library.book_manager->GetAllBooks().size();
+        }
+        return rows;
+    });
+
+    ok &= runner.Run("GetAllBooks/Legacy", iterations, [&]() -> qint64 {
+        qint64 rows = 0;
+        for (int i = 0; i < iterations; ++i) {
+            rows = LegacyGetAllBooks(&database_manager, library.book_manager);
+            if (rows < 0) {
+                return -1;
+            }
+        }
+        return rows;
+    });
+
+    ok &= runner.Run("ListBooks", iterations, [&]() -> qint64 {
+        qint64 rows = 0;
+        for (int i = 0; i < iterations; ++i) {
+            rows = library.book_manager->ListBooks().size();
+        }
+        return rows;
+    });
+
+    ok &= runner.Run("GetAllEditions", iterations, [&]() -> qint64 {
+        qint64 rows = 0;
+        for (int i = 0; i < iterations; ++i) {
+            rows = library.edition_manager->GetAllEditions().size();
+        }
+        return rows;
+    });
+
+    ok &= runner.Run("GetAllRItems", iterations, [&]() -> qint64 {
+        qint64 rows = 0;
+        for (int i = 0; i < iterations; ++i) {
+            rows = library.r_item_manager->GetAllRItems().size();
+        }
+        return rows;
+    });
+
+    // Walks the whole table a page at a time, ns_per_op is the cost of one page
+    const QList<QPair<QString, BookSortKey>> book_orders = {
+        {"Id", BookSortKey::Id},
+        {"Title", BookSortKey::Title},
+    };
+    for (const auto& order : book_orders) {
+        const int page_size = 100;
+        const int pages = (options.book_count + operations) / page_size + 1;
+        ok &= runner.Run("ListBooksPage/" + order.first, pages, [&]() -> qint64 {
+            qint64 rows = 0;
+            PageCursor after;
+            for (int i = 0; i < pages; ++i) {
+                const QList<BookListRow> page = library.book_manager->ListBooksPage(order.second, after, page_size);
+                rows += page.size();
+                if (page.size() < page_size) {
+                    break;
+                }
+                after = BookManager::CursorAfter(page.last(), order.second);
+            }
+            return rows;
+        });
+    }
+
+    ok &= runner.Run("CatalogueSnapshot/Load", iterations, [&]() -> qint64 {
+        qint64 rows = 0;
+        for (int i = 0; i < iterations; ++i) {
+            QSharedPointer<const CatalogueSnapshot> snapshot = CatalogueSnapshot::Load(library);
+            if (!snapshot) {
+                return -1;
+            }
+            rows = snapshot->BookCount() + snapshot->EditionCount() + snapshot->RItemCount();
+        }
+        return rows;
+    });
+
+    // The maps the combo boxes were filled from, against one snapshot of the same rows
+    ok &= runner.Run("Memory/GetAllMaps", 1, [&]() -> qint64 {
+        qint64 heap_before = HeapInUse();
+        QMap<int, QString> books = library.book_manager->GetAllBooks();
+        QMap<int, QString> editions = library.edition_manager->GetAllEditions();
+        QMap<int, QString> r_items = library.r_item_manager->GetAllRItems();
+        qint64 heap_after = HeapInUse();
+        if (heap_before >= 0) {
+            runner.Report("heap_bytes", heap_after - heap_before);
+        }
+        return books.size() + editions.size() + r_items.size();
+    });
+
+    ok &= runner.Run("Memory/CatalogueSnapshot", 1, [&]() -> qint64 {
+        qint64 heap_before = HeapInUse();
+        QSharedPointer<const CatalogueSnapshot> snapshot = CatalogueSnapshot::Load(library);
+        qint64 heap_after = HeapInUse();
+        if (!snapshot) {
+            return -1;
+        }
+        if (heap_before >= 0) {
+            runner.Report("heap_bytes", heap_after - heap_before);
+        }
+        runner.Report("snapshot_bytes", snapshot->MemoryUsage());
+        return snapshot->BookCount() + snapshot->EditionCount() + snapshot->RItemCount();
+    });
+
+    // Bringing a snapshot up to date after inserts reads only the new rows
+    if (filter.match("CatalogueSnapshot/Append").hasMatch()) {
+        QSharedPointer<const CatalogueSnapshot> base = CatalogueSnapshot::Load(library);
+        bool inserted = base != nullptr;
+        for (int i = 0; inserted && i < operations; ++i) {
+            int book_id = library.book_manager->InsertBook(generator.NextBook());
+            inserted = book_id != -1 && library.r_item_manager->InsertEdition(generator.NextEdition(book_id)) != -1;
+        }
+        if (!inserted) {
+            qCritical() << "Benchmark CatalogueSnapshot/Append failed to insert its rows";
+            return 1;
+        }
+        ok &= runner.Run("CatalogueSnapshot/Append", iterations, [&]() -> qint64 {
+            qint64 rows = 0;
+            for (int i = 0; i < iterations; ++i) {
+                QSharedPointer<const CatalogueSnapshot> snapshot = CatalogueSnapshot::Load(library, base);
+                if (!snapshot) {
+                    return -1;
+                }
+                rows = snapshot->BookCount() - base->BookCount();
+            }
+            return rows;
+        });
+    }
+
+    const QList<QPair<QString, IdNameTable>> name_tables = {
+        {"Author", IdNameTable::Author},
+        {"Publisher", IdNameTable::Publisher},
+        {"Genre", IdNameTable::Genre},
+    };
+    for (const auto& table : name_tables) {
+        IdNameTableManager* manager = library.GetIdNameTableManager(table.second);
+        ok &= runner.Run("GetAllNames/" + table.first, iterations, [&]() -> qint64 {
+            qint64 rows = 0;
+            for (int i = 0; i < iterations; ++i) {
+                rows = manager->GetAllNames().size();
+            }
+            return rows;
+        });
+    }
+
+    // Lookups follow the Zipf frequencies, as name resolution during inserts does
+    QStringList author_names;
+    const int lookup_count = operations * 10;
+    for (int i = 0; i < lookup_count; ++i) {
+        author_names.append(generator.SampleAuthor());
+    }
+    for (bool cached : {false, true}) {
+        IdNameTableManager* manager = library.author_manager;
+        bool was_enabled = manager->IsCacheEnabled();
+        manager->SetCacheEnabled(cached);
+        ok &= runner.Run(QString("GetIdByName/Author/%1").arg(cached ? "cached" : "uncached"), lookup_count, [&]() -> qint64 {
+            qint64 found = 0;
+            for (const QString& name : std::as_const(author_names)) {
+                found += manager->GetIdByName(name) != -1 ? 1 : 0;
+            }
+            return found;
+        });
+        manager->SetCacheEnabled(was_enabled);
+    }
+
+    QStringList search_terms;
+    for (int i = 0; i < operations; ++i) {
+        QString author = generator.SampleAuthor();
+        search_terms.append(author.section(' ', 1).left(4)); // A surname prefix
+    }
+    ok &= runner.Run("Search", search_terms.size(), [&]() -> qint64 {
+        qint64 rows = 0;
+        for (const QString& term : std::as_const(search_terms)) {
+            rows += library.search_manager->Search(term).size();
+        }
+        return rows;
+    });
+
+    // Infixes of author names as typed into a completer, 20 names shown like the popup
+    if (filter.match("NameCompletion/Find").hasMatch()) {
+        NameCompletionIndex completion_index;
+        completion_index.Reset(library.author_manager->GetAllNames());
+        for (int length : {1, 2, 4}) {
+            QStringList queries;
+            for (int i = 0; i < operations; ++i) {
+                QString author = generator.SampleAuthor();
+                queries.append(author.mid(generator.Uniform(qMax(1, int(author.size()) - length + 1)), length));
+            }
+            ok &= runner.Run(QString("NameCompletion/Find/%1").arg(length), queries.size(), [&]() -> qint64 {
+                qint64 rows = 0;
+                for (const QString& query : std::as_const(queries)) {
+                    rows += completion_index.Find(query, 20).size();
+                }
+                return rows;
+            });
+        }
+    }
+
+    if (filter.match("ImportCsv").hasMatch()) {
+        QString csv_path = QFileInfo(database_path).dir().filePath("benchmark-import.csv");
+        int record_count = operations * 10;
+        ok &= WriteCsv(csv_path, generator, record_count);
+        ok &= runner.Run("ImportCsv", record_count, [&]() -> qint64 {
+            LibraryImporter importer(&library);
+            return importer.ImportFile(csv_path);
+        });
+        QFile::remove(csv_path);
+    }
+
+    // As many books as the library, so --books 50000 times the import of a large Calibre library
+    if (filter.match("CalibreImport").hasMatch()) {
+        QString metadata_path = QFileInfo(database_path).dir().filePath("benchmark-calibre/metadata.db");
+        ok &= QDir().mkpath(QFileInfo(metadata_path).path());
+        ok &= WriteCalibreLibrary(metadata_path, generator, options.book_count);
+        ok &= runner.Run("CalibreImport", options.book_count, [&]() -> qint64 {
+            CalibreImporter importer(&library);
+            return importer.Import(metadata_path);
+        });
+        QDir(QFileInfo(metadata_path).path()).removeRecursively();
+    }
+
+    return ok ? 0 : 1;
+}
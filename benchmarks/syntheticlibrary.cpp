@@ -0,0 +1,257 @@
+#include "syntheticlibrary.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const char* const kSyllables[] = {
+    "ka", "lo", "mi", "ra", "te", "su", "no", "vi",
+    "an", "el", "or", "is", "ub", "en", "da", "po",
+};
+const int kSyllableCount = 16;
+
+const char* const kFirstNames[] = {
+    "Anna", "Boris", "Clara", "David", "Elena", "Farid", "Greta", "Hugo",
+    "Ines", "Jonas", "Kira", "Leon", "Mara", "Nils", "Olga", "Pavel",
+    "Rosa", "Stefan", "Tara", "Umar", "Vera", "Wim", "Yara", "Zeno",
+};
+const int kFirstNameCount = 24;
+
+const char* const kGenres[] = {
+    "Fiction", "Fantasy", "Science Fiction", "Mystery", "Thriller", "Romance",
+    "Historical Fiction", "Biography", "History", "Poetry", "Horror", "Philosophy",
+    "Science", "Travel", "Essays", "Drama", "Humor", "Classics", "Young Adult",
+    "Children", "Graphic Novels", "Short Stories", "Politics", "Economics",
+};
+const int kGenreCount = 24;
+
+const char* const kLanguages[] = {
+    "English", "German", "French", "Spanish", "Russian", "Italian", "Japanese",
+    "Portuguese", "Polish", "Dutch", "Swedish", "Czech", "Chinese", "Turkish",
+};
+const int kLanguageCount = 14;
+
+const char* const kEditionTypes[] = {"Paperback", "Hardcover", "Ebook", "Audiobook"};
+
+// A distinct word per number: the syllables are its base-16 digits
+QString Word(quint32 number, int min_syllables)
+{
+    QString word;
+    int count = 0;
+    do {
+        word += kSyllables[number % kSyllableCount];
+        number /= kSyllableCount;
+        count++;
+    } while (number > 0 || count < min_syllables);
+
+    word[0] = word[0].toUpper();
+    return word;
+}
+
+SyntheticLibraryOptions ResolveOptions(SyntheticLibraryOptions options)
+{
+    options.book_count = qMax(0, options.book_count);
+    if (options.author_count <= 0) {
+        options.author_count = qMax(1, options.book_count / 4);
+    }
+    if (options.publisher_count <= 0) {
+        options.publisher_count = qMax(1, options.book_count / 50);
+    }
+    return options;
+}
+
+} // namespace
+
+ZipfDistribution::ZipfDistribution(int n, double exponent)
+{
+    cumulative.reserve(qMax(1, n));
+
+    double sum = 0.0;
+    for (int rank = 0; rank < qMax(1, n); ++rank) {
+        sum += 1.0 / std::pow(rank + 1.0, exponent);
+        cumulative.append(sum);
+    }
+    for (double& value : cumulative) {
+        value /= sum;
+    }
+}
+
+int ZipfDistribution::operator()(std::mt19937& engine) const
+{
+    // std::uniform_real_distribution differs between standard libraries, so scale by hand
+    double unit = engine() / 4294967296.0;
+    auto it = std::upper_bound(cumulative.constBegin(), cumulative.constEnd(), unit);
+    return qMin(static_cast<int>(it - cumulative.constBegin()), static_cast<int>(cumulative.size()) - 1);
+}
+
+SyntheticLibrary::SyntheticLibrary(const SyntheticLibraryOptions& options)
+    : options(ResolveOptions(options)),
+      engine(options.seed),
+      authors(this->options.author_count, options.zipf_exponent),
+      publishers(this->options.publisher_count, options.zipf_exponent),
+      genres(kGenreCount, options.zipf_exponent),
+      languages(kLanguageCount, 2.0), // One language dominates most collections
+      next_isbn(0)
+{
+}
+
+int SyntheticLibrary::Populate(Library* library, int batch_size)
+{
+    LibraryImporter importer(library);
+
+    int written = 0;
+    while (written < options.book_count) {
+        int count = qMin(batch_size, options.book_count - written);
+
+        // Only a share of the editions is owned, the rest are known editions
+        QList<ImportRecord> owned;
+        QList<ImportRecord> known;
+        for (int i = 0; i < count; ++i) {
+            ImportRecord record = NextRecord();
+            if (NextUnit() < options.library_share) {
+                owned.append(record);
+            }
+            else {
+                known.append(record);
+            }
+        }
+
+        int owned_written = importer.ImportBatch(owned, true);
+        int known_written = importer.ImportBatch(known, false);
+        if (owned_written == -1 || known_written == -1) {
+            return -1;
+        }
+        written += count;
+    }
+
+    return written;
+}
+
+ImportRecord SyntheticLibrary::NextRecord()
+{
+    BookData book = NextBook();
+    EditionData edition = NextEdition(-1);
+
+    ImportRecord record;
+    record.title = book.title;
+    record.authors = book.authors;
+    record.original_language = book.original_language;
+    record.genres = book.genres;
+    record.publisher = edition.publisher;
+    record.language = edition.language;
+    record.series = edition.series;
+    record.page_count = edition.page_count;
+    record.isbn = edition.isbn;
+    record.publication_date = edition.publication_date;
+    record.edition_type = edition.type;
+    record.acquired_date = QDateTime(QDate(2000, 1, 1).addDays(Uniform(9000)), QTime(12, 0));
+    record.shelf = QString("Shelf %1").arg(Uniform(40) + 1);
+    if (Uniform(10) == 0) {
+        // Draws are sequenced explicitly, the order of evaluating arguments is unspecified
+        QString subject = Word(engine() % 4096, 3);
+        QString object = Word(engine() % 4096, 2);
+        record.notes = QString("Notes on %1: %2 %3.").arg(record.title, subject, object);
+    }
+    return record;
+}
+
+BookData SyntheticLibrary::NextBook()
+{
+    BookData book;
+    book.title = Title();
+
+    // Most books have one author, some are co-written
+    book.authors.append(SampleAuthor());
+    while (book.authors.size() < 4 && Uniform(8) == 0) {
+        QString author = SampleAuthor();
+        if (!book.authors.contains(author)) {
+            book.authors.append(author);
+        }
+    }
+
+    int genre_count = 1 + Uniform(3);
+    for (int i = 0; i < genre_count; ++i) {
+        QString genre = kGenres[genres(engine)];
+        if (!book.genres.contains(genre)) {
+            book.genres.append(genre);
+        }
+    }
+
+    book.original_language = kLanguages[languages(engine)];
+    return book;
+}
+
+EditionData SyntheticLibrary::NextEdition(int book_id)
+{
+    EditionData edition;
+    edition.book_id = book_id;
+    edition.publisher = SamplePublisher();
+    edition.language = kLanguages[languages(engine)];
+    if (Uniform(5) == 0) {
+        edition.series = "The " + Word(Uniform(qMax(1, options.book_count / 10)), 2) + " Cycle";
+    }
+    edition.page_count = 80 + Uniform(900);
+    edition.publication_date = QString::number(1900 + Uniform(125));
+    edition.isbn = NextIsbn();
+    edition.type = kEditionTypes[Uniform(4)];
+    return edition;
+}
+
+QString SyntheticLibrary::SampleAuthor()
+{
+    return AuthorName(authors(engine));
+}
+
+QString SyntheticLibrary::SamplePublisher()
+{
+    return PublisherName(publishers(engine));
+}
+
+int SyntheticLibrary::Uniform(int bound)
+{
+    return static_cast<int>(NextUnit() * qMax(1, bound));
+}
+
+const SyntheticLibraryOptions& SyntheticLibrary::GetOptions() const
+{
+    return options;
+}
+
+QString SyntheticLibrary::AuthorName(int rank)
+{
+    return QString("%1 %2").arg(kFirstNames[rank % kFirstNameCount], Word(rank / kFirstNameCount, 3));
+}
+
+QString SyntheticLibrary::PublisherName(int rank)
+{
+    return Word(rank, 2) + " Press";
+}
+
+double SyntheticLibrary::NextUnit()
+{
+    return engine() / 4294967296.0;
+}
+
+QString SyntheticLibrary::Title()
+{
+    static const char* const kArticles[] = {"The ", "A ", "", ""};
+    QString title = kArticles[Uniform(4)];
+    title += Word(engine() % 65536, 2);
+    if (Uniform(2) == 0) {
+        title += " of " + Word(engine() % 4096, 2);
+    }
+    return title;
+}
+
+QString SyntheticLibrary::NextIsbn()
+{
+    // 979 prefix with a serial number, unique within one generator
+    QString digits = QString("979%1").arg(next_isbn++, 9, 10, QChar('0'));
+
+    int sum = 0;
+    for (int i = 0; i < 12; ++i) {
+        sum += digits.at(i).digitValue() * (i % 2 == 0 ? 1 : 3);
+    }
+    return digits + QString::number((10 - sum % 10) % 10);
+}
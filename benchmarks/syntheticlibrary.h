@@ -0,0 +1,150 @@
+#ifndef SYNTHETIC_LIBRARY_H
+#define SYNTHETIC_LIBRARY_H
+
+#include "libraryimporter.h"
+
+#include <QVector>
+
+#include <random>
+
+/**
+ * @file syntheticlibrary.h
+ * @brief Header file for SyntheticLibrary class.
+ *
+ * SyntheticLibrary generates books for benchmarks. The output depends only
+ * on the options: the random engine is std::mt19937, whose sequence is
+ * fixed by the standard, and every distribution is implemented here, so
+ * the same seed yields the same library on every platform.
+ *
+ * Authors, publishers, genres and languages are drawn from Zipf
+ * distributions, so a few names cover most books, as in real collections.
+ */
+
+struct SyntheticLibraryOptions {
+    int book_count = 10000; ///< Books written by Populate()
+    int author_count = 0; ///< Distinct authors, 0 picks one per four books
+    int publisher_count = 0; ///< Distinct publishers, 0 picks one per fifty books
+    double zipf_exponent = 1.07; ///< Skew of the name frequencies, 0 is uniform
+    double library_share = 0.6; ///< Share of the editions added to MyLibrary
+    quint32 seed = 42; ///< Seed of the random engine
+};
+
+/**
+ * @class ZipfDistribution
+ * @brief Draws ranks 0..n-1 with probability proportional to 1 / (rank + 1)^s.
+ */
+class ZipfDistribution
+{
+public:
+    /**
+     * @brief Constructs the distribution.
+     * 
+     * @param n Number of ranks, at least 1.
+     * @param exponent The exponent s.
+     */
+    ZipfDistribution(int n, double exponent);
+
+    /**
+     * @brief Draws a rank.
+     * 
+     * @param engine The random engine.
+     * @return int The rank.
+     */
+    int operator()(std::mt19937& engine) const;
+
+private:
+    QVector<double> cumulative; ///< Cumulative probabilities of the ranks
+};
+
+/**
+ * @class SyntheticLibrary
+ * @brief Deterministic generator of books, editions and library entries.
+ */
+class SyntheticLibrary
+{
+public:
+    /**
+     * @brief Constructs a generator.
+     * 
+     * @param options Size, skew and seed of the library.
+     */
+    explicit SyntheticLibrary(const SyntheticLibraryOptions& options = SyntheticLibraryOptions());
+
+    /**
+     * @brief Writes options.book_count books, with an edition and a readable item each.
+     * 
+     * @param library The library to write to, normally empty.
+     * @param batch_size Books written per transaction.
+     * @return int The number of books written, or -1 on failure.
+     */
+    int Populate(Library* library, int batch_size = 5000);
+
+    /**
+     * @brief Generates the next book with its edition and library entry.
+     * 
+     * @return ImportRecord The record, with a unique ISBN.
+     */
+    ImportRecord NextRecord();
+
+    /**
+     * @brief Generates the next book.
+     * 
+     * @return BookData The book.
+     */
+    BookData NextBook();
+
+    /**
+     * @brief Generates the next edition of a book.
+     * 
+     * @param book_id ID of the book.
+     * @return EditionData The edition, with a unique ISBN.
+     */
+    EditionData NextEdition(int book_id);
+
+    /**
+     * @brief Draws an author name with its Zipf frequency.
+     * 
+     * @return QString The name.
+     */
+    QString SampleAuthor();
+
+    /**
+     * @brief Draws a publisher name with its Zipf frequency.
+     * 
+     * @return QString The name.
+     */
+    QString SamplePublisher();
+
+    /**
+     * @brief Draws an integer uniformly.
+     * 
+     * @param bound Exclusive upper bound, at least 1.
+     * @return int The integer, in [0, bound).
+     */
+    int Uniform(int bound);
+
+    /**
+     * @brief Get the options of the generator, with the defaults resolved.
+     * 
+     * @return const SyntheticLibraryOptions& The options.
+     */
+    const SyntheticLibraryOptions& GetOptions() const;
+
+    static QString AuthorName(int rank); ///< Name of the author of a rank.
+    static QString PublisherName(int rank); ///< Name of the publisher of a rank.
+
+private:
+    SyntheticLibraryOptions options; ///< Options with the defaults resolved
+    std::mt19937 engine; ///< Random engine, seeded with options.seed
+    ZipfDistribution authors; ///< Author ranks
+    ZipfDistribution publishers; ///< Publisher ranks
+    ZipfDistribution genres; ///< Genre ranks
+    ZipfDistribution languages; ///< Language ranks
+    int next_isbn; ///< Serial number of the next ISBN
+
+    double NextUnit(); ///< Draws a double uniformly from [0, 1).
+    QString Title(); ///< Draws a title.
+    QString NextIsbn(); ///< Makes the next ISBN-13, with its check digit.
+};
+
+#endif // SYNTHETIC_LIBRARY_H
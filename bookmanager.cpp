@@ -1,4 +1,6 @@
 #include "bookmanager.h"
+#include "databaseexecutor.h"
+#include "tracer.h"
 
 BookManager::BookManager(DatabaseManager* db_manager,
                          IdNameTableManager* author_manager,
@@ -15,11 +17,6 @@ BookManager::BookManager(DatabaseManager* db_manager,
         qCritical() << "Database connection is not valid or open.";
         return; // Database error
     }
-
-    // Initialize book-related tables
-    CreateBookTable();
-    CreateBook2AuthorTable();
-    CreateBook2GenreTable();
 }
 
 BookManager::~BookManager()
@@ -29,6 +26,8 @@ BookManager::~BookManager()
 
 int BookManager::InsertBook(const BookData& book_data)
 {
+    RT_TRACE_SCOPE("db", "BookManager::InsertBook");
+
     // Ensure the database connection is valid
     if (!database_manager || !database_manager->GetDatabase().isOpen()) {
         qCritical() << "Database connection is not valid or open.";
@@ -50,104 +49,137 @@ int BookManager::InsertBook(const BookData& book_data)
         return -1; // Invalid input
     }
 
-    QSqlDatabase db = database_manager->GetDatabase();
-    QSqlQuery query(db);
-
-    query.prepare("INSERT INTO Book (title, org_lang_id, country_id, type) VALUES (:title, :org_lang_id, :country_id, :type)");
-
-    query.bindValue(":title", book_data.title);
+    // The book and all of its links are written atomically
+    ScopedTransaction transaction(database_manager);
+    if (!transaction.IsActive()) {
+        qCritical() << "InsertBook: failed to begin transaction";
+        return -1; // Database error
+    }
 
     // Handle original language (nullable)
+    QVariant org_lang_id(QVariant::Int); // NULL
     if (!book_data.original_language.trimmed().isEmpty()) {
-        int org_lang_id = language_manager->GetIdByName(book_data.original_language);
-        if(org_lang_id == -1) {
-            org_lang_id = language_manager->Insert(book_data.original_language);
-            if(org_lang_id == -1) {
-                qCritical() << "Failed to insert original language:" << book_data.original_language;
-                return -1; // Insertion failed
-            }
+        int id = language_manager->InsertIfNotExists(book_data.original_language);
+        if(id == -1) {
+            qCritical() << "Failed to insert original language:" << book_data.original_language;
+            return -1; // Insertion failed
         }
-        query.bindValue(":org_lang_id", org_lang_id);
-    } else {
-        query.bindValue(":org_lang_id", QVariant(QVariant::Int)); // NULL
+        org_lang_id = id;
     }
 
     // Handle country (nullable)
+    QVariant country_id(QVariant::Int); // NULL
     if (!book_data.country.trimmed().isEmpty()) {
-        int country_id = country_manager->GetIdByName(book_data.country);
-        if(country_id == -1) {
-            country_id = country_manager->Insert(book_data.country);
-            if(country_id == -1) {
-                qCritical() << "Failed to insert country:" << book_data.country;
-                return -1; // Insertion failed
-            }
+        int id = country_manager->InsertIfNotExists(book_data.country);
+        if(id == -1) {
+            qCritical() << "Failed to insert country:" << book_data.country;
+            return -1; // Insertion failed
         }
-        query.bindValue(":country_id", country_id);
-    } else {
-        query.bindValue(":country_id", QVariant(QVariant::Int)); // NULL
+        country_id = id;
+    }
+
+    QSqlQuery* query = database_manager->GetCachedQuery("INSERT INTO Book (title, org_lang_id, country_id, type) VALUES (:title, :org_lang_id, :country_id, :type)");
+    if (!query) {
+        return -1; // Database error
     }
 
+    query->bindValue(":title", book_data.title);
+    query->bindValue(":org_lang_id", org_lang_id);
+    query->bindValue(":country_id", country_id);
+
     // Handle type (nullable)
     if (!book_data.type.trimmed().isEmpty()) {
-        query.bindValue(":type", book_data.type);
+        query->bindValue(":type", book_data.type);
     } else {
-        query.bindValue(":type", QVariant(QVariant::String)); // NULL
+        query->bindValue(":type", QVariant(QVariant::String)); // NULL
     }
 
-    if (!query.exec()) {
-        qCritical() << "InsertBook:" << query.lastError().text();
+    if (!database_manager->Exec(query)) {
+        qCritical() << "InsertBook:" << query->lastError().text();
         return -1; // Insertion failed
     }
 
-    int book_id = query.lastInsertId().toInt();
+    int book_id = query->lastInsertId().toInt();
 
     // Insert authors
-    for (const QString& author : book_data.authors) {
-        int author_id = author_manager->GetIdByName(author);
-        if (author_id == -1) {
-            author_id = author_manager->Insert(author);
-            if (author_id == -1) {
-                qCritical() << "Failed to insert author:" << author;
-                return -1; // Insertion failed
-            }
+    const QList<int> author_ids = author_manager->InsertIfNotExists(book_data.authors);
+    QSqlQuery* author_query = database_manager->GetCachedQuery("INSERT OR IGNORE INTO Book2Author (book_id, author_id) VALUES (:book_id, :author_id)");
+    if (!author_query) {
+        return -1; // Database error
+    }
+    for (int i = 0; i < author_ids.size(); ++i) {
+        if (author_ids.at(i) == -1) {
+            qCritical() << "Failed to insert author:" << book_data.authors.at(i);
+            return -1; // Insertion failed
         }
-        query.prepare("INSERT INTO Book2Author (book_id, author_id) VALUES (:book_id, :author_id)");
-        query.bindValue(":book_id", book_id);
-        query.bindValue(":author_id", author_id);
-        if (!query.exec()) {
-            qCritical() << "InsertBook2Author:" << query.lastError().text();
-            /// @todo Handle insertion failure for authors
+        author_query->bindValue(":book_id", book_id);
+        author_query->bindValue(":author_id", author_ids.at(i));
+        if (!database_manager->Exec(author_query)) {
+            qCritical() << "InsertBook2Author:" << author_query->lastError().text();
+            return -1; // Insertion failed
         }
     }
 
     // Insert genres (optional)
+    QStringList genres;
     for (const QString& genre : book_data.genres) {
-        if (genre.trimmed().isEmpty())
-            continue;
-        int genre_id = genre_manager->GetIdByName(genre);
-        if (genre_id == -1) {
-            genre_id = genre_manager->Insert(genre);
-            if (genre_id == -1) {
-                qCritical() << "Failed to insert genre:" << genre;
-                return -1; // Insertion failed
-            }
+        if (!genre.trimmed().isEmpty())
+            genres.append(genre);
+    }
+    const QList<int> genre_ids = genre_manager->InsertIfNotExists(genres);
+    QSqlQuery* genre_query = database_manager->GetCachedQuery("INSERT OR IGNORE INTO Book2Genre (book_id, genre_id) VALUES (:book_id, :genre_id)");
+    if (!genre_query) {
+        return -1; // Database error
+    }
+    for (int i = 0; i < genre_ids.size(); ++i) {
+        if (genre_ids.at(i) == -1) {
+            qCritical() << "Failed to insert genre:" << genres.at(i);
+            return -1; // Insertion failed
         }
-        query.prepare("INSERT INTO Book2Genre (book_id, genre_id) VALUES (:book_id, :genre_id)");
-        query.bindValue(":book_id", book_id);
-        query.bindValue(":genre_id", genre_id);
-        if (!query.exec()) {
-            qCritical() << "InsertBook2Genre:" << query.lastError().text();
-            /// @todo Handle insertion failure for genres
+        genre_query->bindValue(":book_id", book_id);
+        genre_query->bindValue(":genre_id", genre_ids.at(i));
+        if (!database_manager->Exec(genre_query)) {
+            qCritical() << "InsertBook2Genre:" << genre_query->lastError().text();
+            return -1; // Insertion failed
         }
     }
 
+    BookListRow row{book_id, book_data.title, GetAuthorsForBook(book_id)};
+    database_manager->PublishChange(ChangeEvent{ChangeType::BookInserted, book_id, BookLabel(row)});
+
+    if (!transaction.Commit()) {
+        qCritical() << "InsertBook: failed to commit transaction";
+        return -1; // Insertion failed
+    }
+
     return book_id; // Return the ID of the inserted book
 }
 
+QFuture<int> BookManager::InsertBookAsync(DatabaseExecutor* executor, const BookData& book_data)
+{
+    return executor->Run([book_data](Library& library) {
+        return library.book_manager->InsertBook(book_data);
+    });
+}
+
 QMap<int, QString> BookManager::GetAllBooks() const
 {
     QMap<int, QString> books;
 
+    const QList<BookListRow> rows = ListBooks();
+    for (const BookListRow& row : rows) {
+        books.insert(row.id, BookLabel(row));
+    }
+
+    return books;
+}
+
+QList<BookListRow> BookManager::ListBooks() const
+{
+    RT_TRACE_SCOPE("db", "BookManager::ListBooks");
+
+    QList<BookListRow> books;
+
     // Ensure the database connection is valid
     if (!database_manager || !database_manager->GetDatabase().isOpen()) {
         qCritical() << "Database connection is not valid or open.";
@@ -156,113 +188,141 @@ QMap<int, QString> BookManager::GetAllBooks() const
 
     QSqlDatabase db = database_manager->GetDatabase();
     QSqlQuery query(db);
-
-    // Get all books with their IDs and titles
-    if (!query.exec("SELECT id, title FROM Book ORDER BY title")) {
-        qCritical() << "GetAllBooks:" << query.lastError().text();
+    query.setForwardOnly(true);
+
+    // One row per (book, author) pair, grouped by book through the ordering
+    if (!database_manager->Exec(query, "SELECT Book.id, Book.title, Author.name FROM Book "
+                                       "LEFT JOIN Book2Author ON Book2Author.book_id = Book.id "
+                                       "LEFT JOIN Author ON Author.id = Book2Author.author_id "
+                                       "ORDER BY Book.title, Book.id, Author.name")) {
+        qCritical() << "ListBooks:" << query.lastError().text();
         return books;
     }
 
-    while (query.next()) {
-        int book_id = query.value(0).toInt();
-        QString title = query.value(1).toString();
-        QStringList authors = GetAuthorsForBook(book_id);
-        QString display = title;
-        if (!authors.isEmpty()) {
-            display += " - " + authors.join(", ");
-        }
-        books.insert(book_id, display);
-    }
+    return ReadBooks(query);
+}
 
-    return books;
+QFuture<QList<BookListRow>> BookManager::ListBooksAsync(DatabaseExecutor* executor)
+{
+    return executor->Run([](Library& library) {
+        return library.book_manager->ListBooks();
+    });
 }
 
-// Helper function to get authors for a specific book
-QStringList BookManager::GetAuthorsForBook(int book_id) const
+QList<BookListRow> BookManager::ListBooksPage(BookSortKey sort_key, const PageCursor& after, int limit) const
 {
-    QStringList authors;
+    RT_TRACE_SCOPE("db", "BookManager::ListBooksPage");
 
     if (!database_manager || !database_manager->GetDatabase().isOpen()) {
         qCritical() << "Database connection is not valid or open.";
-        return authors;
+        return QList<BookListRow>();
     }
 
-    QSqlDatabase db = database_manager->GetDatabase();
-    QSqlQuery query(db);
-
-    query.prepare("SELECT Author.name FROM Author "
-                  "INNER JOIN Book2Author ON Author.id = Book2Author.author_id "
-                  "WHERE Book2Author.book_id = :book_id "
-                  "ORDER BY Author.name");
-    query.bindValue(":book_id", book_id);
+    if (limit <= 0) {
+        qWarning() << "ListBooksPage failed: limit must be greater than 0";
+        return QList<BookListRow>();
+    }
 
-    if (!query.exec()) {
-        qCritical() << "GetAuthorsForBook:" << query.lastError().text();
-        return authors;
+    // Limit the books before joining the authors so a page never splits a book
+    bool by_title = sort_key == BookSortKey::Title;
+    QSqlQuery* query = database_manager->GetCachedQuery(
+        "SELECT B.id, B.title, Author.name FROM "
+        "(SELECT id, title FROM Book WHERE " + PageSeekSql(by_title ? "title" : "", "id") +
+        " ORDER BY " + (by_title ? "title, id" : "id") + " LIMIT :limit) AS B "
+        "LEFT JOIN Book2Author ON Book2Author.book_id = B.id "
+        "LEFT JOIN Author ON Author.id = Book2Author.author_id "
+        "ORDER BY " + (by_title ? "B.title, B.id" : "B.id") + ", Author.name");
+    if (!query) {
+        return QList<BookListRow>();
     }
 
-    while (query.next()) {
-        authors.append(query.value(0).toString());
+    BindPageCursor(query, after, by_title);
+    query->bindValue(":limit", limit);
+
+    if (!database_manager->Exec(query)) {
+        qCritical() << "ListBooksPage:" << query->lastError().text();
+        return QList<BookListRow>();
     }
 
-    return authors;
+    return ReadBooks(*query);
 }
 
-void BookManager::CreateBookTable()
+QFuture<QList<BookListRow>> BookManager::ListBooksPageAsync(DatabaseExecutor* executor, BookSortKey sort_key, const PageCursor& after, int limit)
 {
-    // Ensure the database connection is valid
-    if (!database_manager || !database_manager->GetDatabase().isOpen()) {
-        qCritical() << "Database connection is not valid or open.";
-        return; // Database error
-    }
-
-    QSqlDatabase db = database_manager->GetDatabase();
-    QSqlQuery query(db);
+    return executor->Run([sort_key, after, limit](Library& library) {
+        return library.book_manager->ListBooksPage(sort_key, after, limit);
+    });
+}
 
-    query.exec("CREATE TABLE IF NOT EXISTS Book ("
-               "id INTEGER PRIMARY KEY AUTOINCREMENT, "
-               "title TEXT NOT NULL, "
-               "org_lang_id INTEGER, "
-               "country_id INTEGER, "
-               "type TEXT, "
-               "FOREIGN KEY(org_lang_id) REFERENCES Language(id), "
-               "FOREIGN KEY(country_id) REFERENCES Country(id))");
+PageCursor BookManager::CursorAfter(const BookListRow& book, BookSortKey sort_key)
+{
+    return PageCursor{sort_key == BookSortKey::Title ? QVariant(book.title) : QVariant(), book.id};
 }
 
-void BookManager::CreateBook2AuthorTable()
+QList<BookListRow> BookManager::ReadBooks(QSqlQuery& query) const
 {
-    // Ensure the database connection is valid
-    if (!database_manager || !database_manager->GetDatabase().isOpen()) {
-        qCritical() << "Database connection is not valid or open.";
-        return; // Database error
+    QList<BookListRow> books;
+
+    qint64 row_count = 0;
+    while (query.next()) {
+        row_count++;
+        int book_id = query.value(0).toInt();
+        if (books.isEmpty() || books.last().id != book_id) {
+            books.append(BookListRow{book_id, query.value(1).toString(), {}});
+        }
+        if (!query.value(2).isNull()) {
+            books.last().authors.append(query.value(2).toString());
+        }
     }
 
-    QSqlDatabase db = database_manager->GetDatabase();
-    QSqlQuery query(db);
+    database_manager->RecordRows(query, row_count);
+
+    return books;
+}
 
-    query.exec("CREATE TABLE IF NOT EXISTS Book2Author ("
-               "book_id INTEGER, "
-               "author_id INTEGER, "
-               "PRIMARY KEY(book_id, author_id), "
-               "FOREIGN KEY(book_id) REFERENCES Book(id), "
-               "FOREIGN KEY(author_id) REFERENCES Author(id))");
+QString BookManager::BookLabel(const BookListRow& book)
+{
+    QString display = book.title;
+    if (!book.authors.isEmpty()) {
+        display += " - " + book.authors.join(", ");
+    }
+    return display;
 }
 
-void BookManager::CreateBook2GenreTable()
+// Helper function to get authors for a specific book
+QStringList BookManager::GetAuthorsForBook(int book_id) const
 {
-    // Ensure the database connection is valid
+    RT_TRACE_SCOPE("db", "BookManager::GetAuthorsForBook");
+
+    QStringList authors;
+
     if (!database_manager || !database_manager->GetDatabase().isOpen()) {
         qCritical() << "Database connection is not valid or open.";
-        return; // Database error
+        return authors;
     }
 
-    QSqlDatabase db = database_manager->GetDatabase();
-    QSqlQuery query(db);
+    QSqlQuery* query = database_manager->GetCachedQuery("SELECT Author.name FROM Author "
+                                                        "INNER JOIN Book2Author ON Author.id = Book2Author.author_id "
+                                                        "WHERE Book2Author.book_id = :book_id "
+                                                        "ORDER BY Author.name");
+    if (!query) {
+        return authors;
+    }
+
+    query->bindValue(":book_id", book_id);
+
+    if (!database_manager->Exec(query)) {
+        qCritical() << "GetAuthorsForBook:" << query->lastError().text();
+        return authors;
+    }
+
+    qint64 row_count = 0;
+    while (query->next()) {
+        row_count++;
+        authors.append(query->value(0).toString());
+    }
 
-    query.exec("CREATE TABLE IF NOT EXISTS Book2Genre ("
-               "book_id INTEGER, "
-               "genre_id INTEGER, "
-               "PRIMARY KEY(book_id, genre_id), "
-               "FOREIGN KEY(book_id) REFERENCES Book(id), "
-               "FOREIGN KEY(genre_id) REFERENCES Genre(id))");
-}
\ No newline at end of file
+    database_manager->RecordRows(*query, row_count);
+
+    return authors;
+}
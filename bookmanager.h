@@ -12,6 +12,20 @@ struct BookData {
     QString type; ///< Type of the book (I am not sure what this means)
 };
 
+struct BookListRow {
+    int id; ///< ID of the book
+    QString title; ///< Title of the book
+    QStringList authors; ///< Authors of the book, ordered by name
+};
+
+/**
+ * @brief Orders of the book pages, see BookManager::ListBooksPage().
+ */
+enum class BookSortKey {
+    Id, ///< By book ID, the order books were added in
+    Title ///< By title, then ID, the order of ListBooks()
+};
+
 /**
  * @brief BookManager class
  * This class manages book-related operations such as inserting books and retrieving book information.
@@ -22,7 +36,7 @@ class BookManager
 {
 public:
     /**
-     * @brief Constructs a BookManager object and initializes the book-related tables.
+     * @brief Constructs a BookManager object.
      * 
      * @param db_manager Pointer to the DatabaseManager instance.
      * @param author_manager Pointer to the IdNameTableManager instance for Author table.
@@ -49,6 +63,15 @@ public:
      */
     int InsertBook(const BookData& book_data);
 
+    /**
+     * @brief Inserts a new book on the database worker thread.
+     * 
+     * @param executor The executor to run the insert on.
+     * @param book_data The data of the book to insert.
+     * @return QFuture<int> The ID of the inserted book, or -1 on failure.
+     */
+    static QFuture<int> InsertBookAsync(DatabaseExecutor* executor, const BookData& book_data);
+
 
     /**
      * @brief Get the All Books in the database.
@@ -57,6 +80,61 @@ public:
      */
     QMap<int, QString> GetAllBooks() const;
 
+    /**
+     * @brief Lists all books with their authors in a single query.
+     *
+     * Books are ordered by title, authors of each book by name.
+     * 
+     * @return QList<BookListRow> The books in the database.
+     */
+    QList<BookListRow> ListBooks() const;
+
+    /**
+     * @brief Lists all books on the database worker thread, see ListBooks().
+     * 
+     * @param executor The executor to run the query on.
+     * @return QFuture<QList<BookListRow>> The books in the database.
+     */
+    static QFuture<QList<BookListRow>> ListBooksAsync(DatabaseExecutor* executor);
+
+    /**
+     * @brief Lists one page of books with their authors, seeking to the page through an index.
+     * 
+     * @param sort_key Order of the books.
+     * @param after Cursor after the last book of the previous page, default constructed for the first page.
+     * @param limit Maximum number of books in the page.
+     * @return QList<BookListRow> The books, fewer than limit on the last page.
+     */
+    QList<BookListRow> ListBooksPage(BookSortKey sort_key, const PageCursor& after, int limit) const;
+
+    /**
+     * @brief Lists one page of books on the database worker thread, see ListBooksPage().
+     * 
+     * @param executor The executor to run the query on.
+     * @param sort_key Order of the books.
+     * @param after Cursor after the last book of the previous page.
+     * @param limit Maximum number of books in the page.
+     * @return QFuture<QList<BookListRow>> The books.
+     */
+    static QFuture<QList<BookListRow>> ListBooksPageAsync(DatabaseExecutor* executor, BookSortKey sort_key, const PageCursor& after, int limit);
+
+    /**
+     * @brief Builds the cursor of the page following a book.
+     * 
+     * @param book The last book of a page.
+     * @param sort_key Order the page was listed in.
+     * @return PageCursor The cursor of the next page.
+     */
+    static PageCursor CursorAfter(const BookListRow& book, BookSortKey sort_key);
+
+    /**
+     * @brief Builds the display label of a book: "Title - Author1, Author2".
+     * 
+     * @param book The book row to build the label for.
+     * @return QString The display label.
+     */
+    static QString BookLabel(const BookListRow& book);
+
     /**
      * @brief Get the Authors For Book
      * 
@@ -72,12 +150,7 @@ private:
     IdNameTableManager* country_manager; ///< Pointer to the IdNameTableManager instance for countries.
     IdNameTableManager* genre_manager; ///< Pointer to the IdNameTableManager instance for genres.
 
-    void CreateBookTable(); ///< Creates the book table in the database.
-
-    /// @todo Consider creating a junction class for Book2Author and Book2Genre to manage many-to-many relationships.
-    void CreateBook2AuthorTable(); ///< Creates the book-author association table in the database.
-
-    void CreateBook2GenreTable(); ///< Creates the book-genre association table in the database.
+    QList<BookListRow> ReadBooks(QSqlQuery& query) const; ///< Groups the (book, author) rows of a query into books.
 };
 
 #endif // BOOK_MANAGER_H
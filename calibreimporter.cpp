@@ -0,0 +1,302 @@
+#include "calibreimporter.h"
+#include "libraryimporter.h"
+#include "databaseexecutor.h"
+#include "tracer.h"
+
+#include <QFileInfo>
+#include <QLocale>
+
+CalibreImporter::CalibreImporter(Library* library)
+    : library(library)
+{
+}
+
+int CalibreImporter::Import(const QString& metadata_path)
+{
+    RT_TRACE_SCOPE("db", "CalibreImporter::Import");
+
+    DatabaseManager* database_manager = library ? library->database_manager : nullptr;
+    if (!database_manager || !database_manager->GetDatabase().isOpen()) {
+        qCritical() << "Database connection is not valid or open.";
+        return -1; // Database error
+    }
+
+    QFileInfo metadata_file(metadata_path);
+    if (!metadata_file.isFile()) {
+        qWarning() << "ImportCalibre failed: no such file" << metadata_path;
+        return -1; // Invalid input
+    }
+
+    // SQLite refuses to attach or detach a database inside a transaction
+    if (database_manager->GetTransactionDepth() > 0) {
+        qWarning() << "ImportCalibre failed: a transaction is open";
+        return -1;
+    }
+
+    if (!Exec("ATTACH DATABASE :path AS calibre", {{":path", metadata_file.absoluteFilePath()}})) {
+        return -1;
+    }
+
+    // Libraries without an ID are told apart by location
+    QString library_uuid = ReadLibraryUuid();
+    if (library_uuid.isEmpty()) {
+        library_uuid = metadata_file.canonicalFilePath();
+    }
+
+    int imported = CopyBooks(library_uuid, metadata_file.absolutePath());
+
+    Exec("DETACH DATABASE calibre");
+
+    if (imported > 0) {
+        // Names were inserted behind the managers' backs
+        for (IdNameTable table : {IdNameTable::Author, IdNameTable::Publisher, IdNameTable::Language,
+                                  IdNameTable::Genre, IdNameTable::Series}) {
+            library->GetIdNameTableManager(table)->InvalidateCache();
+        }
+
+        // Too many rows for row-level updates, views reload instead
+        database_manager->PublishChange(ChangeEvent{ChangeType::Reset, -1, QString()});
+    }
+
+    qInfo() << "ImportCalibre: imported" << imported << "books from" << metadata_path;
+    return imported;
+}
+
+QFuture<int> CalibreImporter::ImportAsync(DatabaseExecutor* executor, const QString& metadata_path)
+{
+    return executor->Run([metadata_path](Library& library) {
+        CalibreImporter importer(&library);
+        return importer.Import(metadata_path);
+    });
+}
+
+int CalibreImporter::CopyBooks(const QString& library_uuid, const QString& library_dir)
+{
+    DatabaseManager* database_manager = library->database_manager;
+    QSqlDatabase db = database_manager->GetDatabase();
+
+    ScopedTransaction transaction(database_manager);
+    if (!transaction.IsActive()) {
+        qCritical() << "ImportCalibre: failed to begin transaction";
+        return -1;
+    }
+
+    int last_book_id = ReadLastId("Book");
+    int last_edition_id = ReadLastId("Edition");
+    if (last_book_id == -1 || last_edition_id == -1) {
+        return -1;
+    }
+
+    // IDs are assigned up front, so every copy can join the Calibre book to its new rows
+    if (!Exec("CREATE TEMP TABLE IF NOT EXISTS CalibreImport ("
+              "calibre_book_id INTEGER PRIMARY KEY, "
+              "book_id INTEGER NOT NULL, "
+              "edition_id INTEGER NOT NULL)")
+        || !Exec("DELETE FROM temp.CalibreImport")
+        || !Exec("INSERT INTO temp.CalibreImport (calibre_book_id, book_id, edition_id) "
+                 "SELECT B.id, :last_book_id + row_number() OVER win, :last_edition_id + row_number() OVER win "
+                 "FROM calibre.books AS B "
+                 "WHERE NOT EXISTS (SELECT 1 FROM main.CalibreBookMap AS M "
+                 "WHERE M.library_uuid = :library_uuid AND M.calibre_book_id = B.id) "
+                 "WINDOW win AS (ORDER BY B.id)",
+                 {{":last_book_id", last_book_id},
+                  {":last_edition_id", last_edition_id},
+                  {":library_uuid", library_uuid}})) {
+        return -1; // Rolled back by the transaction scope
+    }
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT COUNT(*) FROM temp.CalibreImport") || !query.next()) {
+        qCritical() << "ImportCalibre:" << query.lastError().text();
+        return -1;
+    }
+    int book_count = query.value(0).toInt();
+    query.finish();
+
+    if (book_count == 0) {
+        transaction.Commit();
+        return 0; // Imported before
+    }
+
+    // Calibre stores ISO 639 codes, the languages are stored by name here
+    if (!Exec("CREATE TEMP TABLE IF NOT EXISTS CalibreLanguage (code TEXT PRIMARY KEY, name TEXT NOT NULL)")
+        || !Exec("DELETE FROM temp.CalibreLanguage")) {
+        return -1;
+    }
+    if (!query.exec("SELECT lang_code FROM calibre.languages")) {
+        qCritical() << "ImportCalibre:" << query.lastError().text();
+        return -1;
+    }
+    QStringList codes;
+    while (query.next()) {
+        codes.append(query.value(0).toString());
+    }
+    query.finish();
+    for (const QString& code : codes) {
+        QLocale::Language language = QLocale::codeToLanguage(code);
+        QString name = language == QLocale::AnyLanguage ? code : QLocale::languageToString(language);
+        if (!Exec("INSERT OR IGNORE INTO temp.CalibreLanguage (code, name) VALUES (:code, :name)",
+                  {{":code", code}, {":name", name}})) {
+            return -1;
+        }
+    }
+
+    if (!library->search_manager->SuspendIndexing()) {
+        return -1;
+    }
+
+    // Calibre's series table shadows ours, so every table is qualified with its schema
+    const QStringList statements = {
+        "INSERT OR IGNORE INTO main.Author (name) "
+        "SELECT A.name FROM calibre.authors AS A "
+        "WHERE A.id IN (SELECT L.author FROM calibre.books_authors_link AS L "
+        "JOIN temp.CalibreImport AS I ON I.calibre_book_id = L.book)",
+
+        "INSERT OR IGNORE INTO main.Genre (name) "
+        "SELECT T.name FROM calibre.tags AS T "
+        "WHERE T.id IN (SELECT L.tag FROM calibre.books_tags_link AS L "
+        "JOIN temp.CalibreImport AS I ON I.calibre_book_id = L.book)",
+
+        "INSERT OR IGNORE INTO main.Publisher (name) "
+        "SELECT P.name FROM calibre.publishers AS P "
+        "WHERE P.id IN (SELECT L.publisher FROM calibre.books_publishers_link AS L "
+        "JOIN temp.CalibreImport AS I ON I.calibre_book_id = L.book)",
+
+        "INSERT OR IGNORE INTO main.Publisher (name) VALUES (:unknown_publisher)",
+
+        "INSERT OR IGNORE INTO main.Series (name) "
+        "SELECT S.name FROM calibre.series AS S "
+        "WHERE S.id IN (SELECT L.series FROM calibre.books_series_link AS L "
+        "JOIN temp.CalibreImport AS I ON I.calibre_book_id = L.book)",
+
+        "INSERT OR IGNORE INTO main.Language (name) SELECT name FROM temp.CalibreLanguage",
+
+        "INSERT INTO main.Book (id, title, org_lang_id, country_id, type) "
+        "SELECT I.book_id, B.title, NULL, NULL, NULL FROM temp.CalibreImport AS I "
+        "JOIN calibre.books AS B ON B.id = I.calibre_book_id",
+
+        "INSERT OR IGNORE INTO main.Book2Author (book_id, author_id) "
+        "SELECT I.book_id, Author.id FROM temp.CalibreImport AS I "
+        "JOIN calibre.books_authors_link AS L ON L.book = I.calibre_book_id "
+        "JOIN calibre.authors AS A ON A.id = L.author "
+        "JOIN main.Author ON Author.name = A.name",
+
+        "INSERT OR IGNORE INTO main.Book2Genre (book_id, genre_id) "
+        "SELECT I.book_id, Genre.id FROM temp.CalibreImport AS I "
+        "JOIN calibre.books_tags_link AS L ON L.book = I.calibre_book_id "
+        "JOIN calibre.tags AS T ON T.id = L.tag "
+        "JOIN main.Genre ON Genre.name = T.name",
+
+        // Calibre marks an unknown publication date with the year 101
+        "INSERT INTO main.Edition (id, book_id, publisher_id, language_id, series_id, page_count, publication_date, isbn, type, cover_image_path) "
+        "SELECT I.edition_id, I.book_id, "
+        "COALESCE((SELECT Publisher.id FROM calibre.books_publishers_link AS L "
+        "JOIN calibre.publishers AS P ON P.id = L.publisher "
+        "JOIN main.Publisher ON Publisher.name = P.name "
+        "WHERE L.book = B.id ORDER BY L.id LIMIT 1), "
+        "(SELECT id FROM main.Publisher WHERE name = :unknown_publisher)), "
+        "(SELECT Language.id FROM calibre.books_languages_link AS L "
+        "JOIN calibre.languages AS C ON C.id = L.lang_code "
+        "JOIN temp.CalibreLanguage AS CL ON CL.code = C.lang_code "
+        "JOIN main.Language ON Language.name = CL.name "
+        "WHERE L.book = B.id ORDER BY L.item_order LIMIT 1), "
+        "(SELECT Series.id FROM calibre.books_series_link AS L "
+        "JOIN calibre.series AS S ON S.id = L.series "
+        "JOIN main.Series ON Series.name = S.name "
+        "WHERE L.book = B.id ORDER BY L.id LIMIT 1), "
+        "NULL, "
+        "CASE WHEN substr(B.pubdate, 1, 4) > '0101' THEN substr(B.pubdate, 1, 10) END, "
+        "COALESCE((SELECT val FROM calibre.identifiers WHERE book = B.id AND type = 'isbn' ORDER BY id LIMIT 1), "
+        "NULLIF(B.isbn, '')), "
+        "NULL, "
+        "CASE WHEN B.has_cover THEN :library_dir || '/' || B.path || '/cover.jpg' END "
+        "FROM temp.CalibreImport AS I "
+        "JOIN calibre.books AS B ON B.id = I.calibre_book_id",
+
+        "INSERT INTO main.CalibreBookMap (library_uuid, calibre_book_id, book_id, edition_id) "
+        "SELECT :library_uuid, calibre_book_id, book_id, edition_id FROM temp.CalibreImport",
+    };
+
+    const QVariantMap values = {
+        {":unknown_publisher", QString(LibraryImporter::kUnknownPublisher)},
+        {":library_dir", library_dir},
+        {":library_uuid", library_uuid},
+    };
+
+    for (const QString& statement : statements) {
+        // Only the placeholders a statement uses may be bound
+        QVariantMap statement_values;
+        for (auto it = values.constBegin(); it != values.constEnd(); ++it) {
+            if (statement.contains(it.key())) {
+                statement_values.insert(it.key(), it.value());
+            }
+        }
+        if (!Exec(statement, statement_values)) {
+            return -1;
+        }
+    }
+
+    if (!library->search_manager->ResumeIndexing(last_book_id + 1, -1)) {
+        return -1;
+    }
+
+    if (!transaction.Commit()) {
+        qCritical() << "ImportCalibre: failed to commit transaction";
+        return -1;
+    }
+
+    return book_count;
+}
+
+QString CalibreImporter::ReadLibraryUuid()
+{
+    QSqlQuery query(library->database_manager->GetDatabase());
+    query.setForwardOnly(true);
+
+    if (!query.exec("SELECT uuid FROM calibre.library_id LIMIT 1") || !query.next()) {
+        return QString(); // Old libraries have no ID
+    }
+
+    return query.value(0).toString();
+}
+
+int CalibreImporter::ReadLastId(const QString& table)
+{
+    QSqlQuery query(library->database_manager->GetDatabase());
+    query.setForwardOnly(true);
+
+    // AUTOINCREMENT never reuses an ID, so the sequence counts as well as the rows
+    query.prepare("SELECT MAX(COALESCE((SELECT seq FROM main.sqlite_sequence WHERE name = :table), 0), "
+                  "COALESCE((SELECT MAX(id) FROM main." + table + "), 0))");
+    query.bindValue(":table", table);
+
+    if (!query.exec() || !query.next()) {
+        qCritical() << "ImportCalibre:" << query.lastError().text();
+        return -1;
+    }
+
+    return query.value(0).toInt();
+}
+
+bool CalibreImporter::Exec(const QString& sql, const QVariantMap& values)
+{
+    // Not cached: the statements refer to the attached database, which is detached afterwards
+    QSqlQuery query(library->database_manager->GetDatabase());
+
+    if (!query.prepare(sql)) {
+        qCritical() << "ImportCalibre:" << query.lastError().text();
+        return false;
+    }
+
+    for (auto it = values.constBegin(); it != values.constEnd(); ++it) {
+        query.bindValue(it.key(), it.value());
+    }
+
+    if (!query.exec()) {
+        qCritical() << "ImportCalibre:" << query.lastError().text();
+        return false;
+    }
+
+    return true;
+}
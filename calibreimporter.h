@@ -0,0 +1,92 @@
+#ifndef CALIBRE_IMPORTER_H
+#define CALIBRE_IMPORTER_H
+
+#include "library.h"
+
+/**
+ * @file calibreimporter.h
+ * @brief Header file for CalibreImporter class.
+ *
+ * CalibreImporter copies a Calibre library into the database. The Calibre
+ * metadata.db is attached to the connection and its books, authors, tags,
+ * series, publishers and languages are copied with one INSERT ... SELECT
+ * per table, so the cost does not grow with statements executed per book.
+ *
+ * Imported books are recorded in CalibreBookMap by library UUID and
+ * Calibre book ID; importing the same library again only adds the books
+ * that are new since the last import.
+ */
+
+/**
+ * @class CalibreImporter
+ * @brief Imports Calibre libraries.
+ */
+class CalibreImporter
+{
+public:
+    /**
+     * @brief Constructs an importer writing through the managers of a library.
+     * 
+     * @param library The library to import into, must outlive the importer.
+     */
+    explicit CalibreImporter(Library* library);
+
+    /**
+     * @brief Imports a Calibre library.
+     *
+     * Every Calibre book becomes a book with one edition. Tags become
+     * genres, and the first language, publisher and series of a book
+     * become those of its edition. The import is a single transaction.
+     * 
+     * @param metadata_path Path of the metadata.db of the library.
+     * @return int The number of books imported, or -1 on failure.
+     */
+    int Import(const QString& metadata_path);
+
+    /**
+     * @brief Imports a Calibre library on the database worker thread, see Import().
+     * 
+     * @param executor The executor to run the import on.
+     * @param metadata_path Path of the metadata.db of the library.
+     * @return QFuture<int> The number of books imported, or -1 on failure.
+     */
+    static QFuture<int> ImportAsync(DatabaseExecutor* executor, const QString& metadata_path);
+
+private:
+    Library* library; ///< Managers the import writes through
+
+    /**
+     * @brief Copies the new books of the attached library.
+     * 
+     * @param library_uuid UUID identifying the library in CalibreBookMap.
+     * @param library_dir Directory of the library, for cover paths.
+     * @return int The number of books copied, or -1 on failure.
+     */
+    int CopyBooks(const QString& library_uuid, const QString& library_dir);
+
+    /**
+     * @brief Reads the UUID of the attached library.
+     * 
+     * @return QString The UUID, or an empty string if there is none.
+     */
+    QString ReadLibraryUuid();
+
+    /**
+     * @brief Reads the next ID an AUTOINCREMENT table would assign, minus one.
+     * 
+     * @param table The table.
+     * @return int The highest ID ever assigned, or -1 on failure.
+     */
+    int ReadLastId(const QString& table);
+
+    /**
+     * @brief Executes a statement with named values bound.
+     * 
+     * @param sql The statement.
+     * @param values Values by placeholder name.
+     * @return true on success, false on a database error.
+     */
+    bool Exec(const QString& sql, const QVariantMap& values = QVariantMap());
+};
+
+#endif // CALIBRE_IMPORTER_H
@@ -0,0 +1,120 @@
+#include "cataloguelistmodel.h"
+#include "tracer.h"
+
+#include <algorithm>
+
+CatalogueListModel::CatalogueListModel(Kind kind, QObject* parent)
+    : QAbstractListModel(parent),
+      kind(kind)
+{
+}
+
+int CatalogueListModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid() || !catalogue) {
+        return 0;
+    }
+    return kind == Kind::Books ? catalogue->BookCount() - int(pending_ranks.size()) : catalogue->RItemCount();
+}
+
+QVariant CatalogueListModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount()) {
+        return QVariant();
+    }
+
+    if (kind == Kind::Books) {
+        int book = catalogue->BookAtTitleRank(TitleRank(index.row()));
+        switch (role) {
+        case Qt::DisplayRole:
+            return BookManager::BookLabel(catalogue->GetBookRow(book));
+        case Qt::UserRole:
+            return catalogue->BookId(book);
+        default:
+            return QVariant();
+        }
+    }
+
+    switch (role) {
+    case Qt::DisplayRole:
+        return catalogue->GetRItemRow(index.row()).label;
+    case Qt::UserRole:
+        return catalogue->RItemId(index.row());
+    default:
+        return QVariant();
+    }
+}
+
+void CatalogueListModel::SetCatalogue(QSharedPointer<const CatalogueSnapshot> new_catalogue)
+{
+    RT_TRACE_SCOPE("ui", "CatalogueListModel::SetCatalogue");
+
+    bool extends = catalogue && new_catalogue && new_catalogue->Extends(*catalogue);
+    int added = extends ? Count(new_catalogue.data()) - Count(catalogue.data()) : 0;
+
+    if (!extends || added > kMaxInsertedRows) {
+        beginResetModel();
+        catalogue = new_catalogue;
+        endResetModel();
+        return;
+    }
+
+    if (added == 0) {
+        catalogue = new_catalogue; // Other tables changed, the rows are the same
+        return;
+    }
+
+    if (kind == Kind::Books) {
+        InsertBooks(new_catalogue);
+        return;
+    }
+
+    // Items are listed by ID, so new items go last
+    int first = Count(catalogue.data());
+    beginInsertRows(QModelIndex(), first, first + added - 1);
+    catalogue = new_catalogue;
+    endInsertRows();
+}
+
+int CatalogueListModel::Count(const CatalogueSnapshot* snapshot) const
+{
+    if (!snapshot) {
+        return 0;
+    }
+    return kind == Kind::Books ? snapshot->BookCount() : snapshot->RItemCount();
+}
+
+int CatalogueListModel::TitleRank(int row) const
+{
+    int rank = row;
+    for (int pending : pending_ranks) {
+        if (pending > rank) {
+            break;
+        }
+        ++rank;
+    }
+    return rank;
+}
+
+void CatalogueListModel::InsertBooks(const QSharedPointer<const CatalogueSnapshot>& extended)
+{
+    // Existing books keep their positions in the extended snapshot, the new
+    // ones are looked up in its title order
+    QVector<int> ranks;
+    ranks.reserve(extended->BookCount() - catalogue->BookCount());
+    for (int book = catalogue->BookCount(); book < extended->BookCount(); ++book) {
+        ranks.append(extended->BookTitleRank(book));
+    }
+    std::sort(ranks.begin(), ranks.end());
+
+    catalogue = extended;
+    pending_ranks = std::move(ranks);
+
+    // Inserting the books in ascending rank leaves every intermediate state sorted
+    while (!pending_ranks.isEmpty()) {
+        int row = pending_ranks.first();
+        beginInsertRows(QModelIndex(), row, row);
+        pending_ranks.removeFirst();
+        endInsertRows();
+    }
+}
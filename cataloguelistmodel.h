@@ -0,0 +1,73 @@
+#ifndef CATALOGUE_LIST_MODEL_H
+#define CATALOGUE_LIST_MODEL_H
+
+#include "cataloguesnapshot.h"
+
+#include <QAbstractListModel>
+
+/**
+ * @file cataloguelistmodel.h
+ * @brief Header file for CatalogueListModel class.
+ *
+ * CatalogueListModel backs the book and readable item combo boxes. It keeps
+ * no rows of its own: labels are built from the shared CatalogueSnapshot
+ * when the view asks for them.
+ */
+
+/**
+ * @class CatalogueListModel
+ * @brief List model of the books or readable items of a CatalogueSnapshot.
+ *
+ * Books are ordered by title and items by ID, like the lists of the
+ * managers. The display role holds the label and Qt::UserRole the ID.
+ */
+class CatalogueListModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    static constexpr int kMaxInsertedRows = 1000; ///< Larger updates reset the model instead of inserting row by row
+
+    /**
+     * @enum Kind
+     * @brief Rows listed by the model.
+     */
+    enum class Kind {
+        Books,
+        RItems
+    };
+
+    /**
+     * @brief Constructs an empty model, call SetCatalogue() to fill it.
+     * 
+     * @param kind Rows to list.
+     * @param parent Parent QObject.
+     */
+    explicit CatalogueListModel(Kind kind, QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    /**
+     * @brief Shows a new snapshot.
+     *
+     * A snapshot that extends the current one inserts only its new rows, so
+     * the selection of a combo box survives; any other snapshot resets the
+     * model.
+     * 
+     * @param catalogue The snapshot, nullptr to clear the model.
+     */
+    void SetCatalogue(QSharedPointer<const CatalogueSnapshot> catalogue);
+
+private:
+    Kind kind; ///< Rows listed by the model
+    QSharedPointer<const CatalogueSnapshot> catalogue; ///< Snapshot the rows are read from
+    QVector<int> pending_ranks; ///< Title ranks of the new books not inserted yet while a snapshot is applied, ascending
+
+    int Count(const CatalogueSnapshot* snapshot) const; ///< Number of rows of a snapshot
+    int TitleRank(int row) const; ///< Title rank of the book at a row, skipping the pending books
+
+    void InsertBooks(const QSharedPointer<const CatalogueSnapshot>& extended); ///< Inserts the books added by a snapshot at their sorted rows
+};
+
+#endif // CATALOGUE_LIST_MODEL_H
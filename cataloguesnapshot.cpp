@@ -0,0 +1,571 @@
+#include "cataloguesnapshot.h"
+#include "tracer.h"
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <utility>
+
+namespace {
+
+/**
+ * @brief Stores each name once in the arena of a snapshot.
+ */
+class NameInterner
+{
+public:
+    NameInterner(StringArena* names, QHash<QString, int>* indices)
+        : names(names),
+          indices(indices)
+    {
+    }
+
+    int Intern(const QVariant& value) ///< Index of a name, -1 for NULL or empty
+    {
+        QString name = value.toString();
+        if (name.isEmpty()) {
+            return -1;
+        }
+
+        // Another snapshot of the lineage may have given the index to a name this arena lacks
+        auto it = indices->constFind(name);
+        if (it != indices->constEnd() && it.value() < names->Size() && names->At(it.value()) == QStringView(name)) {
+            return it.value();
+        }
+
+        int index = names->Append(name);
+        indices->insert(name, index);
+        return index;
+    }
+
+private:
+    StringArena* names; ///< Arena the names are appended to
+    QHash<QString, int>* indices; ///< Index of each name, shared by the lineage
+};
+
+// Reads (book_id, name) rows ordered by book_id into the CSR lists of the books from first_book on
+void ReadAdjacency(QSqlQuery* query, const ChunkedVector<int>& book_ids, int first_book,
+                   NameInterner& interner, ChunkedVector<int>& ends, ChunkedVector<int>& targets)
+{
+    bool has_row = query->next();
+    for (int book = first_book; book < book_ids.Size(); ++book) {
+        int book_id = book_ids.At(book);
+        while (has_row && query->value(0).toInt() < book_id) {
+            has_row = query->next(); // Links to a missing book
+        }
+        while (has_row && query->value(0).toInt() == book_id) {
+            int name = interner.Intern(query->value(1));
+            if (name != -1) {
+                targets.Append(name);
+            }
+            has_row = query->next();
+        }
+        ends.Append(targets.Size());
+    }
+}
+
+} // namespace
+
+int StringArena::Append(QStringView value)
+{
+    if (size % kChunkSize == 0) {
+        chunks.append(Chunk());
+        chunks.last().ends.reserve(kChunkSize);
+    }
+    Chunk& chunk = chunks.last();
+    chunk.text.append(value);
+    chunk.ends.append(chunk.text.size());
+    return size++;
+}
+
+QStringView StringArena::At(int index) const
+{
+    const Chunk& chunk = chunks.at(index / kChunkSize);
+    int i = index % kChunkSize;
+    int begin = i == 0 ? 0 : chunk.ends.at(i - 1);
+    return QStringView(chunk.text).mid(begin, chunk.ends.at(i) - begin);
+}
+
+int StringArena::Size() const
+{
+    return size;
+}
+
+void StringArena::Squeeze()
+{
+    // Shared chunks are squeezed already, detaching them would copy for nothing
+    if (!chunks.isEmpty() && (chunks.constLast().text.capacity() > chunks.constLast().text.size()
+                              || chunks.constLast().ends.capacity() > chunks.constLast().ends.size())) {
+        Chunk& chunk = chunks.last();
+        chunk.text.squeeze();
+        chunk.ends.squeeze();
+    }
+}
+
+qint64 StringArena::MemoryUsage() const
+{
+    qint64 bytes = chunks.capacity() * qint64(sizeof(Chunk));
+    for (const Chunk& chunk : chunks) {
+        bytes += chunk.text.capacity() * qint64(sizeof(QChar)) + chunk.ends.capacity() * qint64(sizeof(int));
+    }
+    return bytes;
+}
+
+void ChunkedOrder::Append(int position)
+{
+    if (chunks.isEmpty() || chunks.constLast().size() >= kChunkSize) {
+        chunks.append(QVector<int>());
+        chunk_ends.append(Size());
+    }
+    chunks.last().append(position);
+    ++chunk_ends.last();
+}
+
+void ChunkedOrder::Insert(int rank, int position)
+{
+    if (rank == Size()) {
+        Append(position);
+        return;
+    }
+
+    int chunk = ChunkOf(rank);
+    int begin = ChunkBegin(chunk);
+    chunks[chunk].insert(rank - begin, position);
+    for (int i = chunk; i < chunk_ends.size(); ++i) {
+        ++chunk_ends[i];
+    }
+
+    // Split a full chunk in halves, so an insert never copies more than 2 * kChunkSize positions
+    if (chunks.at(chunk).size() >= 2 * kChunkSize) {
+        chunks.insert(chunk + 1, chunks.at(chunk).mid(kChunkSize));
+        chunks[chunk].resize(kChunkSize);
+        chunk_ends.insert(chunk, begin + kChunkSize);
+    }
+}
+
+int ChunkedOrder::At(int rank) const
+{
+    int chunk = ChunkOf(rank);
+    return chunks.at(chunk).at(rank - ChunkBegin(chunk));
+}
+
+int ChunkedOrder::Size() const
+{
+    return chunk_ends.isEmpty() ? 0 : chunk_ends.constLast();
+}
+
+QVector<int> ChunkedOrder::ToVector() const
+{
+    QVector<int> positions;
+    positions.reserve(Size());
+    for (const QVector<int>& chunk : chunks) {
+        positions.append(chunk);
+    }
+    return positions;
+}
+
+qint64 ChunkedOrder::MemoryUsage() const
+{
+    qint64 bytes = chunks.capacity() * qint64(sizeof(QVector<int>)) + chunk_ends.capacity() * qint64(sizeof(int));
+    for (const QVector<int>& chunk : chunks) {
+        bytes += chunk.capacity() * qint64(sizeof(int));
+    }
+    return bytes;
+}
+
+int ChunkedOrder::ChunkOf(int rank) const
+{
+    return int(std::upper_bound(chunk_ends.cbegin(), chunk_ends.cend(), rank) - chunk_ends.cbegin());
+}
+
+int ChunkedOrder::ChunkBegin(int chunk) const
+{
+    return chunk == 0 ? 0 : chunk_ends.at(chunk - 1);
+}
+
+QSharedPointer<const CatalogueSnapshot> CatalogueSnapshot::Load(Library& library, const QSharedPointer<const CatalogueSnapshot>& base)
+{
+    RT_TRACE_SCOPE("db", "CatalogueSnapshot::Load");
+
+    DatabaseManager* database_manager = library.database_manager;
+    if (!database_manager || !database_manager->GetDatabase().isOpen()) {
+        qCritical() << "Database connection is not valid or open.";
+        return {};
+    }
+
+    // Copies share the chunks of the base until they are appended to
+    auto snapshot = QSharedPointer<CatalogueSnapshot>::create();
+    if (base) {
+        *snapshot = *base;
+    }
+    else {
+        snapshot->name_index = QSharedPointer<NameIndex>::create();
+    }
+
+    // The tables are read in one transaction, so they agree with each other
+    ScopedTransaction transaction(database_manager);
+    if (!transaction.IsActive()) {
+        qCritical() << "CatalogueSnapshot: failed to begin transaction";
+        return {};
+    }
+
+    QMutexLocker name_lock(&snapshot->name_index->mutex);
+    NameInterner interner(&snapshot->names, &snapshot->name_index->indices);
+    const int first_book = snapshot->book_ids.Size();
+    const int first_edition = snapshot->edition_ids.Size();
+    const int first_r_item = snapshot->r_item_ids.Size();
+
+    // Books
+    QSqlQuery* query = database_manager->GetCachedQuery("SELECT id, title FROM Book WHERE id > :after_id ORDER BY id");
+    if (!query) {
+        return {};
+    }
+    query->bindValue(":after_id", first_book > 0 ? snapshot->book_ids.Last() : 0);
+    if (!database_manager->Exec(query)) {
+        qCritical() << "CatalogueSnapshot books:" << query->lastError().text();
+        return {};
+    }
+    while (query->next()) {
+        snapshot->book_ids.Append(query->value(0).toInt());
+        snapshot->book_titles.Append(query->value(1).toString());
+    }
+    database_manager->RecordRows(*query, snapshot->book_ids.Size() - first_book);
+
+    const int after_book_id = first_book > 0 ? snapshot->book_ids.At(first_book - 1) : 0;
+
+    query = database_manager->GetCachedQuery("SELECT Book2Author.book_id, Author.name FROM Book2Author "
+                                             "JOIN Author ON Author.id = Book2Author.author_id "
+                                             "WHERE Book2Author.book_id > :after_id "
+                                             "ORDER BY Book2Author.book_id, Author.name");
+    if (!query) {
+        return {};
+    }
+    query->bindValue(":after_id", after_book_id);
+    if (!database_manager->Exec(query)) {
+        qCritical() << "CatalogueSnapshot authors:" << query->lastError().text();
+        return {};
+    }
+    ReadAdjacency(query, snapshot->book_ids, first_book, interner, snapshot->book_author_ends, snapshot->book_authors);
+
+    query = database_manager->GetCachedQuery("SELECT Book2Genre.book_id, Genre.name FROM Book2Genre "
+                                             "JOIN Genre ON Genre.id = Book2Genre.genre_id "
+                                             "WHERE Book2Genre.book_id > :after_id "
+                                             "ORDER BY Book2Genre.book_id, Genre.name");
+    if (!query) {
+        return {};
+    }
+    query->bindValue(":after_id", after_book_id);
+    if (!database_manager->Exec(query)) {
+        qCritical() << "CatalogueSnapshot genres:" << query->lastError().text();
+        return {};
+    }
+    ReadAdjacency(query, snapshot->book_ids, first_book, interner, snapshot->book_genre_ends, snapshot->book_genres);
+
+    // Editions
+    query = database_manager->GetCachedQuery("SELECT E.id, E.book_id, Publisher.name, Language.name, Series.name, "
+                                             "E.page_count, E.isbn FROM Edition AS E "
+                                             "LEFT JOIN Publisher ON Publisher.id = E.publisher_id "
+                                             "LEFT JOIN Language ON Language.id = E.language_id "
+                                             "LEFT JOIN Series ON Series.id = E.series_id "
+                                             "WHERE E.id > :after_id ORDER BY E.id");
+    if (!query) {
+        return {};
+    }
+    query->bindValue(":after_id", first_edition > 0 ? snapshot->edition_ids.Last() : 0);
+    if (!database_manager->Exec(query)) {
+        qCritical() << "CatalogueSnapshot editions:" << query->lastError().text();
+        return {};
+    }
+    while (query->next()) {
+        snapshot->edition_ids.Append(query->value(0).toInt());
+        snapshot->edition_books.Append(Find(snapshot->book_ids, query->value(1).toInt()));
+        snapshot->edition_publishers.Append(interner.Intern(query->value(2)));
+        snapshot->edition_languages.Append(interner.Intern(query->value(3)));
+        snapshot->edition_series.Append(interner.Intern(query->value(4)));
+        snapshot->edition_page_counts.Append(query->value(5).toInt()); // NULL reads as 0
+        snapshot->edition_isbns.Append(query->value(6).toString());
+    }
+    database_manager->RecordRows(*query, snapshot->edition_ids.Size() - first_edition);
+
+    // Readable items
+    query = database_manager->GetCachedQuery("SELECT id, type, edition_id, issue_id FROM RItem WHERE id > :after_id ORDER BY id");
+    if (!query) {
+        return {};
+    }
+    query->bindValue(":after_id", first_r_item > 0 ? snapshot->r_item_ids.Last() : 0);
+    if (!database_manager->Exec(query)) {
+        qCritical() << "CatalogueSnapshot items:" << query->lastError().text();
+        return {};
+    }
+    while (query->next()) {
+        snapshot->r_item_ids.Append(query->value(0).toInt());
+        snapshot->r_item_types.Append(static_cast<quint8>(query->value(1).toInt()));
+        snapshot->r_item_editions.Append(query->value(2).isNull() ? -1 : Find(snapshot->edition_ids, query->value(2).toInt()));
+        snapshot->r_item_issue_ids.Append(query->value(3).toInt());
+    }
+    database_manager->RecordRows(*query, snapshot->r_item_ids.Size() - first_r_item);
+
+    if (!transaction.Commit()) {
+        qCritical() << "CatalogueSnapshot: failed to commit transaction";
+        return {};
+    }
+
+    name_lock.unlock();
+
+    snapshot->SortNewBooks(first_book);
+
+    snapshot->names.Squeeze();
+    snapshot->book_ids.Squeeze();
+    snapshot->book_titles.Squeeze();
+    snapshot->book_author_ends.Squeeze();
+    snapshot->book_authors.Squeeze();
+    snapshot->book_genre_ends.Squeeze();
+    snapshot->book_genres.Squeeze();
+    snapshot->edition_ids.Squeeze();
+    snapshot->edition_books.Squeeze();
+    snapshot->edition_publishers.Squeeze();
+    snapshot->edition_languages.Squeeze();
+    snapshot->edition_series.Squeeze();
+    snapshot->edition_page_counts.Squeeze();
+    snapshot->edition_isbns.Squeeze();
+    snapshot->r_item_ids.Squeeze();
+    snapshot->r_item_types.Squeeze();
+    snapshot->r_item_editions.Squeeze();
+    snapshot->r_item_issue_ids.Squeeze();
+
+    return snapshot;
+}
+
+QFuture<QSharedPointer<const CatalogueSnapshot>> CatalogueSnapshot::LoadAsync(DatabaseExecutor* executor, QSharedPointer<const CatalogueSnapshot> base)
+{
+    return executor->Run([base](Library& library) {
+        return Load(library, base);
+    });
+}
+
+bool CatalogueSnapshot::Extends(const CatalogueSnapshot& other) const
+{
+    return name_index == other.name_index
+        && BookCount() >= other.BookCount()
+        && EditionCount() >= other.EditionCount()
+        && RItemCount() >= other.RItemCount();
+}
+
+int CatalogueSnapshot::BookCount() const
+{
+    return book_ids.Size();
+}
+
+int CatalogueSnapshot::BookId(int book) const
+{
+    return book_ids.At(book);
+}
+
+QStringView CatalogueSnapshot::BookTitle(int book) const
+{
+    return book_titles.At(book);
+}
+
+int CatalogueSnapshot::BookAuthorCount(int book) const
+{
+    return book_author_ends.At(book) - BookAuthorBegin(book);
+}
+
+QStringView CatalogueSnapshot::BookAuthor(int book, int i) const
+{
+    return names.At(book_authors.At(BookAuthorBegin(book) + i));
+}
+
+QStringList CatalogueSnapshot::BookGenres(int book) const
+{
+    QStringList genres;
+    for (int i = BookGenreBegin(book); i < book_genre_ends.At(book); ++i) {
+        genres.append(names.At(book_genres.At(i)).toString());
+    }
+    return genres;
+}
+
+BookListRow CatalogueSnapshot::GetBookRow(int book) const
+{
+    BookListRow row{BookId(book), BookTitle(book).toString(), {}};
+    for (int i = 0; i < BookAuthorCount(book); ++i) {
+        row.authors.append(BookAuthor(book, i).toString());
+    }
+    return row;
+}
+
+int CatalogueSnapshot::BookAtTitleRank(int rank) const
+{
+    return books_by_title.At(rank);
+}
+
+int CatalogueSnapshot::BookTitleRank(int book) const
+{
+    return books_by_title.LowerBound(book, [this](int a, int b) {
+        return TitleLess(a, b);
+    });
+}
+
+int CatalogueSnapshot::EditionCount() const
+{
+    return edition_ids.Size();
+}
+
+int CatalogueSnapshot::EditionId(int edition) const
+{
+    return edition_ids.At(edition);
+}
+
+int CatalogueSnapshot::EditionBook(int edition) const
+{
+    return edition_books.At(edition);
+}
+
+QStringView CatalogueSnapshot::EditionPublisher(int edition) const
+{
+    return Name(edition_publishers.At(edition));
+}
+
+QStringView CatalogueSnapshot::EditionSeries(int edition) const
+{
+    return Name(edition_series.At(edition));
+}
+
+QStringView CatalogueSnapshot::EditionIsbn(int edition) const
+{
+    return edition_isbns.At(edition);
+}
+
+EditionListRow CatalogueSnapshot::GetEditionRow(int edition) const
+{
+    EditionListRow row;
+    row.edition_id = EditionId(edition);
+    row.publisher = EditionPublisher(edition).toString();
+    row.language = Name(edition_languages.At(edition)).toString();
+    row.series = EditionSeries(edition).toString();
+    row.page_count = edition_page_counts.At(edition);
+    row.isbn = EditionIsbn(edition).toString();
+
+    int book = EditionBook(edition);
+    if (book != -1) {
+        BookListRow book_row = GetBookRow(book);
+        row.book_id = book_row.id;
+        row.title = book_row.title;
+        row.authors = book_row.authors;
+    }
+    else {
+        row.book_id = 0;
+    }
+
+    return row;
+}
+
+int CatalogueSnapshot::RItemCount() const
+{
+    return r_item_ids.Size();
+}
+
+int CatalogueSnapshot::RItemId(int r_item) const
+{
+    return r_item_ids.At(r_item);
+}
+
+RItemListRow CatalogueSnapshot::GetRItemRow(int r_item) const
+{
+    RItemListRow row;
+    row.r_item_id = RItemId(r_item);
+    row.type = static_cast<RItemType>(r_item_types.At(r_item));
+    row.edition_id = 0;
+    row.issue_id = r_item_issue_ids.At(r_item);
+    row.book_id = 0;
+
+    int edition = r_item_editions.At(r_item);
+    if (edition != -1) {
+        EditionListRow edition_row = GetEditionRow(edition);
+        row.edition_id = edition_row.edition_id;
+        row.book_id = edition_row.book_id;
+        row.title = edition_row.title;
+        row.publisher = edition_row.publisher;
+        row.authors = edition_row.authors;
+    }
+
+    row.label = RItemManager::RItemLabel(row);
+    return row;
+}
+
+qint64 CatalogueSnapshot::MemoryUsage() const
+{
+    return sizeof(*this)
+        + names.MemoryUsage()
+        + book_ids.MemoryUsage() + book_titles.MemoryUsage()
+        + book_author_ends.MemoryUsage() + book_authors.MemoryUsage()
+        + book_genre_ends.MemoryUsage() + book_genres.MemoryUsage()
+        + books_by_title.MemoryUsage()
+        + edition_ids.MemoryUsage() + edition_books.MemoryUsage() + edition_publishers.MemoryUsage()
+        + edition_languages.MemoryUsage() + edition_series.MemoryUsage() + edition_page_counts.MemoryUsage()
+        + edition_isbns.MemoryUsage()
+        + r_item_ids.MemoryUsage() + r_item_types.MemoryUsage() + r_item_editions.MemoryUsage() + r_item_issue_ids.MemoryUsage();
+}
+
+QStringView CatalogueSnapshot::Name(int name) const
+{
+    return name == -1 ? QStringView() : names.At(name);
+}
+
+int CatalogueSnapshot::BookAuthorBegin(int book) const
+{
+    return book == 0 ? 0 : book_author_ends.At(book - 1);
+}
+
+int CatalogueSnapshot::BookGenreBegin(int book) const
+{
+    return book == 0 ? 0 : book_genre_ends.At(book - 1);
+}
+
+bool CatalogueSnapshot::TitleLess(int a, int b) const
+{
+    QStringView title_a = BookTitle(a);
+    QStringView title_b = BookTitle(b);
+    return title_a < title_b || (title_a == title_b && a < b); // Positions follow the IDs
+}
+
+void CatalogueSnapshot::SortNewBooks(int first_book)
+{
+    const int new_count = BookCount() - first_book;
+    if (new_count == 0) {
+        return;
+    }
+
+    auto less = [this](int a, int b) {
+        return TitleLess(a, b);
+    };
+
+    QVector<int> new_books(new_count);
+    std::iota(new_books.begin(), new_books.end(), first_book);
+    std::sort(new_books.begin(), new_books.end(), less);
+
+    // A few books are placed by binary search, each copying one chunk of the
+    // order; many are merged in one pass, which costs less than that by then
+    if (new_count <= ChunkedOrder::kChunkSize) {
+        for (int book : std::as_const(new_books)) {
+            books_by_title.Insert(books_by_title.LowerBound(book, less), book);
+        }
+        return;
+    }
+
+    const QVector<int> old_books = books_by_title.ToVector();
+    QVector<int> merged;
+    merged.reserve(BookCount());
+    std::merge(old_books.cbegin(), old_books.cend(), new_books.cbegin(), new_books.cend(), std::back_inserter(merged), less);
+
+    books_by_title = ChunkedOrder();
+    for (int book : std::as_const(merged)) {
+        books_by_title.Append(book);
+    }
+}
+
+int CatalogueSnapshot::Find(const ChunkedVector<int>& ids, int id)
+{
+    int position = ids.LowerBound(id);
+    return position < ids.Size() && ids.At(position) == id ? position : -1;
+}
@@ -0,0 +1,357 @@
+#ifndef CATALOGUE_SNAPSHOT_H
+#define CATALOGUE_SNAPSHOT_H
+
+#include "databaseexecutor.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QStringView>
+#include <QVector>
+
+#include <algorithm>
+
+/**
+ * @file cataloguesnapshot.h
+ * @brief Header file for ChunkedVector, StringArena, ChunkedOrder and CatalogueSnapshot classes.
+ *
+ * CatalogueSnapshot is an immutable, columnar copy of the books, editions
+ * and readable items, shared by the combo boxes and the edition filter
+ * instead of each holding its own rows. Every column is an array indexed
+ * by row position; strings live back to back in arenas addressed by
+ * offset, names are stored once however many rows use them, and the
+ * authors and genres of the books are adjacency lists in CSR form (an
+ * offsets array into one array of name indices).
+ *
+ * Rows are ordered by ID. New rows always get the highest IDs, so a
+ * snapshot is brought up to date by appending the rows above its last IDs
+ * to a copy; the positions of existing rows never change between such
+ * snapshots. Columns are stored in implicitly shared chunks, so the copy
+ * shares every chunk but the last one of each column with its base, and
+ * an update costs the rows it adds rather than the size of the catalogue.
+ */
+
+/**
+ * @class ChunkedVector
+ * @brief Append-only array stored in fixed-size, implicitly shared chunks.
+ *
+ * Copies share every chunk. Appending to a copy detaches the chunk list and
+ * the last chunk only, so it never copies more than one chunk of elements.
+ */
+template <typename T>
+class ChunkedVector
+{
+public:
+    static constexpr int kChunkSize = 4096; ///< Elements per chunk
+
+    /**
+     * @brief Appends an element.
+     *
+     * @param value The element.
+     */
+    void Append(const T& value)
+    {
+        if (size % kChunkSize == 0) {
+            chunks.append(QVector<T>());
+            chunks.last().reserve(kChunkSize);
+        }
+        chunks.last().append(value);
+        ++size;
+    }
+
+    const T& At(int index) const { return chunks.at(index / kChunkSize).at(index % kChunkSize); } ///< An element, from 0 to Size() - 1
+    const T& Last() const { return chunks.constLast().constLast(); } ///< The last element, the vector must not be empty
+    int Size() const { return size; } ///< Number of elements
+
+    /**
+     * @brief Finds an element in an ascending vector.
+     *
+     * @param value The element to look for.
+     * @return int Index of the first element not less than value, Size() if there is none.
+     */
+    int LowerBound(const T& value) const
+    {
+        auto chunk = std::partition_point(chunks.cbegin(), chunks.cend(), [&value](const QVector<T>& elements) {
+            return elements.constLast() < value;
+        });
+        if (chunk == chunks.cend()) {
+            return size;
+        }
+        return int(chunk - chunks.cbegin()) * kChunkSize + int(std::lower_bound(chunk->cbegin(), chunk->cend(), value) - chunk->cbegin());
+    }
+
+    /**
+     * @brief Releases the unused capacity of the last chunk, the others are full.
+     */
+    void Squeeze()
+    {
+        // Shared chunks are squeezed already, detaching them would copy for nothing
+        if (!chunks.isEmpty() && chunks.constLast().capacity() > chunks.constLast().size()) {
+            chunks.last().squeeze();
+        }
+    }
+
+    /**
+     * @brief Get the heap memory held by the vector, shared chunks included.
+     *
+     * @return qint64 Allocated bytes.
+     */
+    qint64 MemoryUsage() const
+    {
+        qint64 bytes = chunks.capacity() * qint64(sizeof(QVector<T>));
+        for (const QVector<T>& chunk : chunks) {
+            bytes += chunk.capacity() * qint64(sizeof(T));
+        }
+        return bytes;
+    }
+
+private:
+    QVector<QVector<T>> chunks; ///< Full chunks, then the last one
+    int size = 0; ///< Number of elements
+};
+
+/**
+ * @class StringArena
+ * @brief Append-only list of strings stored back to back in shared chunks.
+ */
+class StringArena
+{
+public:
+    static constexpr int kChunkSize = 4096; ///< Strings per chunk
+
+    /**
+     * @brief Appends a string.
+     *
+     * @param value The string.
+     * @return int Index of the string.
+     */
+    int Append(QStringView value);
+
+    /**
+     * @brief Get a string.
+     *
+     * @param index Index of the string, from 0 to Size() - 1.
+     * @return QStringView View into the arena, valid while the arena is.
+     */
+    QStringView At(int index) const;
+
+    /**
+     * @brief Get the number of strings.
+     *
+     * @return int The number of strings.
+     */
+    int Size() const;
+
+    /**
+     * @brief Releases the unused capacity of the last chunk once the arena is complete.
+     */
+    void Squeeze();
+
+    /**
+     * @brief Get the heap memory held by the arena, shared chunks included.
+     *
+     * @return qint64 Allocated bytes.
+     */
+    qint64 MemoryUsage() const;
+
+private:
+    /**
+     * @struct Chunk
+     * @brief Up to kChunkSize strings, back to back.
+     */
+    struct Chunk {
+        QString text; ///< The strings, back to back
+        QVector<int> ends; ///< End of each string in text
+    };
+
+    QVector<Chunk> chunks; ///< Full chunks, then the last one
+    int size = 0; ///< Number of strings
+};
+
+/**
+ * @class ChunkedOrder
+ * @brief Row positions in a sort order, stored in implicitly shared chunks.
+ *
+ * Inserting a position copies the chunk it lands in and the chunk list
+ * only, a chunk is split once it holds twice kChunkSize positions.
+ */
+class ChunkedOrder
+{
+public:
+    static constexpr int kChunkSize = 4096; ///< Positions per chunk when appended
+
+    /**
+     * @brief Appends a position after the others.
+     *
+     * @param position The position.
+     */
+    void Append(int position);
+
+    /**
+     * @brief Inserts a position.
+     *
+     * @param rank Rank of the position, from 0 to Size().
+     * @param position The position.
+     */
+    void Insert(int rank, int position);
+
+    int At(int rank) const; ///< Position at a rank, from 0 to Size() - 1
+    int Size() const; ///< Number of positions
+    QVector<int> ToVector() const; ///< Every position, in order
+
+    /**
+     * @brief Finds where a position belongs in the order.
+     *
+     * @param position The position.
+     * @param less Ordering of two positions, the one the order is sorted by.
+     * @return int Rank of the first position not less than position, Size() if there is none.
+     */
+    template <typename Less>
+    int LowerBound(int position, Less less) const
+    {
+        auto chunk = std::partition_point(chunks.cbegin(), chunks.cend(), [&](const QVector<int>& positions) {
+            return less(positions.constLast(), position);
+        });
+        if (chunk == chunks.cend()) {
+            return Size();
+        }
+        int index = int(chunk - chunks.cbegin());
+        return ChunkBegin(index) + int(std::lower_bound(chunk->cbegin(), chunk->cend(), position, less) - chunk->cbegin());
+    }
+
+    /**
+     * @brief Get the heap memory held by the order, shared chunks included.
+     *
+     * @return qint64 Allocated bytes.
+     */
+    qint64 MemoryUsage() const;
+
+private:
+    QVector<QVector<int>> chunks; ///< The positions, none of the chunks is empty
+    QVector<int> chunk_ends; ///< Rank after the last position of each chunk
+
+    int ChunkOf(int rank) const; ///< Chunk holding a rank
+    int ChunkBegin(int chunk) const; ///< Rank of the first position of a chunk
+};
+
+/**
+ * @class CatalogueSnapshot
+ * @brief Immutable, thread-safe columnar snapshot of the catalogue.
+ *
+ * Rows are addressed by position: books, editions and items are each
+ * ordered by ID, and references between them are positions, -1 when unset.
+ */
+class CatalogueSnapshot
+{
+public:
+    /**
+     * @brief Loads the catalogue, or the rows added since a snapshot.
+     *
+     * All rows are read in one pass per table. With a base snapshot only the
+     * rows above its last IDs are read and appended to a copy of it, the
+     * names are looked up in the index of its lineage and the new books are
+     * placed in the title order by binary search.
+     *
+     * @param library The library to read from.
+     * @param base Snapshot to extend, nullptr to load everything.
+     * @return QSharedPointer<const CatalogueSnapshot> The snapshot, nullptr on a database error.
+     */
+    static QSharedPointer<const CatalogueSnapshot> Load(Library& library, const QSharedPointer<const CatalogueSnapshot>& base = {});
+
+    /**
+     * @brief Loads a snapshot on the database worker thread, see Load().
+     *
+     * @param executor The executor to run the queries on.
+     * @param base Snapshot to extend, nullptr to load everything.
+     * @return QFuture<QSharedPointer<const CatalogueSnapshot>> The snapshot, nullptr on a database error.
+     */
+    static QFuture<QSharedPointer<const CatalogueSnapshot>> LoadAsync(DatabaseExecutor* executor, QSharedPointer<const CatalogueSnapshot> base = {});
+
+    /**
+     * @brief Checks whether this snapshot extends another one.
+     *
+     * @param other The older snapshot.
+     * @return true if this snapshot was appended to from other, so every position of other is unchanged.
+     */
+    bool Extends(const CatalogueSnapshot& other) const;
+
+    int BookCount() const; ///< Number of books
+    int BookId(int book) const; ///< ID of the book at a position
+    QStringView BookTitle(int book) const; ///< Title of a book
+    int BookAuthorCount(int book) const; ///< Number of authors of a book
+    QStringView BookAuthor(int book, int i) const; ///< Author i of a book, authors are ordered by name
+    QStringList BookGenres(int book) const; ///< Genres of a book, ordered by name
+    BookListRow GetBookRow(int book) const; ///< Materializes a book as a list row
+
+    int BookAtTitleRank(int rank) const; ///< Book at a rank of the order of the book lists, by title then ID
+    int BookTitleRank(int book) const; ///< Rank of a book in that order, found by binary search
+
+    int EditionCount() const; ///< Number of editions
+    int EditionId(int edition) const; ///< ID of the edition at a position
+    int EditionBook(int edition) const; ///< Position of the book of an edition, -1 if missing
+    QStringView EditionPublisher(int edition) const; ///< Publisher of an edition, empty if not set
+    QStringView EditionSeries(int edition) const; ///< Series of an edition, empty if not set
+    QStringView EditionIsbn(int edition) const; ///< ISBN of an edition, empty if not set
+    EditionListRow GetEditionRow(int edition) const; ///< Materializes an edition as a list row
+
+    int RItemCount() const; ///< Number of readable items
+    int RItemId(int r_item) const; ///< ID of the item at a position
+    RItemListRow GetRItemRow(int r_item) const; ///< Materializes an item as a list row, with its label
+
+    /**
+     * @brief Get the heap memory held by the snapshot.
+     *
+     * @return qint64 Allocated bytes of every column and arena.
+     */
+    qint64 MemoryUsage() const;
+
+private:
+    /**
+     * @struct NameIndex
+     * @brief Index of each name in the arenas of a lineage of snapshots.
+     *
+     * A full load starts a lineage and the snapshots appended to it share
+     * the index, so an update looks up only the names it reads. Snapshots
+     * appended to the same base may give one index to different names, a
+     * hit is therefore checked against the arena it is used with.
+     */
+    struct NameIndex {
+        QMutex mutex; ///< Held by the load appending to the lineage
+        QHash<QString, int> indices; ///< Index of each name in the arena
+    };
+
+    QSharedPointer<NameIndex> name_index; ///< Shared by a full load and the snapshots appended to it
+
+    StringArena names; ///< Author, genre, publisher, language and series names, each stored once
+
+    ChunkedVector<int> book_ids; ///< Book IDs, ascending
+    StringArena book_titles; ///< Title of each book
+    ChunkedVector<int> book_author_ends; ///< CSR end of each book's authors in book_authors, a book's authors start where the previous book's end
+    ChunkedVector<int> book_authors; ///< Name indices of the authors of all books
+    ChunkedVector<int> book_genre_ends; ///< CSR end of each book's genres in book_genres
+    ChunkedVector<int> book_genres; ///< Name indices of the genres of all books
+    ChunkedOrder books_by_title; ///< Book positions ordered by title, then ID
+
+    ChunkedVector<int> edition_ids; ///< Edition IDs, ascending
+    ChunkedVector<int> edition_books; ///< Book position of each edition, -1 if missing
+    ChunkedVector<int> edition_publishers; ///< Name index of each publisher, -1 if not set
+    ChunkedVector<int> edition_languages; ///< Name index of each language, -1 if not set
+    ChunkedVector<int> edition_series; ///< Name index of each series, -1 if not set
+    ChunkedVector<int> edition_page_counts; ///< Page count of each edition, 0 if not set
+    StringArena edition_isbns; ///< ISBN of each edition, empty if not set
+
+    ChunkedVector<int> r_item_ids; ///< Item IDs, ascending
+    ChunkedVector<quint8> r_item_types; ///< RItemType of each item
+    ChunkedVector<int> r_item_editions; ///< Edition position of each item, -1 if not an edition
+    ChunkedVector<int> r_item_issue_ids; ///< Issue ID of each item, 0 if not an issue
+
+    QStringView Name(int name) const; ///< A name, empty for -1
+    int BookAuthorBegin(int book) const; ///< CSR start of a book's authors
+    int BookGenreBegin(int book) const; ///< CSR start of a book's genres
+    bool TitleLess(int a, int b) const; ///< Orders two books by title, then ID
+    void SortNewBooks(int first_book); ///< Adds the books from first_book on to books_by_title
+
+    static int Find(const ChunkedVector<int>& ids, int id); ///< Position of an ID in an ascending ID column, -1 if missing
+};
+
+#endif // CATALOGUE_SNAPSHOT_H
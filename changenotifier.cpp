@@ -0,0 +1,15 @@
+#include "changenotifier.h"
+
+ChangeNotifier::ChangeNotifier(QObject* parent)
+    : QObject(parent)
+{
+    // Changed() crosses from the database thread to the UI thread
+    qRegisterMetaType<QList<ChangeEvent>>();
+}
+
+void ChangeNotifier::Publish(const QList<ChangeEvent>& events)
+{
+    if (!events.isEmpty()) {
+        emit Changed(events);
+    }
+}
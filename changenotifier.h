@@ -0,0 +1,74 @@
+#ifndef CHANGE_NOTIFIER_H
+#define CHANGE_NOTIFIER_H
+
+#include <QObject>
+#include <QList>
+#include <QString>
+
+/**
+ * @file changenotifier.h
+ * @brief Header file for ChangeEvent and ChangeNotifier.
+ *
+ * Managers publish a ChangeEvent for every row they write. The events of a
+ * transaction are held back by DatabaseManager until the outermost commit and
+ * dropped on rollback, then delivered together through ChangeNotifier so
+ * views can apply row-level updates instead of reloading.
+ */
+
+enum class IdNameTable; // Defined in idnametablemanager.h
+
+/**
+ * @brief Kind of change described by a ChangeEvent.
+ */
+enum class ChangeType {
+    BookInserted, ///< A book was inserted, name holds its display label
+    EditionInserted, ///< An edition was inserted
+    RItemInserted, ///< A readable item was inserted, name holds its display label
+    MyLibraryInserted, ///< An item was added to MyLibrary
+    NameInserted, ///< A name was inserted into the lookup table in table
+    Reset ///< Many rows changed at once, views should reload
+};
+
+/**
+ * @brief One committed change to the database.
+ */
+struct ChangeEvent {
+    ChangeType type; ///< Kind of change
+    int id; ///< ID of the inserted row, -1 for Reset
+    QString name; ///< Name or display label of the inserted row, see ChangeType
+    IdNameTable table{}; ///< Lookup table of a NameInserted event
+};
+
+Q_DECLARE_METATYPE(ChangeEvent)
+
+/**
+ * @class ChangeNotifier
+ * @brief Delivers committed change events to the UI.
+ *
+ * Publish() may be called from any thread; receivers living in other threads
+ * get the events through queued connections in commit order.
+ */
+class ChangeNotifier : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ChangeNotifier(QObject* parent = nullptr);
+
+    /**
+     * @brief Emits Changed() for a batch of committed events.
+     * 
+     * @param events The events of one transaction, in the order they were published.
+     */
+    void Publish(const QList<ChangeEvent>& events);
+
+signals:
+    /**
+     * @brief Emitted once per committed transaction that changed rows.
+     * 
+     * @param events The events of the transaction.
+     */
+    void Changed(const QList<ChangeEvent>& events);
+};
+
+#endif // CHANGE_NOTIFIER_H
@@ -0,0 +1,275 @@
+#include "libraryimporter.h"
+#include "libraryexporter.h"
+#include "calibreimporter.h"
+#include "tracer.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QTextStream>
+
+/**
+ * @file main.cpp
+ * @brief reading-tracker-cli, batch operations on the library database without a display.
+ *
+ * Usage: reading-tracker-cli [options] <command> [arguments]
+ *
+ *   import <file>             Imports a CSV or JSON library export
+ *   import-calibre <file>     Imports a Calibre library from its metadata.db
+ *   export <file>             Exports the library, "-" writes CSV to standard output
+ *   stats                     Prints row counts and the database size
+ *   search <text>             Searches titles, authors, series, publishers and notes
+ *   vacuum                    Compacts the database and its search index
+ *
+ * Results go to standard output, progress and logging to standard error.
+ * With --query-stats the statement statistics of the command follow on
+ * standard error, and slow statements are logged to slow_queries.log next
+ * to the database. With --trace, in builds with tracing enabled, the
+ * command's spans are written as a Chrome trace file.
+ */
+
+namespace {
+
+QTextStream& Out()
+{
+    static QTextStream out(stdout);
+    return out;
+}
+
+QTextStream& Err()
+{
+    static QTextStream err(stderr);
+    return err;
+}
+
+int RunImport(Library& library, const QString& path, const ImportOptions& options)
+{
+    LibraryImporter importer(&library);
+    int imported = importer.ImportFile(path, options, [](const ImportProgress& progress) {
+        Err() << "\r" << progress.records_read << " records read, " << progress.books_imported << " imported";
+        if (progress.bytes_total > 0) {
+            Err() << " (" << progress.bytes_read * 100 / progress.bytes_total << "%)";
+        }
+        Err().flush();
+        return true;
+    });
+    Err() << '\n';
+
+    if (imported == -1) {
+        return 1;
+    }
+    Out() << imported << " books imported\n";
+    return 0;
+}
+
+int RunImportCalibre(Library& library, const QString& path)
+{
+    CalibreImporter importer(&library);
+    int imported = importer.Import(path);
+    if (imported == -1) {
+        return 1;
+    }
+    Out() << imported << " books imported\n";
+    return 0;
+}
+
+int RunExport(Library& library, const QString& path, ExportFormat format)
+{
+    LibraryExporter exporter(&library);
+
+    int written;
+    if (path == "-") {
+        QFile output;
+        if (!output.open(stdout, QIODevice::WriteOnly)) {
+            return 1;
+        }
+        written = exporter.ExportDevice(&output, format);
+    }
+    else {
+        written = exporter.ExportFile(path, format);
+        if (written != -1) {
+            Err() << written << " records exported\n";
+        }
+    }
+
+    return written == -1 ? 1 : 0;
+}
+
+int RunStats(Library& library, const QString& database_path)
+{
+    QSqlQuery query(library.database_manager->GetDatabase());
+    query.setForwardOnly(true);
+
+    const QStringList tables = {
+        "Book", "Edition", "RItem", "MyLibrary", "Author", "Publisher",
+        "Genre", "Language", "Series", "Shelf", "AcquiredFrom",
+    };
+    for (const QString& table : tables) {
+        if (!query.exec("SELECT COUNT(*) FROM " + table) || !query.next()) {
+            qCritical() << "stats:" << query.lastError().text();
+            return 1;
+        }
+        Out() << table << ": " << query.value(0).toLongLong() << '\n';
+    }
+
+    if (query.exec("SELECT SUM(page_count) FROM Edition JOIN RItem ON RItem.edition_id = Edition.id "
+                   "JOIN MyLibrary ON MyLibrary.r_item_id = RItem.id") && query.next()) {
+        Out() << "Pages in library: " << query.value(0).toLongLong() << '\n';
+    }
+
+    if (query.exec("PRAGMA user_version") && query.next()) {
+        Out() << "Schema version: " << query.value(0).toInt() << '\n';
+    }
+
+    Out() << "Database size: " << QFileInfo(database_path).size() << " bytes\n";
+    return 0;
+}
+
+int RunSearch(Library& library, const QString& text, int limit)
+{
+    const QList<SearchResult> results = library.search_manager->Search(text, limit);
+    for (const SearchResult& result : results) {
+        Out() << (result.kind == SearchResultKind::Book ? "book" : "note") << '\t'
+              << result.id << '\t'
+              << QString::number(result.score, 'f', 3) << '\t'
+              << result.title << '\t'
+              << result.snippet << '\n';
+    }
+    return 0;
+}
+
+int RunVacuum(Library& library, const QString& database_path)
+{
+    qint64 size_before = QFileInfo(database_path).size();
+
+    if (!library.search_manager->OptimizeIndex() || !library.database_manager->Vacuum()) {
+        return 1;
+    }
+
+    Out() << "Database size: " << size_before << " -> " << QFileInfo(database_path).size() << " bytes\n";
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    // Shares the application's AppData location and so its default database
+    QCoreApplication::setApplicationName("reading-tracker");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Batch operations on the reading tracker library.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("command", "import, import-calibre, export, stats, search or vacuum.");
+    parser.addPositionalArgument("argument", "File of import, import-calibre and export, text of search.", "[argument]");
+    QCommandLineOption database_option("database", "Database file, the application database by default.", "path");
+    QCommandLineOption profile_option("profile", "Database profile: " + DatabaseProfile::Names().join(", ") + ".", "name");
+    QCommandLineOption format_option("format", "File format of import and export: auto, csv or json.", "format", "auto");
+    QCommandLineOption batch_option("batch-size", "Records per transaction of import.", "count", "5000");
+    QCommandLineOption no_library_option("no-library", "Import editions without adding them to the library.");
+    QCommandLineOption limit_option("limit", "Maximum number of search results.", "count", "50");
+    QCommandLineOption query_stats_option("query-stats", "Print statement statistics and query plans after the command.");
+    parser.addOptions({database_option, profile_option, format_option, batch_option, no_library_option, limit_option,
+                       query_stats_option});
+    QCommandLineOption trace_option("trace", "Write a Chrome trace of the command.", "file");
+    if (Tracer::kCompiledIn) {
+        parser.addOption(trace_option);
+    }
+    parser.process(app);
+
+    const QStringList arguments = parser.positionalArguments();
+    const QString command = arguments.value(0);
+    const QStringList commands_with_argument = {"import", "import-calibre", "export", "search"};
+    const QStringList commands = commands_with_argument + QStringList{"stats", "vacuum"};
+    if (!commands.contains(command)) {
+        Err() << "Unknown command \"" << command << "\"\n\n" << parser.helpText();
+        return 2;
+    }
+    if (commands_with_argument.contains(command) && arguments.size() < 2) {
+        Err() << command << " needs an argument\n\n" << parser.helpText();
+        return 2;
+    }
+
+    const QString format_name = parser.value(format_option).toLower();
+    if (format_name != "auto" && format_name != "csv" && format_name != "json") {
+        Err() << "Unknown format \"" << format_name << "\"\n";
+        return 2;
+    }
+
+    // The application's profile unless one is given
+    DatabaseProfile profile = DatabaseManager::LoadDefaultProfile();
+    if (parser.isSet(profile_option)) {
+        bool ok = false;
+        profile = DatabaseProfile::Named(parser.value(profile_option), &ok);
+        if (!ok) {
+            Err() << "Unknown profile \"" << parser.value(profile_option) << "\"\n";
+            return 2;
+        }
+    }
+
+    const QString database_path = parser.isSet(database_option)
+        ? parser.value(database_option)
+        : DatabaseManager::DefaultDatabasePath();
+
+    DatabaseManager database_manager("cli", database_path, profile, ConnectionRole::Writer);
+    if (!database_manager.GetDatabase().isOpen()) {
+        return 1;
+    }
+    Library library(&database_manager);
+
+    QueryProfiler query_profiler;
+    if (parser.isSet(query_stats_option)) {
+        query_profiler.SetSlowLogPath(QFileInfo(database_path).dir().filePath("slow_queries.log"));
+        database_manager.SetQueryProfiler(&query_profiler);
+    }
+
+    if (Tracer::kCompiledIn && parser.isSet(trace_option)) {
+        Tracer::Instance().Start();
+    }
+
+    const QString argument = arguments.value(1);
+    int result;
+    if (command == "import") {
+        ImportOptions options;
+        options.format = format_name == "csv" ? ImportFormat::Csv
+                       : format_name == "json" ? ImportFormat::Json
+                       : ImportFormat::Auto;
+        options.batch_size = parser.value(batch_option).toInt();
+        options.add_to_library = !parser.isSet(no_library_option);
+        result = RunImport(library, argument, options);
+    }
+    else if (command == "import-calibre") {
+        result = RunImportCalibre(library, argument);
+    }
+    else if (command == "export") {
+        ExportFormat format = format_name == "csv" ? ExportFormat::Csv
+                            : format_name == "json" ? ExportFormat::Json
+                            : ExportFormat::Auto;
+        result = RunExport(library, argument, format);
+    }
+    else if (command == "stats") {
+        result = RunStats(library, database_path);
+    }
+    else if (command == "search") {
+        result = RunSearch(library, arguments.mid(1).join(' '), parser.value(limit_option).toInt());
+    }
+    else {
+        result = RunVacuum(library, database_path);
+    }
+
+    if (Tracer::kCompiledIn && parser.isSet(trace_option)) {
+        Tracer::Instance().Stop();
+        if (Tracer::Instance().WriteChromeTrace(parser.value(trace_option)) == -1) {
+            result = 1;
+        }
+    }
+
+    if (parser.isSet(query_stats_option)) {
+        Err() << '\n' << query_profiler.Report();
+    }
+    return result;
+}
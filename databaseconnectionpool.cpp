@@ -0,0 +1,112 @@
+#include "databaseconnectionpool.h"
+
+#include <QThread>
+#include <QMutexLocker>
+#include <QFileInfo>
+#include <QDir>
+
+DatabaseConnectionPool::DatabaseConnectionPool()
+    : DatabaseConnectionPool(DatabaseManager::DefaultDatabasePath(), DatabaseManager::LoadDefaultProfile())
+{
+}
+
+DatabaseConnectionPool::DatabaseConnectionPool(const QString& file_path, const DatabaseProfile& profile)
+    : file_path(file_path),
+      profile(profile),
+      schema_ready(false),
+      next_connection_id(0),
+      writer_thread(nullptr)
+{
+    // Slow queries are logged next to the database, like its settings file
+    query_profiler.SetSlowLogPath(QFileInfo(file_path).dir().filePath("slow_queries.log"));
+}
+
+DatabaseConnectionPool::~DatabaseConnectionPool()
+{
+    QMutexLocker locker(&mutex);
+
+    if (!writers.isEmpty() || !readers.isEmpty()) {
+        qWarning() << "DatabaseConnectionPool destroyed with" << writers.size() + readers.size()
+                   << "connections that were not released by their threads.";
+    }
+
+    qDeleteAll(writers);
+    qDeleteAll(readers);
+}
+
+DatabaseManager* DatabaseConnectionPool::Acquire(ConnectionRole role)
+{
+    QThread* thread = QThread::currentThread();
+    QMutexLocker locker(&mutex);
+
+    QHash<QThread*, DatabaseManager*>& connections = role == ConnectionRole::Writer ? writers : readers;
+    auto it = connections.constFind(thread);
+    if (it != connections.constEnd()) {
+        return it.value();
+    }
+
+    if (role == ConnectionRole::Writer && writer_thread) {
+        qCritical() << "Acquire failed: the writer connection is held by another thread.";
+        return nullptr;
+    }
+
+    EnsureSchema();
+    if (!schema_ready) {
+        qCritical() << "Acquire failed: the database schema could not be migrated.";
+        return nullptr;
+    }
+
+    QString connection_name = QString("reading-tracker-%1-%2")
+        .arg(role == ConnectionRole::Writer ? "writer" : "reader")
+        .arg(next_connection_id++);
+    DatabaseManager* connection = new DatabaseManager(connection_name, file_path, profile, role);
+    connection->SetChangeNotifier(&change_notifier);
+    connection->SetQueryProfiler(&query_profiler);
+
+    connections.insert(thread, connection);
+    if (role == ConnectionRole::Writer) {
+        writer_thread = thread;
+    }
+
+    return connection;
+}
+
+void DatabaseConnectionPool::ReleaseThread()
+{
+    QThread* thread = QThread::currentThread();
+    QMutexLocker locker(&mutex);
+
+    delete writers.take(thread);
+    delete readers.take(thread);
+
+    if (writer_thread == thread) {
+        writer_thread = nullptr;
+    }
+}
+
+const QString& DatabaseConnectionPool::GetFilePath() const
+{
+    return file_path;
+}
+
+ChangeNotifier* DatabaseConnectionPool::GetChangeNotifier()
+{
+    return &change_notifier;
+}
+
+QueryProfiler* DatabaseConnectionPool::GetQueryProfiler()
+{
+    return &query_profiler;
+}
+
+void DatabaseConnectionPool::EnsureSchema()
+{
+    if (schema_ready) {
+        return;
+    }
+
+    // A short-lived writer creates the file, sets the journal mode and migrates,
+    // it is closed again when a migration fails, so readers never see a half-migrated file
+    DatabaseManager migration_connection(QString("reading-tracker-migrate"), file_path, profile, ConnectionRole::Writer);
+    schema_ready = migration_connection.GetDatabase().isOpen();
+}
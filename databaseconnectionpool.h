@@ -0,0 +1,110 @@
+#ifndef DATABASE_CONNECTION_POOL_H
+#define DATABASE_CONNECTION_POOL_H
+
+#include "databasemanager.h"
+
+#include <QMutex>
+#include <QHash>
+
+class QThread;
+
+/**
+ * @file databaseconnectionpool.h
+ * @brief Header file for DatabaseConnectionPool class.
+ *
+ * Qt SQL connections can only be used from the thread that created them.
+ * The pool hands every thread its own named connection to the same database
+ * file: at most one writer thread at a time, and any number of read-only
+ * connections, which WAL lets run alongside the writer.
+ */
+
+/**
+ * @class DatabaseConnectionPool
+ * @brief Hands out per-thread DatabaseManager connections to one database file.
+ */
+class DatabaseConnectionPool
+{
+public:
+    /**
+     * @brief Constructs a pool for the application database with the default profile.
+     */
+    DatabaseConnectionPool();
+
+    /**
+     * @brief Constructs a pool for the given database file.
+     * 
+     * @param file_path Path of the database file.
+     * @param profile Performance profile applied to every connection.
+     */
+    DatabaseConnectionPool(const QString& file_path, const DatabaseProfile& profile);
+
+    /**
+     * @brief Closes the connections that were not released by their threads.
+     */
+    ~DatabaseConnectionPool();
+
+    DatabaseConnectionPool(const DatabaseConnectionPool&) = delete;
+    DatabaseConnectionPool& operator=(const DatabaseConnectionPool&) = delete;
+
+    /**
+     * @brief Get the calling thread's connection for the given role, opening it on first use.
+     *
+     * The first connection of the pool migrates the schema, so readers can
+     * be acquired before any writer.
+     * 
+     * @param role Role of the connection.
+     * @return DatabaseManager* The connection owned by the pool, or nullptr if
+     *         a writer is requested while another thread holds it or the
+     *         schema could not be migrated.
+     */
+    DatabaseManager* Acquire(ConnectionRole role);
+
+    /**
+     * @brief Closes the calling thread's connections.
+     *
+     * Must be called on every thread that acquired a connection before the
+     * thread exits; releasing the writer lets another thread acquire it.
+     */
+    void ReleaseThread();
+
+    /**
+     * @brief Get the path of the database file.
+     * 
+     * @return const QString& The path.
+     */
+    const QString& GetFilePath() const;
+
+    /**
+     * @brief Get the notifier that every connection of the pool publishes committed changes to.
+     *
+     * The notifier lives in the thread that created the pool.
+     * 
+     * @return ChangeNotifier* The notifier owned by the pool.
+     */
+    ChangeNotifier* GetChangeNotifier();
+
+    /**
+     * @brief Get the profiler that every connection of the pool records its statements in.
+     *
+     * The profiler is thread-safe, its report can be read from any thread.
+     * 
+     * @return QueryProfiler* The profiler owned by the pool.
+     */
+    QueryProfiler* GetQueryProfiler();
+
+private:
+    QString file_path; ///< Path of the database file
+    DatabaseProfile profile; ///< Performance profile applied to every connection
+    ChangeNotifier change_notifier; ///< Shared by all connections of the pool
+    QueryProfiler query_profiler; ///< Shared by all connections of the pool
+    QMutex mutex; ///< Guards the members below
+    bool schema_ready; ///< Whether the schema has been migrated successfully
+    int next_connection_id; ///< Suffix of the next connection name
+    QThread* writer_thread; ///< Thread holding the writer connection, or nullptr
+    QHash<QThread*, DatabaseManager*> writers; ///< Writer connection by thread
+    QHash<QThread*, DatabaseManager*> readers; ///< Reader connections by thread
+
+    void EnsureSchema(); ///< Migrates the schema once, must be called with the mutex held
+};
+
+#endif // DATABASE_CONNECTION_POOL_H
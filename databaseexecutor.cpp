@@ -0,0 +1,40 @@
+#include "databaseexecutor.h"
+
+DatabaseExecutor::DatabaseExecutor(DatabaseConnectionPool* pool, ConnectionRole role, QObject* parent)
+    : QObject(parent),
+      worker_context(new QObject),
+      connection_pool(pool),
+      role(role),
+      library(nullptr)
+{
+    thread.setObjectName(role == ConnectionRole::Writer ? "DatabaseWriter" : "DatabaseReader");
+    worker_context->moveToThread(&thread);
+    thread.start();
+}
+
+DatabaseExecutor::~DatabaseExecutor()
+{
+    // Runs after every job queued so far, on the thread owning the connection
+    QMetaObject::invokeMethod(worker_context, [this]() {
+        delete library;
+        library = nullptr;
+        connection_pool->ReleaseThread();
+    }, Qt::BlockingQueuedConnection);
+
+    thread.quit();
+    thread.wait();
+    delete worker_context;
+}
+
+Library& DatabaseExecutor::GetLibrary()
+{
+    Q_ASSERT(QThread::currentThread() == &thread);
+
+    if (!library) {
+        // Managers check the connection themselves and fail their calls if it is missing
+        DatabaseManager* database_manager = connection_pool->Acquire(role);
+        library = new Library(database_manager);
+    }
+
+    return *library;
+}
@@ -0,0 +1,96 @@
+#ifndef DATABASE_EXECUTOR_H
+#define DATABASE_EXECUTOR_H
+
+#include "library.h"
+#include "databaseconnectionpool.h"
+#include "tracer.h"
+
+#include <QObject>
+#include <QThread>
+#include <QFuture>
+#include <QPromise>
+
+#include <memory>
+#include <type_traits>
+
+/**
+ * @file databaseexecutor.h
+ * @brief Header file for DatabaseExecutor class.
+ *
+ * DatabaseExecutor runs database jobs on a dedicated worker thread that owns
+ * its own pooled connection and Library, so the UI thread never blocks on SQL.
+ * Reader executors can run alongside the single writer executor.
+ */
+
+/**
+ * @class DatabaseExecutor
+ * @brief Runs jobs against a Library on a dedicated database thread.
+ *
+ * Jobs run one at a time in submission order. Results are returned through
+ * QFuture; continuations attached with QFuture::then(context, ...) are
+ * delivered on the context's thread in the same order.
+ */
+class DatabaseExecutor : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Starts the worker thread. The connection is acquired by the first job.
+     * 
+     * @param pool Pool to acquire the worker's connection from, must outlive the executor.
+     * @param role Role of the worker's connection.
+     * @param parent Parent QObject.
+     */
+    DatabaseExecutor(DatabaseConnectionPool* pool, ConnectionRole role, QObject* parent = nullptr);
+
+    /**
+     * @brief Waits for pending jobs, closes the connection and stops the worker thread.
+     */
+    ~DatabaseExecutor();
+
+    /**
+     * @brief Queues a job on the worker thread.
+     * 
+     * @param job Callable taking a Library& and returning the result.
+     * @return QFuture of the job's result.
+     */
+    template <typename Function>
+    auto Run(Function job) -> QFuture<std::invoke_result_t<Function, Library&>>;
+
+private:
+    QThread thread; ///< The database worker thread
+    QObject* worker_context; ///< Object living in the worker thread that jobs are queued on
+    DatabaseConnectionPool* connection_pool; ///< Pool the worker connection is acquired from
+    ConnectionRole role; ///< Role of the worker connection
+    Library* library; ///< Worker managers, created and used on the worker thread only
+
+    Library& GetLibrary(); ///< Acquires the worker connection on first use, must run on the worker thread
+};
+
+template <typename Function>
+auto DatabaseExecutor::Run(Function job) -> QFuture<std::invoke_result_t<Function, Library&>>
+{
+    using Result = std::invoke_result_t<Function, Library&>;
+
+    // QPromise is move-only, the queued functor shares it instead
+    auto promise = std::make_shared<QPromise<Result>>();
+    QFuture<Result> future = promise->future();
+    promise->start();
+
+    QMetaObject::invokeMethod(worker_context, [this, promise, job = std::move(job)]() mutable {
+        RT_TRACE_SCOPE("executor", "DatabaseExecutor::Run");
+
+        if constexpr (std::is_void_v<Result>) {
+            job(GetLibrary());
+        }
+        else {
+            promise->addResult(job(GetLibrary()));
+        }
+        promise->finish();
+    }, Qt::QueuedConnection);
+
+    return future;
+}
+
+#endif // DATABASE_EXECUTOR_H
@@ -1,10 +1,62 @@
 #include "databasemanager.h"
+#include "schemamigrator.h"
+#include "tracer.h"
 
 #include <QStandardPaths>
 #include <QDir>
 #include <QFileInfo>
+#include <QSettings>
+#include <QElapsedTimer>
+#include <QRegularExpression>
 
-DatabaseManager::DatabaseManager()
+DatabaseManager::DatabaseManager(const QString& connection_name)
+    : DatabaseManager(connection_name, DefaultDatabasePath(), LoadDefaultProfile(), ConnectionRole::Writer)
+{
+}
+
+DatabaseManager::DatabaseManager(const QString& connection_name,
+                                 const QString& file_path,
+                                 const DatabaseProfile& profile,
+                                 ConnectionRole role)
+    : connection_name(connection_name),
+      profile(profile),
+      role(role),
+      transaction_depth(0),
+      rollback_count(0),
+      statement_cache_hits(0),
+      statement_cache_misses(0),
+      change_notifier(nullptr),
+      change_suppression_depth(0),
+      query_profiler(nullptr)
+{
+    // Set up the database connection
+    db = QSqlDatabase::addDatabase("QSQLITE", connection_name);
+    db.setDatabaseName(file_path);
+    if (role == ConnectionRole::Reader) {
+        db.setConnectOptions("QSQLITE_OPEN_READONLY");
+    }
+
+    if (!db.open()) {
+        qCritical() << "Failed to open database:" << db.lastError().text();
+    }
+    else {
+        qDebug() << "Database opened successfully at:" << file_path << "as" << connection_name;
+
+        ApplyProfile();
+
+        // Bring the schema up to date, a no-op once it is current
+        if (role == ConnectionRole::Writer) {
+            SchemaMigrator migrator(this);
+            if (!migrator.Migrate()) {
+                // Nothing may run against a schema the code does not match
+                qCritical() << "Failed to migrate database schema.";
+                db.close();
+            }
+        }
+    }
+}
+
+QString DatabaseManager::DefaultDatabasePath()
 {
     // Determine the AppData location
     QString appDataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
@@ -16,29 +68,414 @@ DatabaseManager::DatabaseManager()
     }
 
     // Full path to the database file
-    QString dbFilePath = dir.filePath("reading_tracker.db");
-
-    // Set up the database connection
-    db = QSqlDatabase::addDatabase("QSQLITE");
-    db.setDatabaseName(dbFilePath);
+    return dir.filePath("reading_tracker.db");
+}
 
-    if (!db.open()) {
-        qCritical() << "Failed to open database:" << db.lastError().text();
-    }
-    else {
-        qDebug() << "Database opened successfully at:" << dbFilePath;
-    }
+DatabaseProfile DatabaseManager::LoadDefaultProfile()
+{
+    // Performance profile from the environment or the settings file next to the database
+    QFileInfo database_file(DefaultDatabasePath());
+    QSettings settings(database_file.dir().filePath("settings.ini"), QSettings::IniFormat);
+    return DatabaseProfile::Load(&settings);
 }
 
 DatabaseManager::~DatabaseManager()
 {
+    if (statement_cache_hits + statement_cache_misses > 0) {
+        qDebug() << "Statement cache hits:" << statement_cache_hits
+                 << "misses:" << statement_cache_misses
+                 << "statements:" << statement_cache.size();
+    }
+
+    // Statements must be finalized before the connection is closed
+    qDeleteAll(statement_cache);
+    statement_cache.clear();
+
     if (db.isOpen()) {
         db.close();
         qDebug() << "Database closed.";
     }
+
+    // The connection can only be removed once no handle refers to it
+    db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(connection_name);
 }
 
 QSqlDatabase& DatabaseManager::GetDatabase()
 {
     return db;
 }
+
+bool DatabaseManager::BeginTransaction()
+{
+    // Writers take the lock up front so they never fail on upgrade, readers
+    // only need a consistent view and never contend for it
+    QString sql = transaction_depth > 0
+        ? QString("SAVEPOINT sp_%1").arg(transaction_depth)
+        : role == ConnectionRole::Writer ? QString("BEGIN IMMEDIATE") : QString("BEGIN");
+
+    if (!ExecTransactionStatement(sql)) {
+        return false;
+    }
+
+    pending_change_marks.append(pending_changes.size());
+    transaction_depth++;
+    return true;
+}
+
+bool DatabaseManager::CommitTransaction()
+{
+    if (transaction_depth == 0) {
+        qWarning() << "CommitTransaction failed: no transaction is open";
+        return false;
+    }
+
+    QString sql = transaction_depth == 1
+        ? QString("COMMIT")
+        : QString("RELEASE sp_%1").arg(transaction_depth - 1);
+
+    if (!ExecTransactionStatement(sql)) {
+        return false;
+    }
+
+    // Released savepoints hand their events to the enclosing transaction
+    pending_change_marks.removeLast();
+    transaction_depth--;
+    if (transaction_depth == 0) {
+        QList<ChangeEvent> changes;
+        changes.swap(pending_changes);
+        if (change_notifier) {
+            change_notifier->Publish(changes);
+        }
+    }
+    return true;
+}
+
+bool DatabaseManager::RollbackTransaction()
+{
+    if (transaction_depth == 0) {
+        qWarning() << "RollbackTransaction failed: no transaction is open";
+        return false;
+    }
+
+    transaction_depth--;
+    rollback_count++;
+
+    // Drop the events published since the savepoint began
+    pending_changes.resize(pending_change_marks.takeLast());
+
+    if (transaction_depth == 0) {
+        return ExecTransactionStatement("ROLLBACK");
+    }
+
+    // Rolling back to a savepoint keeps it open, so release it afterwards
+    QString savepoint = QString("sp_%1").arg(transaction_depth);
+    return ExecTransactionStatement("ROLLBACK TO " + savepoint)
+        && ExecTransactionStatement("RELEASE " + savepoint);
+}
+
+const DatabaseProfile& DatabaseManager::GetProfile() const
+{
+    return profile;
+}
+
+ConnectionRole DatabaseManager::GetRole() const
+{
+    return role;
+}
+
+QSqlQuery* DatabaseManager::GetCachedQuery(const QString& sql)
+{
+    auto it = statement_cache.constFind(sql);
+    if (it != statement_cache.constEnd()) {
+        statement_cache_hits++;
+        it.value()->finish();
+        return it.value();
+    }
+
+    statement_cache_misses++;
+
+    QSqlQuery* query = new QSqlQuery(db);
+    query->setForwardOnly(true);
+    if (!query->prepare(sql)) {
+        qCritical() << "GetCachedQuery:" << sql << ":" << query->lastError().text();
+        delete query;
+        return nullptr;
+    }
+
+    statement_cache.insert(sql, query);
+    return query;
+}
+
+StatementCacheStats DatabaseManager::GetStatementCacheStats() const
+{
+    return StatementCacheStats{statement_cache_hits, statement_cache_misses, static_cast<int>(statement_cache.size())};
+}
+
+int DatabaseManager::GetTransactionDepth() const
+{
+    return transaction_depth;
+}
+
+quint64 DatabaseManager::GetRollbackCount() const
+{
+    return rollback_count;
+}
+
+void DatabaseManager::SetChangeNotifier(ChangeNotifier* notifier)
+{
+    change_notifier = notifier;
+}
+
+void DatabaseManager::PublishChange(const ChangeEvent& event)
+{
+    if (change_suppression_depth > 0 && event.type != ChangeType::Reset) {
+        return; // Covered by the Reset the bulk writer publishes
+    }
+
+    if (transaction_depth > 0) {
+        pending_changes.append(event);
+    }
+    else if (change_notifier) {
+        change_notifier->Publish({event});
+    }
+}
+
+void DatabaseManager::SuppressChanges()
+{
+    change_suppression_depth++;
+}
+
+void DatabaseManager::ResumeChanges()
+{
+    if (change_suppression_depth > 0) {
+        change_suppression_depth--;
+    }
+}
+
+bool DatabaseManager::Vacuum()
+{
+    if (transaction_depth > 0) {
+        qWarning() << "Vacuum failed: a transaction is open";
+        return false;
+    }
+
+    // Cached statements may hold read cursors that would block the rebuild
+    for (QSqlQuery* query : std::as_const(statement_cache)) {
+        query->finish();
+    }
+
+    return ExecTransactionStatement("VACUUM")
+        && ExecTransactionStatement("PRAGMA optimize");
+}
+
+void DatabaseManager::SetQueryProfiler(QueryProfiler* profiler)
+{
+    query_profiler = profiler;
+}
+
+bool DatabaseManager::Exec(QSqlQuery* query)
+{
+    RT_TRACE_SCOPE_DETAIL("sql", "DatabaseManager::Exec", query->lastQuery());
+
+    QElapsedTimer timer;
+    timer.start();
+    bool ok = query->exec();
+    ProfileExec(*query, timer.nsecsElapsed(), ok);
+    return ok;
+}
+
+bool DatabaseManager::Exec(QSqlQuery& query, const QString& sql)
+{
+    RT_TRACE_SCOPE_DETAIL("sql", "DatabaseManager::Exec", sql);
+
+    QElapsedTimer timer;
+    timer.start();
+    bool ok = query.exec(sql);
+    ProfileExec(query, timer.nsecsElapsed(), ok);
+    return ok;
+}
+
+void DatabaseManager::RecordRows(const QSqlQuery& query, qint64 rows)
+{
+    if (query_profiler) {
+        query_profiler->RecordRows(query.lastQuery(), rows);
+    }
+}
+
+void DatabaseManager::ProfileExec(QSqlQuery& query, qint64 elapsed_ns, bool ok)
+{
+    if (!query_profiler) {
+        return;
+    }
+
+    const QString sql = query.lastQuery();
+    qint64 rows = ok && !query.isSelect() ? query.numRowsAffected() : 0;
+    bool first = query_profiler->Record(sql, elapsed_ns, rows, ok);
+    bool slow = profile.slow_query_ms >= 0 && elapsed_ns >= profile.slow_query_ms * qint64(1000000);
+
+    // Plans are read once per template, and again with the values of a slow call
+    if (ok && (first || slow)) {
+        QStringList plan = ExplainQueryPlan(query);
+        if (first) {
+            query_profiler->SetPlan(sql, plan);
+        }
+        if (slow) {
+            query_profiler->LogSlowQuery(sql, query.boundValues(), elapsed_ns, plan);
+        }
+    }
+}
+
+QStringList DatabaseManager::ExplainQueryPlan(const QSqlQuery& query)
+{
+    static const QRegularExpression explainable("^\\s*(SELECT|INSERT|UPDATE|DELETE|REPLACE|WITH)\\b",
+                                                QRegularExpression::CaseInsensitiveOption);
+    QStringList plan;
+
+    const QString sql = query.lastQuery();
+    if (!explainable.match(sql).hasMatch()) {
+        return plan; // Transaction control, pragmas and schema changes have no plan
+    }
+
+    QSqlQuery explain(db);
+    explain.setForwardOnly(true);
+    if (!explain.prepare("EXPLAIN QUERY PLAN " + sql)) {
+        return plan;
+    }
+
+    const QVariantList values = query.boundValues();
+    for (int i = 0; i < values.size(); ++i) {
+        explain.bindValue(i, values.at(i));
+    }
+
+    if (!explain.exec()) {
+        return plan;
+    }
+
+    // Columns are id, parent, notused and detail; children are indented under their parent
+    QHash<int, int> depths;
+    while (explain.next()) {
+        int depth = depths.value(explain.value(1).toInt(), -1) + 1;
+        depths.insert(explain.value(0).toInt(), depth);
+        plan.append(QString(depth * 2, ' ') + explain.value(3).toString());
+    }
+
+    return plan;
+}
+
+bool DatabaseManager::ExecTransactionStatement(const QString& sql)
+{
+    RT_TRACE_SCOPE_DETAIL("sql", "DatabaseManager::ExecTransactionStatement", sql);
+
+    if (!db.isOpen()) {
+        qCritical() << "Database connection is not valid or open.";
+        return false;
+    }
+
+    QSqlQuery query(db);
+    if (!query.exec(sql)) {
+        qCritical() << sql << ":" << query.lastError().text();
+        return false;
+    }
+
+    return true;
+}
+
+ScopedTransaction::ScopedTransaction(DatabaseManager* db_manager)
+    : database_manager(db_manager),
+      active(false)
+{
+    if (database_manager) {
+        active = database_manager->BeginTransaction();
+    }
+}
+
+ScopedTransaction::~ScopedTransaction()
+{
+    if (active) {
+        database_manager->RollbackTransaction();
+    }
+}
+
+bool ScopedTransaction::IsActive() const
+{
+    return active;
+}
+
+bool ScopedTransaction::Commit()
+{
+    if (!active) {
+        return false;
+    }
+
+    active = false;
+    if (!database_manager->CommitTransaction()) {
+        database_manager->RollbackTransaction();
+        return false;
+    }
+
+    return true;
+}
+
+ScopedChangeSuppression::ScopedChangeSuppression(DatabaseManager* db_manager)
+    : database_manager(db_manager)
+{
+    if (database_manager) {
+        database_manager->SuppressChanges();
+    }
+}
+
+ScopedChangeSuppression::~ScopedChangeSuppression()
+{
+    if (database_manager) {
+        database_manager->ResumeChanges();
+    }
+}
+
+void DatabaseManager::ApplyProfile()
+{
+    // Values are validated by DatabaseProfile, so they can be inlined
+    QStringList pragmas = {
+        QString("PRAGMA busy_timeout = %1").arg(profile.busy_timeout),
+        QString("PRAGMA synchronous = %1").arg(profile.synchronous),
+        QString("PRAGMA cache_size = %1").arg(profile.cache_size),
+        QString("PRAGMA mmap_size = %1").arg(profile.mmap_size),
+        QString("PRAGMA temp_store = %1").arg(profile.temp_store),
+        QString("PRAGMA foreign_keys = %1").arg(profile.foreign_keys ? "ON" : "OFF"),
+    };
+
+    // The journal mode is stored in the file, only writers can change it
+    if (role == ConnectionRole::Writer) {
+        pragmas.prepend(QString("PRAGMA journal_mode = %1").arg(profile.journal_mode));
+    }
+
+    QSqlQuery query(db);
+    for (const QString& pragma : pragmas) {
+        if (!query.exec(pragma)) {
+            qWarning() << pragma << ":" << query.lastError().text();
+        }
+    }
+
+    // Log what SQLite actually accepted, e.g. WAL is refused on some filesystems
+    qInfo().noquote() << QString("Database profile %1 on %2: journal_mode=%3 synchronous=%4 cache_size=%5 "
+                                 "mmap_size=%6 temp_store=%7 busy_timeout=%8 foreign_keys=%9")
+                             .arg(profile.name,
+                                  connection_name,
+                                  ReadPragma("journal_mode"),
+                                  ReadPragma("synchronous"),
+                                  ReadPragma("cache_size"),
+                                  ReadPragma("mmap_size"),
+                                  ReadPragma("temp_store"),
+                                  ReadPragma("busy_timeout"),
+                                  ReadPragma("foreign_keys"));
+}
+
+QString DatabaseManager::ReadPragma(const QString& pragma)
+{
+    QSqlQuery query(db);
+    if (!query.exec("PRAGMA " + pragma) || !query.next()) {
+        return "?";
+    }
+    return query.value(0).toString();
+}
+
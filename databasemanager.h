@@ -1,11 +1,33 @@
 #ifndef DATABASE_MANAGER_H
 #define DATABASE_MANAGER_H
 
+#include "databaseprofile.h"
+#include "changenotifier.h"
+#include "queryprofiler.h"
+
 #include <QSqlDatabase>
 #include <QSqlError>
 #include <QSqlQuery>
+#include <QHash>
 #include <QDebug>
 
+/**
+ * @brief Role of a database connection.
+ */
+enum class ConnectionRole {
+    Writer, ///< Read-write connection that also migrates the schema
+    Reader ///< Read-only connection
+};
+
+/**
+ * @brief Counters of the DatabaseManager prepared-statement cache.
+ */
+struct StatementCacheStats {
+    quint64 hits; ///< Requests served by an already prepared statement
+    quint64 misses; ///< Requests that had to prepare the statement
+    int size; ///< Number of cached statements
+};
+
 /**
  * @brief 
  * 
@@ -15,8 +37,30 @@ class DatabaseManager
 public:
     /**
      * @brief Constructs a DatabaseManager object and initializes the database connection.
+     *
+     * Qt connections may only be used from the thread that created them, so
+     * each thread working on the database needs its own connection name.
+     *
+     * @param connection_name Name of the Qt SQL connection to register.
      */
-    DatabaseManager();
+    explicit DatabaseManager(const QString& connection_name = QLatin1String(QSqlDatabase::defaultConnection));
+
+    /**
+     * @brief Constructs a DatabaseManager object on the given database file.
+     *
+     * Writer connections bring the schema up to date after opening, and are
+     * closed again if a migration fails. Reader connections are opened
+     * read-only and expect the schema to exist.
+     *
+     * @param connection_name Name of the Qt SQL connection to register.
+     * @param file_path Path of the database file.
+     * @param profile Performance profile to apply to the connection.
+     * @param role Role of the connection.
+     */
+    DatabaseManager(const QString& connection_name,
+                    const QString& file_path,
+                    const DatabaseProfile& profile,
+                    ConnectionRole role);
 
     /**
      * @brief Closes the database connection and cleans up resources.
@@ -29,8 +73,253 @@ public:
      */
     QSqlDatabase& GetDatabase();
 
+    /**
+     * @brief Returns the performance profile the connection was opened with.
+     * @return const DatabaseProfile& The profile.
+     */
+    const DatabaseProfile& GetProfile() const;
+
+    /**
+     * @brief Returns the role the connection was opened with.
+     * @return ConnectionRole The role.
+     */
+    ConnectionRole GetRole() const;
+
+    /**
+     * @brief Returns the path of the application database, creating its directory if needed.
+     * @return QString Path of reading_tracker.db in the AppData location.
+     */
+    static QString DefaultDatabasePath();
+
+    /**
+     * @brief Loads the performance profile from the environment and the settings file next to the application database.
+     * @return DatabaseProfile The effective profile.
+     */
+    static DatabaseProfile LoadDefaultProfile();
+
+    /**
+     * @brief Returns a forward-only statement prepared from the given SQL, reusing it across calls.
+     *
+     * The statement is owned by the cache and reset before it is returned, so
+     * a caller must be done with its results before requesting the same SQL
+     * again. Callers that stop reading before the end of a result should call
+     * finish() so the statement does not keep a read transaction open.
+     *
+     * @param sql The SQL text, which is also the cache key.
+     * @return QSqlQuery* The prepared statement, or nullptr if preparing failed.
+     */
+    QSqlQuery* GetCachedQuery(const QString& sql);
+
+    /**
+     * @brief Returns the hit and miss counters of the statement cache.
+     * @return StatementCacheStats The counters since the connection was opened.
+     */
+    StatementCacheStats GetStatementCacheStats() const;
+
+    /**
+     * @brief Begins a transaction, or a savepoint if a transaction is already open.
+     * @return true on success, false on a database error.
+     */
+    bool BeginTransaction();
+
+    /**
+     * @brief Commits the innermost open transaction or savepoint.
+     * @return true on success, false on a database error.
+     */
+    bool CommitTransaction();
+
+    /**
+     * @brief Rolls back the innermost open transaction or savepoint.
+     * @return true on success, false on a database error.
+     */
+    bool RollbackTransaction();
+
+    /**
+     * @brief Returns the number of nested transactions currently open.
+     * @return int 0 when no transaction is open.
+     */
+    int GetTransactionDepth() const;
+
+    /**
+     * @brief Returns how many rollbacks happened on this connection.
+     *
+     * Caches of rows written inside a transaction compare this counter to
+     * detect that their contents may have been rolled back.
+     *
+     * @return quint64 Number of rollbacks since the connection was opened.
+     */
+    quint64 GetRollbackCount() const;
+
+    /**
+     * @brief Sets the notifier committed change events are delivered to.
+     * @param notifier The notifier, or nullptr to drop events. Must outlive the connection.
+     */
+    void SetChangeNotifier(ChangeNotifier* notifier);
+
+    /**
+     * @brief Publishes a change made on this connection.
+     *
+     * Inside a transaction the event is held back until the outermost commit
+     * and dropped if the savepoint it was published in is rolled back.
+     *
+     * @param event The change event.
+     */
+    void PublishChange(const ChangeEvent& event);
+
+    /**
+     * @brief Starts dropping row-level change events, see ScopedChangeSuppression.
+     *
+     * Bulk writers publish one Reset at the end instead, which is still
+     * delivered. Calls nest.
+     */
+    void SuppressChanges();
+
+    /**
+     * @brief Ends a SuppressChanges() call.
+     */
+    void ResumeChanges();
+
+    /**
+     * @brief Rebuilds the database file to reclaim free pages, then refreshes the query planner statistics.
+     *
+     * VACUUM cannot run inside a transaction and needs free disk space
+     * about the size of the database.
+     *
+     * @return true on success, false on a database error.
+     */
+    bool Vacuum();
+
+    /**
+     * @brief Sets the profiler statements executed through Exec() are recorded in.
+     * @param profiler The profiler, or nullptr to stop recording. Must outlive the connection.
+     */
+    void SetQueryProfiler(QueryProfiler* profiler);
+
+    /**
+     * @brief Executes a prepared statement, recording its latency in the query profiler.
+     *
+     * Statements at or above the profile's slow_query_ms are written to the
+     * slow-query log with their bound values and query plan.
+     *
+     * @param query The prepared statement.
+     * @return true on success, false on a database error, see query->lastError().
+     */
+    bool Exec(QSqlQuery* query);
+
+    /**
+     * @brief Executes SQL text on a query, recording its latency in the query profiler.
+     *
+     * @param query The query to execute on.
+     * @param sql The SQL text.
+     * @return true on success, false on a database error, see query.lastError().
+     */
+    bool Exec(QSqlQuery& query, const QString& sql);
+
+    /**
+     * @brief Adds the rows a caller read from a statement to its profile.
+     *
+     * Executing a read only steps to its first row, so the rows it returns
+     * are known once the caller has read them.
+     *
+     * @param query The statement.
+     * @param rows Rows read.
+     */
+    void RecordRows(const QSqlQuery& query, qint64 rows);
+
 private:
+    QString connection_name; ///< Name of the Qt SQL connection
     QSqlDatabase db; ///< The database connection object
+    DatabaseProfile profile; ///< The performance profile applied to the connection
+    ConnectionRole role; ///< The role of the connection
+    int transaction_depth; ///< Number of nested transactions currently open
+    quint64 rollback_count; ///< Number of rollbacks since the connection was opened
+    QHash<QString, QSqlQuery*> statement_cache; ///< Prepared statements keyed by SQL text
+    quint64 statement_cache_hits; ///< Statement cache hits
+    quint64 statement_cache_misses; ///< Statement cache misses
+    ChangeNotifier* change_notifier; ///< Receives committed change events, may be nullptr
+    QList<ChangeEvent> pending_changes; ///< Events published inside the open transaction
+    QList<int> pending_change_marks; ///< Size of pending_changes when each open savepoint began
+    int change_suppression_depth; ///< Number of open SuppressChanges() calls, row-level events are dropped while positive
+    QueryProfiler* query_profiler; ///< Records statement statistics, may be nullptr
+
+    bool ExecTransactionStatement(const QString& sql); ///< Executes a transaction control statement
+
+    void ApplyProfile(); ///< Applies the profile pragmas to the open connection and logs the effective values
+
+    QString ReadPragma(const QString& pragma); ///< Reads the current value of a pragma
+
+    void ProfileExec(QSqlQuery& query, qint64 elapsed_ns, bool ok); ///< Records an execution and logs it if slow
+
+    QStringList ExplainQueryPlan(const QSqlQuery& query); ///< Reads the query plan of a statement with its bound values
+};
+
+/**
+ * @brief Scoped transaction on a DatabaseManager.
+ *
+ * Begins a transaction on construction and rolls it back on destruction
+ * unless Commit() was called. Scopes can be nested; inner scopes use
+ * savepoints, so only the outermost commit reaches the disk.
+ */
+class ScopedTransaction
+{
+public:
+    /**
+     * @brief Begins a transaction on the given database manager.
+     * @param db_manager Pointer to the DatabaseManager instance.
+     */
+    explicit ScopedTransaction(DatabaseManager* db_manager);
+
+    /**
+     * @brief Rolls the transaction back if it was not committed.
+     */
+    ~ScopedTransaction();
+
+    ScopedTransaction(const ScopedTransaction&) = delete;
+    ScopedTransaction& operator=(const ScopedTransaction&) = delete;
+
+    /**
+     * @brief Returns whether the transaction was begun and is still open.
+     * @return true if the transaction is open.
+     */
+    bool IsActive() const;
+
+    /**
+     * @brief Commits the transaction.
+     * @return true on success, false if it was not open or the commit failed.
+     */
+    bool Commit();
+
+private:
+    DatabaseManager* database_manager; ///< Pointer to the DatabaseManager instance
+    bool active; ///< Whether the transaction is open
+};
+
+/**
+ * @class ScopedChangeSuppression
+ * @brief RAII helper dropping row-level change events while it is alive.
+ *
+ * Used by bulk writers such as the importers, whose final Reset makes the
+ * per-row events redundant.
+ */
+class ScopedChangeSuppression
+{
+public:
+    /**
+     * @brief Starts suppressing the row-level events of a connection.
+     * @param db_manager Pointer to the DatabaseManager instance.
+     */
+    explicit ScopedChangeSuppression(DatabaseManager* db_manager);
+
+    /**
+     * @brief Delivers row-level events again.
+     */
+    ~ScopedChangeSuppression();
+
+    ScopedChangeSuppression(const ScopedChangeSuppression&) = delete;
+    ScopedChangeSuppression& operator=(const ScopedChangeSuppression&) = delete;
+
+private:
+    DatabaseManager* database_manager; ///< Pointer to the DatabaseManager instance
 };
 
 #endif // DATABASE_MANAGER_H
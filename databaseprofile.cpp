@@ -0,0 +1,118 @@
+#include "databaseprofile.h"
+
+#include <QSettings>
+#include <QDebug>
+
+namespace {
+
+// Settings are inlined into PRAGMA statements, so only known keywords are accepted
+const QStringList kJournalModes = {"DELETE", "TRUNCATE", "PERSIST", "MEMORY", "WAL", "OFF"};
+const QStringList kSynchronousModes = {"OFF", "NORMAL", "FULL", "EXTRA"};
+const QStringList kTempStores = {"DEFAULT", "FILE", "MEMORY"};
+
+QString Setting(const QSettings* settings, const QString& key)
+{
+    QByteArray env = qgetenv(("READING_TRACKER_DB_" + key.toUpper()).toLatin1());
+    if (!env.isEmpty()) {
+        return QString::fromLocal8Bit(env).trimmed();
+    }
+    if (settings) {
+        return settings->value("database/" + key).toString().trimmed();
+    }
+    return {};
+}
+
+void OverrideKeyword(const QSettings* settings, const QString& key, const QStringList& allowed, QString& value)
+{
+    QString setting = Setting(settings, key).toUpper();
+    if (setting.isEmpty()) {
+        return;
+    }
+    if (!allowed.contains(setting)) {
+        qWarning() << "Ignoring invalid database setting" << key << "=" << setting;
+        return;
+    }
+    value = setting;
+}
+
+template <typename T>
+void OverrideNumber(const QSettings* settings, const QString& key, T& value)
+{
+    QString setting = Setting(settings, key);
+    if (setting.isEmpty()) {
+        return;
+    }
+    bool ok = false;
+    qlonglong number = setting.toLongLong(&ok);
+    if (!ok) {
+        qWarning() << "Ignoring invalid database setting" << key << "=" << setting;
+        return;
+    }
+    value = static_cast<T>(number);
+}
+
+void OverrideBool(const QSettings* settings, const QString& key, bool& value)
+{
+    QString setting = Setting(settings, key).toLower();
+    if (setting.isEmpty()) {
+        return;
+    }
+    if (setting == "1" || setting == "on" || setting == "true") {
+        value = true;
+    }
+    else if (setting == "0" || setting == "off" || setting == "false") {
+        value = false;
+    }
+    else {
+        qWarning() << "Ignoring invalid database setting" << key << "=" << setting;
+    }
+}
+
+} // namespace
+
+DatabaseProfile DatabaseProfile::Named(const QString& profile_name, bool* ok)
+{
+    QString name = profile_name.trimmed().toLower();
+    if (ok) {
+        *ok = true;
+    }
+
+    // Foreign keys stay off: RItem references an Issue table that does not exist yet,
+    // so enforcing them would reject every item insert
+    if (name == "safe") {
+        return {"safe", "DELETE", "FULL", -2000, 0, "DEFAULT", 5000, false, 100};
+    }
+    if (name == "bulk") {
+        return {"bulk", "WAL", "OFF", -262144, 1073741824, "MEMORY", 10000, false, 1000};
+    }
+    if (name != "balanced" && ok) {
+        *ok = false;
+    }
+    return {"balanced", "WAL", "NORMAL", -65536, 268435456, "MEMORY", 5000, false, 100};
+}
+
+DatabaseProfile DatabaseProfile::Load(const QSettings* settings)
+{
+    QString name = Setting(settings, "profile");
+    bool ok = true;
+    DatabaseProfile profile = Named(name.isEmpty() ? "balanced" : name, &ok);
+    if (!ok) {
+        qWarning() << "Unknown database profile" << name << ", using" << profile.name;
+    }
+
+    OverrideKeyword(settings, "journal_mode", kJournalModes, profile.journal_mode);
+    OverrideKeyword(settings, "synchronous", kSynchronousModes, profile.synchronous);
+    OverrideNumber(settings, "cache_size", profile.cache_size);
+    OverrideNumber(settings, "mmap_size", profile.mmap_size);
+    OverrideKeyword(settings, "temp_store", kTempStores, profile.temp_store);
+    OverrideNumber(settings, "busy_timeout", profile.busy_timeout);
+    OverrideBool(settings, "foreign_keys", profile.foreign_keys);
+    OverrideNumber(settings, "slow_query_ms", profile.slow_query_ms);
+
+    return profile;
+}
+
+QStringList DatabaseProfile::Names()
+{
+    return {"safe", "balanced", "bulk"};
+}
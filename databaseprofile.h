@@ -0,0 +1,61 @@
+#ifndef DATABASE_PROFILE_H
+#define DATABASE_PROFILE_H
+
+#include <QString>
+#include <QStringList>
+
+class QSettings;
+
+/**
+ * @file databaseprofile.h
+ * @brief Header file for DatabaseProfile struct.
+ *
+ * A profile is a named set of SQLite connection settings applied when a
+ * connection is opened. The profile is picked by name from the
+ * READING_TRACKER_DB_PROFILE environment variable or the "database/profile"
+ * settings key, and single settings can be overridden the same way,
+ * e.g. READING_TRACKER_DB_CACHE_SIZE or "database/cache_size".
+ */
+
+struct DatabaseProfile {
+    QString name; ///< Name of the profile
+    QString journal_mode; ///< PRAGMA journal_mode, e.g. WAL or DELETE
+    QString synchronous; ///< PRAGMA synchronous, e.g. NORMAL or FULL
+    int cache_size; ///< PRAGMA cache_size, negative values are in KiB
+    qint64 mmap_size; ///< PRAGMA mmap_size in bytes, 0 disables memory mapping
+    QString temp_store; ///< PRAGMA temp_store, e.g. MEMORY or DEFAULT
+    int busy_timeout; ///< PRAGMA busy_timeout in milliseconds
+    bool foreign_keys; ///< PRAGMA foreign_keys, off in every built-in profile
+    int slow_query_ms; ///< Statements running at least this long are logged as slow, negative disables the log
+
+    /**
+     * @brief Get a built-in profile by name.
+     *
+     * "safe" keeps SQLite's durable defaults, "balanced" uses WAL with a large
+     * cache and memory mapping, and "bulk" trades durability for import speed.
+     *
+     * @param profile_name Name of the profile, case-insensitive.
+     * @param ok Set to false if the name is unknown, in which case "balanced" is returned.
+     * @return DatabaseProfile The profile.
+     */
+    static DatabaseProfile Named(const QString& profile_name, bool* ok = nullptr);
+
+    /**
+     * @brief Resolve the profile from the environment and the given settings.
+     *
+     * Environment variables take precedence over settings keys.
+     *
+     * @param settings Settings to read the "database/..." keys from, may be nullptr.
+     * @return DatabaseProfile The effective profile.
+     */
+    static DatabaseProfile Load(const QSettings* settings);
+
+    /**
+     * @brief Get the names of the built-in profiles.
+     *
+     * @return QStringList The profile names.
+     */
+    static QStringList Names();
+};
+
+#endif // DATABASE_PROFILE_H
@@ -0,0 +1,91 @@
+#include "editionfilter.h"
+#include "editiontablemodel.h"
+
+EditionFilter::EditionFilter(EditionTableModel* model, QObject* parent)
+    : QObject(parent),
+      model(model),
+      index_stale(false),
+      index_loading(false)
+{
+    debounce_timer.setSingleShot(true);
+    debounce_timer.setInterval(kDebounceMs);
+    connect(&debounce_timer, &QTimer::timeout, this, &EditionFilter::Run);
+    connect(&watcher, &QFutureWatcher<QVector<int>>::resultsReadyAt, this, &EditionFilter::ShowResults);
+}
+
+EditionFilter::~EditionFilter()
+{
+    watcher.cancel();
+    watcher.waitForFinished();
+}
+
+bool EditionFilter::IsActive() const
+{
+    return !EditionSearchIndex::Terms(query).isEmpty();
+}
+
+void EditionFilter::SetQuery(const QString& new_query)
+{
+    query = new_query;
+    debounce_timer.start();
+}
+
+void EditionFilter::SetCatalogue(QSharedPointer<const CatalogueSnapshot> new_catalogue)
+{
+    catalogue = new_catalogue;
+    index_stale = true;
+    if (IsActive()) {
+        debounce_timer.start();
+    }
+}
+
+void EditionFilter::Run()
+{
+    // Results of the previous pass still in flight are ignored from here on
+    watcher.cancel();
+
+    if (!IsActive()) {
+        if (filtered_index) {
+            filtered_index.reset();
+            model->Reload();
+        }
+        return;
+    }
+
+    if (!index || index_stale) {
+        if (!catalogue) {
+            return; // Filtered once the first snapshot arrives
+        }
+        if (!index_loading) {
+            index_loading = true;
+            index_stale = false; // A new snapshot during the build marks it stale again
+            EditionSearchIndex::BuildAsync(catalogue).then(this, [this](QSharedPointer<const EditionSearchIndex> loaded) {
+                index_loading = false;
+                index = loaded;
+                Run();
+            });
+        }
+        return;
+    }
+
+    filtered_index = index;
+    model->ShowFiltered();
+    watcher.setFuture(EditionSearchIndex::FilterAsync(filtered_index, query));
+}
+
+void EditionFilter::ShowResults(int begin, int end)
+{
+    if (watcher.isCanceled()) {
+        return;
+    }
+
+    QList<EditionListRow> rows;
+    for (int i = begin; i < end; ++i) {
+        const QVector<int> positions = watcher.resultAt(i);
+        for (int position : positions) {
+            rows.append(filtered_index->GetRow(position));
+        }
+    }
+
+    model->AppendFiltered(rows);
+}
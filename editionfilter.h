@@ -0,0 +1,84 @@
+#ifndef EDITION_FILTER_H
+#define EDITION_FILTER_H
+
+#include "editionsearchindex.h"
+
+#include <QObject>
+#include <QTimer>
+#include <QFutureWatcher>
+
+class EditionTableModel;
+
+/**
+ * @file editionfilter.h
+ * @brief Header file for EditionFilter class.
+ *
+ * EditionFilter connects the edition filter line edit to the editions table.
+ * Queries are debounced, run on the thread pool against an
+ * EditionSearchIndex of the current CatalogueSnapshot, cancelled when the query changes, and their matches
+ * are appended to the table chunk by chunk while the scan goes on.
+ */
+
+/**
+ * @class EditionFilter
+ * @brief Live, off-thread filter of the editions table.
+ */
+class EditionFilter : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int kDebounceMs = 150; ///< Quiet time after the last keystroke before filtering
+
+    /**
+     * @brief Constructs an inactive filter.
+     * 
+     * @param model The editions model to show the matches in, must outlive the filter.
+     * @param parent Parent QObject.
+     */
+    explicit EditionFilter(EditionTableModel* model, QObject* parent = nullptr);
+
+    /**
+     * @brief Cancels a running filter pass.
+     */
+    ~EditionFilter();
+
+    /**
+     * @brief Returns whether the current query filters the editions.
+     * 
+     * @return true if the query has at least one term.
+     */
+    bool IsActive() const;
+
+public slots:
+    /**
+     * @brief Sets the filter query, applied once typing pauses.
+     * 
+     * @param query The text typed into the filter.
+     */
+    void SetQuery(const QString& query);
+
+    /**
+     * @brief Sets the snapshot to filter, marking the index outdated and filtering again if active.
+     * 
+     * @param catalogue The current snapshot.
+     */
+    void SetCatalogue(QSharedPointer<const CatalogueSnapshot> catalogue);
+
+private:
+    EditionTableModel* model; ///< Model the matches are shown in
+    QTimer debounce_timer; ///< Delays filtering until typing pauses
+    QString query; ///< Current query
+    QSharedPointer<const CatalogueSnapshot> catalogue; ///< Snapshot the index is built from
+    QSharedPointer<const EditionSearchIndex> index; ///< Index of the edition rows, may be outdated
+    QSharedPointer<const EditionSearchIndex> filtered_index; ///< Index of the running filter pass
+    bool index_stale; ///< Whether the snapshot changed since the index was built
+    bool index_loading; ///< Whether an index build is in flight
+    QFutureWatcher<QVector<int>> watcher; ///< Watches the running filter pass
+
+    void Run(); ///< Applies the current query, building the index first if needed
+
+    void ShowResults(int begin, int end); ///< Appends the reported matches to the model
+};
+
+#endif // EDITION_FILTER_H
@@ -1,4 +1,6 @@
 #include "editionmanager.h"
+#include "databaseexecutor.h"
+#include "tracer.h"
 
 EditionManager::EditionManager(DatabaseManager* db_manager,
                                IdNameTableManager* publisher_manager,
@@ -15,9 +17,6 @@ EditionManager::EditionManager(DatabaseManager* db_manager,
         qCritical() << "Database connection is not valid or open.";
         return; // Database error
     }
-
-    // Initialize edition-related tables
-    CreateEditionTable();
 }
 
 EditionManager::~EditionManager()
@@ -27,6 +26,8 @@ EditionManager::~EditionManager()
 
 int EditionManager::InsertEdition(const EditionData& edition_data)
 {
+    RT_TRACE_SCOPE("db", "EditionManager::InsertEdition");
+
     // Ensure the database connection is valid
     if (!database_manager || !database_manager->GetDatabase().isOpen()) {
         qCritical() << "Database connection is not valid or open.";
@@ -38,192 +39,247 @@ int EditionManager::InsertEdition(const EditionData& edition_data)
         return -1; // Invalid input
     }
 
-    QSqlDatabase db = database_manager->GetDatabase();
-    QSqlQuery query(db);
+    // The edition and its lookup rows are written atomically
+    ScopedTransaction transaction(database_manager);
+    if (!transaction.IsActive()) {
+        qCritical() << "InsertEdition: failed to begin transaction";
+        return -1; // Database error
+    }
+
+    QSqlQuery* query = database_manager->GetCachedQuery("INSERT INTO Edition (book_id, publisher_id, language_id, series_id, page_count, publication_date, isbn, type, cover_image_path) "
+                                                        "VALUES (:book_id, :publisher_id, :language_id, :series_id, :page_count, :publication_date, :isbn, :type, :cover_image_path)");
+    if (!query) {
+        return -1; // Database error
+    }
 
-    query.prepare("INSERT INTO Edition (book_id, publisher_id, language_id, series_id, page_count, publication_date, isbn, type, cover_image_path) "
-                  "VALUES (:book_id, :publisher_id, :language_id, :series_id, :page_count, :publication_date, :isbn, :type, :cover_image_path)");
-    
-    query.bindValue(":book_id", edition_data.book_id);
+    query->bindValue(":book_id", edition_data.book_id);
 
-    int publisher_id = publisher_manager->GetIdByName(edition_data.publisher);
+    int publisher_id = publisher_manager->InsertIfNotExists(edition_data.publisher);
     if (publisher_id == -1) {
-        publisher_id = publisher_manager->Insert(edition_data.publisher);
-        if (publisher_id == -1) {
-            qCritical() << "Failed to insert publisher:" << edition_data.publisher;
-            return -1; // Insertion failed
-        }
+        qCritical() << "Failed to insert publisher:" << edition_data.publisher;
+        return -1; // Insertion failed
     }
-    query.bindValue(":publisher_id", publisher_id);
+    query->bindValue(":publisher_id", publisher_id);
 
     // Handle language_id
     int language_id = -1;
     if (!edition_data.language.trimmed().isEmpty()) {
-        language_id = language_manager->GetIdByName(edition_data.language);
+        language_id = language_manager->InsertIfNotExists(edition_data.language);
         if (language_id == -1) {
-            language_id = language_manager->Insert(edition_data.language);
-            if (language_id == -1) {
-                qCritical() << "Failed to insert language:" << edition_data.language;
-                return -1; // Insertion failed
-            }
+            qCritical() << "Failed to insert language:" << edition_data.language;
+            return -1; // Insertion failed
         }
-        query.bindValue(":language_id", language_id);
+        query->bindValue(":language_id", language_id);
     }
     else {
-        query.bindValue(":language_id", QVariant(QVariant::Int)); // Will be NULL in SQL
+        query->bindValue(":language_id", QVariant(QVariant::Int)); // Will be NULL in SQL
     }
 
     // Handle series_id
     int series_id = -1;
     if (!edition_data.series.trimmed().isEmpty()) {
-        series_id = series_manager->GetIdByName(edition_data.series);
+        series_id = series_manager->InsertIfNotExists(edition_data.series);
         if (series_id == -1) {
-            series_id = series_manager->Insert(edition_data.series);
-            if (series_id == -1) {
-                qCritical() << "Failed to insert series:" << edition_data.series;
-                return -1; // Insertion failed
-            }
+            qCritical() << "Failed to insert series:" << edition_data.series;
+            return -1; // Insertion failed
         }
-        query.bindValue(":series_id", series_id);
+        query->bindValue(":series_id", series_id);
     }
     else {
-        query.bindValue(":series_id", QVariant(QVariant::Int)); // Will be NULL in SQL
+        query->bindValue(":series_id", QVariant(QVariant::Int)); // Will be NULL in SQL
     }
 
     if(edition_data.page_count <= 0) {
-        query.bindValue(":page_count", QVariant(QVariant::Int)); // Will be NULL in SQL
+        query->bindValue(":page_count", QVariant(QVariant::Int)); // Will be NULL in SQL
     }
     else {
-        query.bindValue(":page_count", edition_data.page_count);
+        query->bindValue(":page_count", edition_data.page_count);
+    }
+    query->bindValue(":publication_date", edition_data.publication_date);
+    query->bindValue(":isbn", edition_data.isbn);
+    query->bindValue(":type", edition_data.type);
+    query->bindValue(":cover_image_path", edition_data.cover_image_path);
+
+    if (!database_manager->Exec(query)) {
+        qCritical() << "InsertEdition:" << query->lastError().text();
+        return -1; // Insertion failed
     }
-    query.bindValue(":publication_date", edition_data.publication_date);
-    query.bindValue(":isbn", edition_data.isbn);
-    query.bindValue(":type", edition_data.type);
-    query.bindValue(":cover_image_path", edition_data.cover_image_path);
 
-    if (!query.exec()) {
-        qCritical() << "InsertEdition:" << query.lastError().text();
+    int edition_id = query->lastInsertId().toInt();
+    database_manager->PublishChange(ChangeEvent{ChangeType::EditionInserted, edition_id, QString()});
+
+    if (!transaction.Commit()) {
+        qCritical() << "InsertEdition: failed to commit transaction";
         return -1; // Insertion failed
     }
 
-    return query.lastInsertId().toInt(); // Return the ID of the inserted edition
+    return edition_id; // Return the ID of the inserted edition
 }
 
 QStringList EditionManager::GetAuthorsForEdition(int edition_id) const
 {
+    RT_TRACE_SCOPE("db", "EditionManager::GetAuthorsForEdition");
+
     if (!database_manager || !database_manager->GetDatabase().isOpen()) {
         qCritical() << "Database connection is not valid or open.";
         return QStringList(); // Return empty list on error
     }
 
-    QSqlDatabase db = database_manager->GetDatabase();
-    QSqlQuery query(db);
+    QSqlQuery* query = database_manager->GetCachedQuery("SELECT Author.name FROM Book2Author "
+                                                        "JOIN Book ON Book2Author.book_id = Book.id "
+                                                        "JOIN Edition ON Book.id = Edition.book_id "
+                                                        "JOIN Author ON Book2Author.author_id = Author.id "
+                                                        "WHERE Edition.id = :edition_id");
+    if (!query) {
+        return QStringList(); // Return empty list on error
+    }
 
-    query.prepare("SELECT Author.name FROM Book2Author "
-                  "JOIN Book ON Book2Author.book_id = Book.id "
-                  "JOIN Edition ON Book.id = Edition.book_id "
-                  "JOIN Author ON Book2Author.author_id = Author.id "
-                  "WHERE Edition.id = :edition_id");
-    query.bindValue(":edition_id", edition_id);
+    query->bindValue(":edition_id", edition_id);
 
-    if (!query.exec()) {
-        qCritical() << "GetAuthorsForEdition:" << query.lastError().text();
+    if (!database_manager->Exec(query)) {
+        qCritical() << "GetAuthorsForEdition:" << query->lastError().text();
         return QStringList(); // Return empty list on error
     }
 
     QStringList authors;
-    while (query.next()) {
-        authors.append(query.value(0).toString());
+    qint64 row_count = 0;
+    while (query->next()) {
+        row_count++;
+        authors.append(query->value(0).toString());
     }
 
+    database_manager->RecordRows(*query, row_count);
+
     return authors;
 }
 
 QMap<int, QString> EditionManager::GetAllEditions() const
 {
+    RT_TRACE_SCOPE("db", "EditionManager::GetAllEditions");
+
     QMap<int, QString> editions;
 
+    const QList<EditionListRow> rows = ListEditions();
+    for (const EditionListRow& row : rows) {
+        editions.insert(row.edition_id, EditionLabel(row));
+    }
+
+    return editions;
+}
+
+QList<EditionListRow> EditionManager::ListEditions() const
+{
+    return SelectEditions("Edition", EditionSortKey::Id, PageCursor(), -1);
+}
+
+QFuture<QList<EditionListRow>> EditionManager::ListEditionsAsync(DatabaseExecutor* executor)
+{
+    return executor->Run([](Library& library) {
+        return library.edition_manager->ListEditions();
+    });
+}
+
+QList<EditionListRow> EditionManager::ListEditionsPage(EditionSortKey sort_key, const PageCursor& after, int limit) const
+{
+    if (limit <= 0) {
+        qWarning() << "ListEditionsPage failed: limit must be greater than 0";
+        return QList<EditionListRow>();
+    }
+
+    // Limit the editions before joining the authors so a page never splits an edition
+    if (sort_key == EditionSortKey::Title) {
+        return SelectEditions("(SELECT Edition.* FROM Edition JOIN Book ON Book.id = Edition.book_id "
+                              "WHERE " + PageSeekSql("Book.title", "Edition.id") + " "
+                              "ORDER BY Book.title, Edition.id LIMIT :limit)",
+                              sort_key, after, limit);
+    }
+    return SelectEditions("(SELECT * FROM Edition WHERE " + PageSeekSql("", "id") + " ORDER BY id LIMIT :limit)",
+                          sort_key, after, limit);
+}
+
+QFuture<QList<EditionListRow>> EditionManager::ListEditionsPageAsync(DatabaseExecutor* executor, EditionSortKey sort_key, const PageCursor& after, int limit)
+{
+    return executor->Run([sort_key, after, limit](Library& library) {
+        return library.edition_manager->ListEditionsPage(sort_key, after, limit);
+    });
+}
+
+PageCursor EditionManager::CursorAfter(const EditionListRow& edition, EditionSortKey sort_key)
+{
+    return PageCursor{sort_key == EditionSortKey::Title ? QVariant(edition.title) : QVariant(), edition.edition_id};
+}
+
+QList<EditionListRow> EditionManager::SelectEditions(const QString& source, EditionSortKey sort_key, const PageCursor& after, int limit) const
+{
+    RT_TRACE_SCOPE("db", "EditionManager::SelectEditions");
+
+    QList<EditionListRow> editions;
+
     if (!database_manager || !database_manager->GetDatabase().isOpen()) {
         qCritical() << "Database connection is not valid or open.";
         return editions;
     }
 
-    QSqlDatabase db = database_manager->GetDatabase();
-    QSqlQuery query(db);
+    // One row per (edition, author) pair, grouped by edition through the ordering
+    QSqlQuery* query = database_manager->GetCachedQuery("SELECT E.id, E.book_id, Book.title, Publisher.name, "
+                                                        "Language.name, Series.name, E.page_count, E.isbn, Author.name "
+                                                        "FROM " + source + " AS E "
+                                                        "LEFT JOIN Book ON Book.id = E.book_id "
+                                                        "LEFT JOIN Publisher ON Publisher.id = E.publisher_id "
+                                                        "LEFT JOIN Language ON Language.id = E.language_id "
+                                                        "LEFT JOIN Series ON Series.id = E.series_id "
+                                                        "LEFT JOIN Book2Author ON Book2Author.book_id = E.book_id "
+                                                        "LEFT JOIN Author ON Author.id = Book2Author.author_id "
+                                                        "ORDER BY " + (sort_key == EditionSortKey::Title ? "Book.title, " : "") +
+                                                        "E.id, Author.name");
+    if (!query) {
+        return editions;
+    }
+
+    if (limit > 0) {
+        BindPageCursor(query, after, sort_key == EditionSortKey::Title);
+        query->bindValue(":limit", limit);
+    }
 
-    // Get all editions with their IDs, book_id, and publisher_id
-    if (!query.exec("SELECT Edition.id, Edition.book_id, Publisher.name "
-                    "FROM Edition "
-                    "LEFT JOIN Publisher ON Edition.publisher_id = Publisher.id")) {
-        qCritical() << "GetAllEditions:" << query.lastError().text();
+    if (!database_manager->Exec(query)) {
+        qCritical() << "ListEditions:" << query->lastError().text();
         return editions;
     }
 
-    while (query.next()) {
-        int edition_id = query.value(0).toInt();
-        int book_id = query.value(1).toInt();
-        QString publisher = query.value(2).toString();
-
-        // Get book title and authors using BookManager
-        QString label;
-        if (book_manager) {
-            // Get title
-            QSqlQuery bookQuery(db);
-            bookQuery.prepare("SELECT title FROM Book WHERE id = :book_id");
-            bookQuery.bindValue(":book_id", book_id);
-            QString title;
-            if (bookQuery.exec() && bookQuery.next()) {
-                title = bookQuery.value(0).toString();
-            }
-
-            // Get authors
-            QStringList authors = book_manager->GetAuthorsForBook(book_id);
-
-            label = title;
-            if (!publisher.isEmpty()) {
-                label += " - " + publisher;
-            }
-            if (!authors.isEmpty()) {
-                label += " - " + authors.join(", ");
-            }
+    qint64 row_count = 0;
+    while (query->next()) {
+        row_count++;
+        int edition_id = query->value(0).toInt();
+        if (editions.isEmpty() || editions.last().edition_id != edition_id) {
+            EditionListRow row;
+            row.edition_id = edition_id;
+            row.book_id = query->value(1).toInt();
+            row.title = query->value(2).toString();
+            row.publisher = query->value(3).toString();
+            row.language = query->value(4).toString();
+            row.series = query->value(5).toString();
+            row.page_count = query->value(6).toInt(); // NULL reads as 0
+            row.isbn = query->value(7).toString();
+            editions.append(row);
         }
-        else {
-            label = QString("BookID %1").arg(book_id);
-            if (!publisher.isEmpty()) {
-                label += " - " + publisher;
-            }
+        if (!query->value(8).isNull()) {
+            editions.last().authors.append(query->value(8).toString());
         }
-
-        editions.insert(edition_id, label);
     }
 
+    database_manager->RecordRows(*query, row_count);
+
     return editions;
 }
 
-void EditionManager::CreateEditionTable()
+QString EditionManager::EditionLabel(const EditionListRow& edition)
 {
-    // Ensure the database connection is valid
-    if (!database_manager || !database_manager->GetDatabase().isOpen()) {
-        qCritical() << "Database connection is not valid or open.";
-        return; // Database error
+    QString label = edition.title;
+    if (!edition.publisher.isEmpty()) {
+        label += " - " + edition.publisher;
     }
-
-    QSqlDatabase db = database_manager->GetDatabase();
-    QSqlQuery query(db);
-
-    query.exec("CREATE TABLE IF NOT EXISTS Edition ("
-               "id INTEGER PRIMARY KEY AUTOINCREMENT, "
-               "book_id INTEGER NOT NULL, "
-               "publisher_id INTEGER NOT NULL, "
-               "language_id INTEGER, "
-               "series_id INTEGER, "
-               "page_count INTEGER, "
-               "publication_date TEXT, "
-               "isbn TEXT, "
-               "type TEXT, "
-               "cover_image_path TEXT, "
-               "FOREIGN KEY(book_id) REFERENCES Book(id), "
-               "FOREIGN KEY(publisher_id) REFERENCES Publisher(id), "
-               "FOREIGN KEY(language_id) REFERENCES Language(id), "
-               "FOREIGN KEY(series_id) REFERENCES Series(id))");
-}
\ No newline at end of file
+    if (!edition.authors.isEmpty()) {
+        label += " - " + edition.authors.join(", ");
+    }
+    return label;
+}
@@ -15,6 +15,26 @@ struct EditionData {
     QString cover_image_path; ///< Path to the cover image of the edition
 };
 
+struct EditionListRow {
+    int edition_id; ///< ID of the edition
+    int book_id; ///< ID of the book this edition belongs to
+    QString title; ///< Title of the book
+    QString publisher; ///< Publisher of the edition
+    QString language; ///< Language of the edition, empty if not set
+    QString series; ///< Series of the edition, empty if not set
+    int page_count; ///< Number of pages, 0 if not set
+    QString isbn; ///< ISBN of the edition, empty if not set
+    QStringList authors; ///< Authors of the book, ordered by name
+};
+
+/**
+ * @brief Orders of the edition pages, see EditionManager::ListEditionsPage().
+ */
+enum class EditionSortKey {
+    Id, ///< By edition ID, the order editions were added in
+    Title ///< By book title, then edition ID
+};
+
 class EditionManager
 {
 public:
@@ -53,6 +73,62 @@ public:
      */
     QMap<int, QString> GetAllEditions() const;
 
+    /**
+     * @brief Lists all editions with their book, publisher, language, series and authors in a single query.
+     * 
+     * @return QList<EditionListRow> The editions ordered by ID.
+     */
+    QList<EditionListRow> ListEditions() const;
+
+    /**
+     * @brief Lists all editions on the database worker thread, see ListEditions().
+     * 
+     * @param executor The executor to run the query on.
+     * @return QFuture<QList<EditionListRow>> The editions ordered by ID.
+     */
+    static QFuture<QList<EditionListRow>> ListEditionsAsync(DatabaseExecutor* executor);
+
+    /**
+     * @brief Lists one page of editions, seeking to the page through an index, for lazily filled views.
+     *
+     * Editions of books sharing a title are sorted by ID after the seek, the
+     * only part of a page whose cost depends on the data.
+     * 
+     * @param sort_key Order of the editions.
+     * @param after Cursor after the last edition of the previous page, default constructed for the first page.
+     * @param limit Maximum number of editions in the page.
+     * @return QList<EditionListRow> The editions, fewer than limit on the last page.
+     */
+    QList<EditionListRow> ListEditionsPage(EditionSortKey sort_key, const PageCursor& after, int limit) const;
+
+    /**
+     * @brief Lists one page of editions on the database worker thread, see ListEditionsPage().
+     * 
+     * @param executor The executor to run the query on.
+     * @param sort_key Order of the editions.
+     * @param after Cursor after the last edition of the previous page.
+     * @param limit Maximum number of editions in the page.
+     * @return QFuture<QList<EditionListRow>> The editions.
+     */
+    static QFuture<QList<EditionListRow>> ListEditionsPageAsync(DatabaseExecutor* executor, EditionSortKey sort_key, const PageCursor& after, int limit);
+
+    /**
+     * @brief Builds the cursor of the page following an edition.
+     * 
+     * @param edition The last edition of a page.
+     * @param sort_key Order the page was listed in.
+     * @return PageCursor The cursor of the next page.
+     */
+    static PageCursor CursorAfter(const EditionListRow& edition, EditionSortKey sort_key);
+
+    /**
+     * @brief Builds the display label of an edition: "Title - Publisher - Author1, Author2".
+     * 
+     * @param edition The edition row to build the label for.
+     * @return QString The display label.
+     */
+    static QString EditionLabel(const EditionListRow& edition);
+
     /**
      * @brief Get the Authors For Edition
      * 
@@ -68,7 +144,8 @@ private:
     IdNameTableManager* series_manager; ///< Pointer to the IdNameTableManager instance for series.
     BookManager* book_manager; ///< Pointer to the BookManager instance.
 
-    void CreateEditionTable(); ///< Creates the edition table in the database.
+    /// Lists the editions of a table or subquery aliased as E in a sort order, binding the cursor and :limit when limit > 0.
+    QList<EditionListRow> SelectEditions(const QString& source, EditionSortKey sort_key, const PageCursor& after, int limit) const;
 };
 
 #endif // EDITION_MANAGER_H
\ No newline at end of file
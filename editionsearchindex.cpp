@@ -0,0 +1,108 @@
+#include "editionsearchindex.h"
+
+#include <QThreadPool>
+#include <QRegularExpression>
+
+EditionSearchIndex::EditionSearchIndex(QSharedPointer<const CatalogueSnapshot> catalogue)
+    : catalogue(catalogue)
+{
+    offsets.reserve(catalogue->EditionCount() + 1);
+    for (int edition = 0; edition < catalogue->EditionCount(); ++edition) {
+        offsets.append(text.size());
+
+        // Fields are separated by a newline, which no term contains, so matches never span fields.
+        // The snapshot hands out views, which have no case folding of their own.
+        int book = catalogue->EditionBook(edition);
+        if (book != -1) {
+            text += catalogue->BookTitle(book).toString().toCaseFolded();
+            for (int i = 0; i < catalogue->BookAuthorCount(book); ++i) {
+                text += QChar('\n');
+                text += catalogue->BookAuthor(book, i).toString().toCaseFolded();
+            }
+        }
+        text += QChar('\n');
+        text += catalogue->EditionPublisher(edition).toString().toCaseFolded();
+        text += QChar('\n');
+        text += catalogue->EditionSeries(edition).toString().toCaseFolded();
+        text += QChar('\n');
+        text += catalogue->EditionIsbn(edition).toString().toCaseFolded();
+    }
+    offsets.append(text.size());
+    text.squeeze();
+}
+
+int EditionSearchIndex::Size() const
+{
+    return catalogue->EditionCount();
+}
+
+EditionListRow EditionSearchIndex::GetRow(int position) const
+{
+    return catalogue->GetEditionRow(position);
+}
+
+QStringList EditionSearchIndex::Terms(const QString& query)
+{
+    static const QRegularExpression whitespace("\\s+");
+    return query.toCaseFolded().split(whitespace, Qt::SkipEmptyParts);
+}
+
+QVector<int> EditionSearchIndex::Match(const QStringList& terms, int begin, int end) const
+{
+    QVector<int> matches;
+
+    for (int position = begin; position < end; ++position) {
+        QStringView row_text = QStringView(text).mid(offsets.at(position), offsets.at(position + 1) - offsets.at(position));
+
+        bool match = true;
+        for (const QString& term : terms) {
+            if (!row_text.contains(term)) {
+                match = false;
+                break;
+            }
+        }
+
+        if (match) {
+            matches.append(position);
+        }
+    }
+
+    return matches;
+}
+
+QFuture<QSharedPointer<const EditionSearchIndex>> EditionSearchIndex::BuildAsync(QSharedPointer<const CatalogueSnapshot> catalogue)
+{
+    auto promise = std::make_shared<QPromise<QSharedPointer<const EditionSearchIndex>>>();
+    QFuture<QSharedPointer<const EditionSearchIndex>> future = promise->future();
+    promise->start();
+
+    QThreadPool::globalInstance()->start([promise, catalogue]() {
+        promise->addResult(QSharedPointer<const EditionSearchIndex>::create(catalogue));
+        promise->finish();
+    });
+
+    return future;
+}
+
+QFuture<QVector<int>> EditionSearchIndex::FilterAsync(QSharedPointer<const EditionSearchIndex> index, const QString& query)
+{
+    auto promise = std::make_shared<QPromise<QVector<int>>>();
+    QFuture<QVector<int>> future = promise->future();
+    promise->start();
+
+    QThreadPool::globalInstance()->start([promise, index, terms = Terms(query)]() {
+        for (int begin = 0; begin < index->Size(); begin += kChunkSize) {
+            if (promise->isCanceled()) {
+                break;
+            }
+
+            QVector<int> matches = index->Match(terms, begin, qMin(begin + kChunkSize, index->Size()));
+            if (!matches.isEmpty()) {
+                promise->addResult(std::move(matches));
+            }
+        }
+        promise->finish();
+    });
+
+    return future;
+}
@@ -0,0 +1,99 @@
+#ifndef EDITION_SEARCH_INDEX_H
+#define EDITION_SEARCH_INDEX_H
+
+#include "cataloguesnapshot.h"
+
+#include <QSharedPointer>
+#include <QVector>
+
+/**
+ * @file editionsearchindex.h
+ * @brief Header file for EditionSearchIndex class.
+ *
+ * EditionSearchIndex is the live edition filter's index over the editions
+ * of a CatalogueSnapshot. The searchable fields of every edition are
+ * case-folded once into a single text arena, so a filter pass is a linear
+ * scan over contiguous memory that can run on any thread. Matching rows
+ * are read back from the snapshot, the index keeps no rows of its own.
+ */
+
+/**
+ * @class EditionSearchIndex
+ * @brief Immutable, thread-safe filter index over the edition rows.
+ *
+ * An edition matches a query when each whitespace-separated term of the
+ * query occurs in its title, authors, publisher, series or ISBN.
+ */
+class EditionSearchIndex
+{
+public:
+    static constexpr int kChunkSize = 8192; ///< Rows scanned between cancellation checks and partial results
+
+    /**
+     * @brief Indexes the editions of a snapshot.
+     * 
+     * @param catalogue The snapshot, its edition positions are the row positions.
+     */
+    explicit EditionSearchIndex(QSharedPointer<const CatalogueSnapshot> catalogue);
+
+    /**
+     * @brief Returns the number of indexed editions.
+     * 
+     * @return int The number of rows.
+     */
+    int Size() const;
+
+    /**
+     * @brief Returns an indexed edition row.
+     * 
+     * @param position Position of the row, from 0 to Size() - 1.
+     * @return EditionListRow The row, read from the snapshot.
+     */
+    EditionListRow GetRow(int position) const;
+
+    /**
+     * @brief Splits a filter query into case-folded terms.
+     * 
+     * @param query The text typed into the filter.
+     * @return QStringList The terms, empty if the query is blank.
+     */
+    static QStringList Terms(const QString& query);
+
+    /**
+     * @brief Finds the rows in a range that contain every term.
+     * 
+     * @param terms Case-folded terms, see Terms().
+     * @param begin First row position to scan.
+     * @param end Row position after the last one to scan.
+     * @return QVector<int> Positions of the matching rows, ascending.
+     */
+    QVector<int> Match(const QStringList& terms, int begin, int end) const;
+
+    /**
+     * @brief Indexes the editions of a snapshot on the global thread pool.
+     * 
+     * @param catalogue The snapshot.
+     * @return QFuture<QSharedPointer<const EditionSearchIndex>> The index.
+     */
+    static QFuture<QSharedPointer<const EditionSearchIndex>> BuildAsync(QSharedPointer<const CatalogueSnapshot> catalogue);
+
+    /**
+     * @brief Filters the index on the global thread pool.
+     *
+     * Matches are reported as one result per scanned chunk that matched, so
+     * they can be shown while the scan goes on. Cancelling the returned
+     * future stops the scan at the next chunk.
+     * 
+     * @param index The index to filter.
+     * @param query The text typed into the filter.
+     * @return QFuture<QVector<int>> Positions of the matching rows, chunk by chunk.
+     */
+    static QFuture<QVector<int>> FilterAsync(QSharedPointer<const EditionSearchIndex> index, const QString& query);
+
+private:
+    QSharedPointer<const CatalogueSnapshot> catalogue; ///< Snapshot the rows are read from
+    QString text; ///< Case-folded searchable text of all rows, back to back
+    QVector<int> offsets; ///< Start of each row's text in the arena, with the arena size appended
+};
+
+#endif // EDITION_SEARCH_INDEX_H
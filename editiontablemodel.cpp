@@ -0,0 +1,191 @@
+#include "editiontablemodel.h"
+#include "tracer.h"
+
+EditionTableModel::EditionTableModel(DatabaseExecutor* executor, QObject* parent)
+    : QAbstractTableModel(parent),
+      executor(executor),
+      fetching(false),
+      at_end(true), // Nothing is fetched before the first Reload()
+      tail_changed(false),
+      filtered(false),
+      generation(0)
+{
+}
+
+int EditionTableModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : editions.size();
+}
+
+int EditionTableModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant EditionTableModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= editions.size()) {
+        return QVariant();
+    }
+
+    const EditionListRow& edition = editions.at(index.row());
+
+    if (role == Qt::UserRole) {
+        return edition.edition_id;
+    }
+
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    switch (index.column()) {
+    case IdColumn:
+        return edition.edition_id;
+    case TitleColumn:
+        return edition.title;
+    case PublisherColumn:
+        return edition.publisher;
+    case AuthorsColumn:
+        return edition.authors.join(", ");
+    case LanguageColumn:
+        return edition.language;
+    case SeriesColumn:
+        return edition.series;
+    case PagesColumn:
+        return edition.page_count > 0 ? QVariant(edition.page_count) : QVariant();
+    default:
+        return QVariant();
+    }
+}
+
+QVariant EditionTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+
+    switch (section) {
+    case IdColumn:
+        return "Edition ID";
+    case TitleColumn:
+        return "Title";
+    case PublisherColumn:
+        return "Publisher";
+    case AuthorsColumn:
+        return "Authors";
+    case LanguageColumn:
+        return "Language";
+    case SeriesColumn:
+        return "Series";
+    case PagesColumn:
+        return "Pages";
+    default:
+        return QVariant();
+    }
+}
+
+bool EditionTableModel::canFetchMore(const QModelIndex& parent) const
+{
+    return !parent.isValid() && !at_end;
+}
+
+void EditionTableModel::fetchMore(const QModelIndex& parent)
+{
+    RT_TRACE_SCOPE("ui", "EditionTableModel::fetchMore");
+
+    // The view asks again once the pending page has been inserted
+    if (parent.isValid() || at_end || fetching) {
+        return;
+    }
+
+    fetching = true;
+    // Listed by ID, so appended editions are picked up by the next page
+    PageCursor after = editions.isEmpty() ? PageCursor() : EditionManager::CursorAfter(editions.last(), EditionSortKey::Id);
+    quint64 page_generation = generation;
+
+    EditionManager::ListEditionsPageAsync(executor, EditionSortKey::Id, after, kPageSize)
+        .then(this, [this, page_generation](const QList<EditionListRow>& page) {
+            if (page_generation == generation) {
+                AppendPage(page);
+            }
+        });
+}
+
+void EditionTableModel::Reload()
+{
+    RT_TRACE_SCOPE("ui", "EditionTableModel::Reload");
+
+    beginResetModel();
+    editions.clear();
+    editions.squeeze();
+    fetching = false;
+    at_end = false;
+    tail_changed = false;
+    filtered = false;
+    generation++;
+    endResetModel();
+
+    fetchMore(QModelIndex());
+}
+
+void EditionTableModel::ShowFiltered()
+{
+    RT_TRACE_SCOPE("ui", "EditionTableModel::ShowFiltered");
+
+    beginResetModel();
+    editions.clear();
+    fetching = false;
+    at_end = true; // Nothing to page in, rows come from the filter
+    tail_changed = false;
+    filtered = true;
+    generation++;
+    endResetModel();
+}
+
+void EditionTableModel::AppendFiltered(const QList<EditionListRow>& rows)
+{
+    RT_TRACE_SCOPE("ui", "EditionTableModel::AppendFiltered");
+
+    if (!filtered || rows.isEmpty()) {
+        return;
+    }
+
+    beginInsertRows(QModelIndex(), editions.size(), editions.size() + rows.size() - 1);
+    editions.append(rows);
+    endInsertRows();
+}
+
+void EditionTableModel::FetchAppended()
+{
+    RT_TRACE_SCOPE("ui", "EditionTableModel::FetchAppended");
+
+    if (filtered) {
+        return;
+    }
+
+    at_end = false;
+    if (fetching) {
+        tail_changed = true;
+        return;
+    }
+
+    fetchMore(QModelIndex());
+}
+
+void EditionTableModel::AppendPage(const QList<EditionListRow>& page)
+{
+    RT_TRACE_SCOPE("ui", "EditionTableModel::AppendPage");
+
+    // A page queried before rows were appended may have missed them
+    fetching = false;
+    at_end = page.size() < kPageSize && !tail_changed;
+    tail_changed = false;
+
+    if (!page.isEmpty()) {
+        beginInsertRows(QModelIndex(), editions.size(), editions.size() + page.size() - 1);
+        editions.append(page);
+        endInsertRows();
+    }
+
+    emit PageLoaded();
+}
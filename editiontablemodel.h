@@ -0,0 +1,102 @@
+#ifndef EDITION_TABLE_MODEL_H
+#define EDITION_TABLE_MODEL_H
+
+#include "databaseexecutor.h"
+
+#include <QAbstractTableModel>
+#include <QVector>
+
+/**
+ * @file editiontablemodel.h
+ * @brief Header file for EditionTableModel class.
+ *
+ * EditionTableModel backs the editions table. Rows are loaded a page at a
+ * time through EditionManager::ListEditionsPageAsync() as the view scrolls,
+ * so the first page is shown without reading the whole library.
+ */
+
+/**
+ * @class EditionTableModel
+ * @brief Lazily filled table model of editions, ordered by edition ID.
+ */
+class EditionTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column {
+        IdColumn, ///< Edition ID, hidden in the view
+        TitleColumn, ///< Title of the book
+        PublisherColumn, ///< Publisher of the edition
+        AuthorsColumn, ///< Authors of the book
+        LanguageColumn, ///< Language of the edition
+        SeriesColumn, ///< Series of the edition
+        PagesColumn, ///< Number of pages
+        ColumnCount
+    };
+
+    static constexpr int kPageSize = 256; ///< Number of editions fetched per page
+
+    /**
+     * @brief Constructs an empty model, call Reload() to fetch the first page.
+     * 
+     * @param executor The executor to run the page queries on, must outlive the model.
+     * @param parent Parent QObject.
+     */
+    explicit EditionTableModel(DatabaseExecutor* executor, QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+    /**
+     * @brief Drops the loaded rows and fetches the first page again.
+     *
+     * Leaves filtered mode. Pages still in flight from before the reload
+     * are discarded.
+     */
+    void Reload();
+
+    /**
+     * @brief Drops the loaded rows and stops paging, so filter results can be appended.
+     */
+    void ShowFiltered();
+
+    /**
+     * @brief Appends filter results to the rows in filtered mode.
+     * 
+     * @param rows The matching rows, in display order.
+     */
+    void AppendFiltered(const QList<EditionListRow>& rows);
+
+    /**
+     * @brief Resumes fetching after rows were appended to the table.
+     *
+     * New rows have the highest IDs, so they are picked up by the next page
+     * instead of reloading the loaded rows. Ignored in filtered mode.
+     */
+    void FetchAppended();
+
+signals:
+    /**
+     * @brief Emitted after a fetched page has been appended, also when it was empty.
+     */
+    void PageLoaded();
+
+private:
+    DatabaseExecutor* executor; ///< Executor the page queries run on
+    QVector<EditionListRow> editions; ///< Rows loaded so far, ordered by edition ID
+    bool fetching; ///< Whether a page query is in flight
+    bool at_end; ///< Whether the last page has been loaded
+    bool tail_changed; ///< Whether rows were appended while a page was in flight
+    bool filtered; ///< Whether the rows are filter results instead of pages
+    quint64 generation; ///< Incremented by Reload() to discard stale pages
+
+    void AppendPage(const QList<EditionListRow>& page); ///< Appends a fetched page to the rows
+};
+
+#endif // EDITION_TABLE_MODEL_H
@@ -1,29 +1,43 @@
 #include "idnametablemanager.h"
+#include "databaseexecutor.h"
+#include "tracer.h"
 
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QVariant>
+#include <QSet>
 #include <QDebug>
 
 IdNameTableManager::IdNameTableManager(DatabaseManager* db_manager, IdNameTable table)
     : database_manager(db_manager),
       table(table),
-      table_name(IdNameTableString(table))
+      table_name(IdNameTableString(table)),
+      insert_or_ignore_sql(QString("INSERT OR IGNORE INTO %1 (name) VALUES (:name)").arg(table_name)),
+      insert_sql(QString("INSERT INTO %1 (name) VALUES (:name)").arg(table_name)),
+      select_id_sql(QString("SELECT id FROM %1 WHERE name = :name").arg(table_name)),
+      select_name_sql(QString("SELECT name FROM %1 WHERE id = :id").arg(table_name)),
+      cache_enabled(true),
+      cache_loaded(false),
+      cache_rollback_count(0),
+      cache_stats{0, 0}
 {
     if (!database_manager || !database_manager->GetDatabase().isOpen()) {
         qCritical() << "Database connection is not valid or open.";
         return; // Database error
     }
-    CreateTable(); // Create the table if it doesn't exist
 }
 
 IdNameTableManager::~IdNameTableManager()
 {
-    // Destructor logic if needed
+    if (cache_stats.hits + cache_stats.misses > 0) {
+        qDebug() << table_name << "cache hits:" << cache_stats.hits << "misses:" << cache_stats.misses;
+    }
 }
 
 int IdNameTableManager::Insert(const QString& name)
 {
+    RT_TRACE_SCOPE("db", "IdNameTableManager::Insert");
+
     if (name.isEmpty()) {
         qWarning() << "Insert failed: name cannot be empty";
         return -1; // Invalid input
@@ -35,25 +49,36 @@ int IdNameTableManager::Insert(const QString& name)
         return -1; // Database error
     }
 
-    // Prepare the query to insert the name
     // Use INSERT OR IGNORE to avoid duplicates
-    QSqlDatabase db = database_manager->GetDatabase();
-    QSqlQuery query(db);
+    QSqlQuery* query = database_manager->GetCachedQuery(insert_or_ignore_sql);
+    if (!query) {
+        return -1; // Database error
+    }
 
     // Try inserting only if not exists
-    query.prepare(QString("INSERT OR IGNORE INTO %1 (name) VALUES (:name)").arg(table_name));
-    query.bindValue(":name", name);
-    if (!query.exec()) {
-        qCritical() << "Insert into" << table_name << ":" << query.lastError().text();
+    query->bindValue(":name", name);
+    if (!database_manager->Exec(query)) {
+        qCritical() << "Insert into" << table_name << ":" << query->lastError().text();
         return -1;
     }
 
-    // Fetch ID
+    if (query->numRowsAffected() == 1) {
+        int id = query->lastInsertId().toInt();
+        if (cache_enabled && cache_loaded) {
+            CacheName(id, name);
+        }
+        database_manager->PublishChange(ChangeEvent{ChangeType::NameInserted, id, name, table});
+        return id;
+    }
+
+    // Already existed, fetch ID
     return GetIdByName(name);
 }
 
 int IdNameTableManager::GetIdByName(const QString& name)
 {
+    RT_TRACE_SCOPE("db", "IdNameTableManager::GetIdByName");
+
     if (name.isEmpty()) {
         qWarning() << "Insert failed: name cannot be empty";
         return -1; // Invalid input
@@ -65,18 +90,34 @@ int IdNameTableManager::GetIdByName(const QString& name)
         return -1; // Database error
     }
 
-    QSqlDatabase db = database_manager->GetDatabase();
-    QSqlQuery query(db);
+    if (cache_enabled) {
+        LoadCache();
+        auto it = cache_name_to_id.constFind(name);
+        if (it != cache_name_to_id.constEnd()) {
+            cache_stats.hits++;
+            return it.value();
+        }
+        cache_stats.misses++;
+    }
+
+    QSqlQuery* query = database_manager->GetCachedQuery(select_id_sql);
+    if (!query) {
+        return -1; // Database error
+    }
 
-    query.prepare(QString("SELECT id FROM %1 WHERE name = :name").arg(table_name));
-    query.bindValue(":name", name);
-    if (!query.exec()) {
-        qCritical() << "GetIdByName from" << table_name << ":" << query.lastError().text();
+    query->bindValue(":name", name);
+    if (!database_manager->Exec(query)) {
+        qCritical() << "GetIdByName from" << table_name << ":" << query->lastError().text();
         return -1;
     }
 
-    if (query.next()) {
-        return query.value(0).toInt();
+    if (query->next()) {
+        int id = query->value(0).toInt();
+        query->finish();
+        if (cache_enabled) {
+            CacheName(id, name);
+        }
+        return id;
     }
 
     return -1; // Not found
@@ -84,6 +125,8 @@ int IdNameTableManager::GetIdByName(const QString& name)
 
 int IdNameTableManager::InsertIfNotExists(const QString& name)
 {
+    RT_TRACE_SCOPE("db", "IdNameTableManager::InsertIfNotExists");
+
     if (name.isEmpty()) {
         qWarning() << "InsertIfNotExists failed: name cannot be empty";
         return -1; // Invalid input
@@ -103,8 +146,109 @@ int IdNameTableManager::InsertIfNotExists(const QString& name)
     return Insert(name); // Insert and return new ID
 }
 
+QList<int> IdNameTableManager::InsertIfNotExists(const QStringList& names)
+{
+    RT_TRACE_SCOPE("db", "IdNameTableManager::InsertIfNotExists/list");
+
+    QList<int> ids(names.size(), -1);
+
+    // Ensure the database connection is valid
+    if (!database_manager || !database_manager->GetDatabase().isOpen()) {
+        qCritical() << "Database connection is not valid or open.";
+        return ids; // Database error
+    }
+
+    // Resolve the names already known, collect the rest once each
+    QHash<QString, int> resolved;
+    QSet<QString> seen;
+    QStringList unresolved;
+    for (const QString& name : names) {
+        if (name.isEmpty() || seen.contains(name)) {
+            continue;
+        }
+        seen.insert(name);
+        if (cache_enabled) {
+            LoadCache();
+            auto it = cache_name_to_id.constFind(name);
+            if (it != cache_name_to_id.constEnd()) {
+                cache_stats.hits++;
+                resolved.insert(name, it.value());
+                continue;
+            }
+            cache_stats.misses++;
+        }
+        unresolved.append(name);
+    }
+
+    if (!unresolved.isEmpty()) {
+        QHash<QString, int> existing;
+        if (!SelectIdsByNames(unresolved, existing)) {
+            return ids;
+        }
+
+        QStringList missing;
+        for (const QString& name : unresolved) {
+            auto it = existing.constFind(name);
+            if (it != existing.constEnd()) {
+                resolved.insert(name, it.value());
+                if (cache_enabled) {
+                    CacheName(it.value(), name);
+                }
+            }
+            else {
+                missing.append(name);
+            }
+        }
+
+        if (!missing.isEmpty()) {
+            ScopedTransaction transaction(database_manager);
+            if (!transaction.IsActive()) {
+                qCritical() << "InsertIfNotExists into" << table_name << ": failed to begin transaction";
+                return ids;
+            }
+
+            QSqlQuery* query = database_manager->GetCachedQuery(insert_sql);
+            if (!query) {
+                return ids; // Database error
+            }
+
+            QHash<QString, int> inserted;
+            for (const QString& name : missing) {
+                query->bindValue(":name", name);
+                if (!database_manager->Exec(query)) {
+                    qCritical() << "InsertIfNotExists into" << table_name << ":" << query->lastError().text();
+                    return ids; // Rolled back by the transaction scope
+                }
+                int id = query->lastInsertId().toInt();
+                inserted.insert(name, id);
+                database_manager->PublishChange(ChangeEvent{ChangeType::NameInserted, id, name, table});
+            }
+
+            if (!transaction.Commit()) {
+                qCritical() << "InsertIfNotExists into" << table_name << ": failed to commit transaction";
+                return ids;
+            }
+
+            for (auto it = inserted.constBegin(); it != inserted.constEnd(); ++it) {
+                resolved.insert(it.key(), it.value());
+                if (cache_enabled && cache_loaded) {
+                    CacheName(it.value(), it.key());
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < names.size(); ++i) {
+        ids[i] = resolved.value(names.at(i), -1);
+    }
+
+    return ids;
+}
+
 QString IdNameTableManager::GetNameById(int id)
 {
+    RT_TRACE_SCOPE("db", "IdNameTableManager::GetNameById");
+
     if(id <= 0) {
         qWarning() << "GetNameById failed: ID must be greater than 0";
         return {}; // Invalid input
@@ -116,18 +260,33 @@ QString IdNameTableManager::GetNameById(int id)
         return {}; // Database error
     }
 
-    QSqlDatabase db = database_manager->GetDatabase();
-    QSqlQuery query(db);
+    if (cache_enabled) {
+        LoadCache();
+        if (id < cache_id_to_name.size() && !cache_id_to_name.at(id).isNull()) {
+            cache_stats.hits++;
+            return cache_id_to_name.at(id);
+        }
+        cache_stats.misses++;
+    }
+
+    QSqlQuery* query = database_manager->GetCachedQuery(select_name_sql);
+    if (!query) {
+        return {}; // Database error
+    }
 
-    query.prepare(QString("SELECT name FROM %1 WHERE id = :id").arg(table_name));
-    query.bindValue(":id", id);
-    if (!query.exec()) {
-        qCritical() << "GetNameById from" << table_name << ":" << query.lastError().text();
+    query->bindValue(":id", id);
+    if (!database_manager->Exec(query)) {
+        qCritical() << "GetNameById from" << table_name << ":" << query->lastError().text();
         return {};
     }
 
-    if (query.next()) {
-        return query.value(0).toString();
+    if (query->next()) {
+        QString name = query->value(0).toString();
+        query->finish();
+        if (cache_enabled) {
+            CacheName(id, name);
+        }
+        return name;
     }
 
     return {};
@@ -135,6 +294,8 @@ QString IdNameTableManager::GetNameById(int id)
 
 QStringList IdNameTableManager::GetAllNames()
 {
+    RT_TRACE_SCOPE("db", "IdNameTableManager::GetAllNames");
+
     // Ensure the database connection is valid
     if (!database_manager || !database_manager->GetDatabase().isOpen()) {
         qCritical() << "Database connection is not valid or open.";
@@ -145,18 +306,191 @@ QStringList IdNameTableManager::GetAllNames()
     QSqlQuery query(db);
     QStringList names;
 
-    if (!query.exec(QString("SELECT name FROM %1 ORDER BY name").arg(table_name))) {
+    if (!database_manager->Exec(query, QString("SELECT name FROM %1 ORDER BY name").arg(table_name))) {
         qCritical() << "GetAllNames from" << table_name << ":" << query.lastError().text();
         return names;
     }
 
+    qint64 row_count = 0;
     while (query.next()) {
+        row_count++;
         names << query.value(0).toString();
     }
 
+    database_manager->RecordRows(query, row_count);
+
     return names;
 }
 
+QFuture<QStringList> IdNameTableManager::GetAllNamesAsync(DatabaseExecutor* executor, IdNameTable table)
+{
+    return executor->Run([table](Library& library) {
+        return library.GetIdNameTableManager(table)->GetAllNames();
+    });
+}
+
+QList<IdNameRow> IdNameTableManager::ListNamesPage(NameSortKey sort_key, const PageCursor& after, int limit)
+{
+    RT_TRACE_SCOPE("db", "IdNameTableManager::ListNamesPage");
+
+    // Ensure the database connection is valid
+    if (!database_manager || !database_manager->GetDatabase().isOpen()) {
+        qCritical() << "Database connection is not valid or open.";
+        return {}; // Database error
+    }
+
+    if (limit <= 0) {
+        qWarning() << "ListNamesPage failed: limit must be greater than 0";
+        return {};
+    }
+
+    // Names are unique, so the name index orders the rows on its own
+    bool by_name = sort_key == NameSortKey::Name;
+    QSqlQuery* query = database_manager->GetCachedQuery(QString("SELECT id, name FROM %1 WHERE %2 ORDER BY %3 LIMIT :limit")
+                                                            .arg(table_name, PageSeekSql(by_name ? "name" : "", "id"),
+                                                                 by_name ? "name, id" : "id"));
+    if (!query) {
+        return {}; // Database error
+    }
+
+    BindPageCursor(query, after, by_name);
+    query->bindValue(":limit", limit);
+
+    if (!database_manager->Exec(query)) {
+        qCritical() << "ListNamesPage from" << table_name << ":" << query->lastError().text();
+        return {};
+    }
+
+    QList<IdNameRow> rows;
+    while (query->next()) {
+        rows.append(IdNameRow{query->value(0).toInt(), query->value(1).toString()});
+    }
+
+    database_manager->RecordRows(*query, rows.size());
+
+    return rows;
+}
+
+QFuture<QList<IdNameRow>> IdNameTableManager::ListNamesPageAsync(DatabaseExecutor* executor, IdNameTable table,
+                                                                 NameSortKey sort_key, const PageCursor& after, int limit)
+{
+    return executor->Run([table, sort_key, after, limit](Library& library) {
+        return library.GetIdNameTableManager(table)->ListNamesPage(sort_key, after, limit);
+    });
+}
+
+PageCursor IdNameTableManager::CursorAfter(const IdNameRow& row, NameSortKey sort_key)
+{
+    return PageCursor{sort_key == NameSortKey::Name ? QVariant(row.name) : QVariant(), row.id};
+}
+
+void IdNameTableManager::SetCacheEnabled(bool enabled)
+{
+    cache_enabled = enabled;
+    if (!enabled) {
+        InvalidateCache();
+    }
+}
+
+bool IdNameTableManager::IsCacheEnabled() const
+{
+    return cache_enabled;
+}
+
+void IdNameTableManager::InvalidateCache()
+{
+    cache_loaded = false;
+    cache_name_to_id.clear();
+    cache_id_to_name.clear();
+}
+
+IdNameCacheStats IdNameTableManager::GetCacheStats() const
+{
+    return cache_stats;
+}
+
+void IdNameTableManager::ResetCacheStats()
+{
+    cache_stats = IdNameCacheStats{0, 0};
+}
+
+void IdNameTableManager::LoadCache()
+{
+    RT_TRACE_SCOPE("db", "IdNameTableManager::LoadCache");
+
+    quint64 rollback_count = database_manager->GetRollbackCount();
+    if (cache_loaded && cache_rollback_count == rollback_count) {
+        return;
+    }
+
+    // Names inserted inside a rolled back transaction may be cached
+    InvalidateCache();
+
+    QSqlDatabase db = database_manager->GetDatabase();
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+
+    if (!database_manager->Exec(query, QString("SELECT id, name FROM %1").arg(table_name))) {
+        qCritical() << "LoadCache from" << table_name << ":" << query.lastError().text();
+        return; // Lookups fall back to the database
+    }
+
+    while (query.next()) {
+        CacheName(query.value(0).toInt(), query.value(1).toString());
+    }
+
+    cache_loaded = true;
+    cache_rollback_count = rollback_count;
+}
+
+void IdNameTableManager::CacheName(int id, const QString& name)
+{
+    if (id <= 0) {
+        return;
+    }
+
+    cache_name_to_id.insert(name, id);
+    if (id >= cache_id_to_name.size()) {
+        cache_id_to_name.resize(id + 1);
+    }
+    cache_id_to_name[id] = name;
+}
+
+bool IdNameTableManager::SelectIdsByNames(const QStringList& names, QHash<QString, int>& ids)
+{
+    // Stay below SQLite's default limit on host parameters
+    const int chunk_size = 500;
+
+    QSqlDatabase db = database_manager->GetDatabase();
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+
+    for (int start = 0; start < names.size(); start += chunk_size) {
+        const QStringList chunk = names.mid(start, chunk_size);
+
+        QStringList placeholders;
+        placeholders.reserve(chunk.size());
+        for (int i = 0; i < chunk.size(); ++i) {
+            placeholders.append("?");
+        }
+
+        query.prepare(QString("SELECT id, name FROM %1 WHERE name IN (%2)").arg(table_name, placeholders.join(',')));
+        for (const QString& name : chunk) {
+            query.addBindValue(name);
+        }
+        if (!database_manager->Exec(&query)) {
+            qCritical() << "SelectIdsByNames from" << table_name << ":" << query.lastError().text();
+            return false;
+        }
+
+        while (query.next()) {
+            ids.insert(query.value(1).toString(), query.value(0).toInt());
+        }
+    }
+
+    return true;
+}
+
 const QString IdNameTableManager::IdNameTableString(IdNameTable table)
 {
     switch (table) {
@@ -172,20 +506,3 @@ const QString IdNameTableManager::IdNameTableString(IdNameTable table)
     }
 }
 
-void IdNameTableManager::CreateTable()
-{
-    // Ensure the database connection is valid
-    if (!database_manager || !database_manager->GetDatabase().isOpen()) {
-        qCritical() << "Database connection is not valid or open.";
-        return; // Database error
-    }
-    
-    QSqlDatabase db = database_manager->GetDatabase();
-    QSqlQuery query(db);
-
-    if(!query.exec(QString("CREATE TABLE IF NOT EXISTS %1 ("
-                           "id INTEGER PRIMARY KEY AUTOINCREMENT, "
-                           "name TEXT UNIQUE NOT NULL)").arg(table_name))) {
-        qCritical() << "Create" << table_name << ":" << query.lastError().text();
-    }
-}
@@ -2,6 +2,13 @@
 #define ID_NAME_TABLE_MANAGER_H
 
 #include "databasemanager.h"
+#include "pagecursor.h"
+
+#include <QHash>
+#include <QVector>
+#include <QFuture>
+
+class DatabaseExecutor;
 
 /**
  * @file idnametablemanager.h
@@ -22,6 +29,30 @@ enum class IdNameTable {
     AcquiredFrom ///< Represents the AcquiredFrom table
 };
 
+/**
+ * @brief Hit and miss counters of the IdNameTableManager cache.
+ */
+struct IdNameCacheStats {
+    quint64 hits; ///< Lookups answered from the cache
+    quint64 misses; ///< Lookups that had to query the database
+};
+
+/**
+ * @brief A row of an ID-Name table.
+ */
+struct IdNameRow {
+    int id; ///< ID of the name
+    QString name; ///< The name
+};
+
+/**
+ * @brief Orders of the name pages, see IdNameTableManager::ListNamesPage().
+ */
+enum class NameSortKey {
+    Id, ///< By ID, the order names were added in
+    Name ///< By name, the order of GetAllNames()
+};
+
 /**
  * @class IdNameTableManager
  * @brief Manages ID-Name tables in the database.
@@ -34,7 +65,7 @@ class IdNameTableManager
 public:
 
     /**
-     * @brief Constructs an IdNameTableManager object and initializes the tables.
+     * @brief Constructs an IdNameTableManager object.
      * 
      * @param db_manager Pointer to the DatabaseManager instance.
      * @param table The type of ID-Name table to manage.
@@ -70,6 +101,17 @@ public:
      */
     int InsertIfNotExists(const QString& name);
 
+    /**
+     * @brief Insert the names that do not already exist in the specified table
+     *
+     * Existing names are resolved in one pass, the missing ones are inserted
+     * inside a single transaction and their IDs taken from the inserts.
+     *
+     * @param names Names to insert, duplicates allowed
+     * @return QList<int> The IDs of the names in input order, -1 for empty names or on failure
+     */
+    QList<int> InsertIfNotExists(const QStringList& names);
+
     /**
      * @brief Get the Name By Id in the specified table
      *
@@ -85,10 +127,111 @@ public:
      */
     QStringList GetAllNames();
 
+    /**
+     * @brief Get all names from a table on the database worker thread
+     *
+     * @param executor The executor to run the query on
+     * @param table The table to read
+     * @return QFuture<QStringList> List of names in the table
+     */
+    static QFuture<QStringList> GetAllNamesAsync(DatabaseExecutor* executor, IdNameTable table);
+
+    /**
+     * @brief List one page of the table, seeking to the page through an index
+     *
+     * @param sort_key Order of the names
+     * @param after Cursor after the last row of the previous page, default constructed for the first page
+     * @param limit Maximum number of rows in the page
+     * @return QList<IdNameRow> The rows, fewer than limit on the last page
+     */
+    QList<IdNameRow> ListNamesPage(NameSortKey sort_key, const PageCursor& after, int limit);
+
+    /**
+     * @brief List one page of a table on the database worker thread, see ListNamesPage()
+     *
+     * @param executor The executor to run the query on
+     * @param table The table to read
+     * @param sort_key Order of the names
+     * @param after Cursor after the last row of the previous page
+     * @param limit Maximum number of rows in the page
+     * @return QFuture<QList<IdNameRow>> The rows
+     */
+    static QFuture<QList<IdNameRow>> ListNamesPageAsync(DatabaseExecutor* executor, IdNameTable table,
+                                                        NameSortKey sort_key, const PageCursor& after, int limit);
+
+    /**
+     * @brief Build the cursor of the page following a row
+     *
+     * @param row The last row of a page
+     * @param sort_key Order the page was listed in
+     * @return PageCursor The cursor of the next page
+     */
+    static PageCursor CursorAfter(const IdNameRow& row, NameSortKey sort_key);
+
+    /**
+     * @brief Enable or disable the in-memory name/id cache
+     *
+     * The cache is loaded lazily on first lookup and updated on insert.
+     * Names missing from the cache are still looked up in the database,
+     * so rows written by other connections are picked up on demand.
+     * Disabling the cache drops its contents.
+     *
+     * @param enabled True to enable the cache, false to disable it
+     */
+    void SetCacheEnabled(bool enabled);
+
+    /**
+     * @brief Check whether the name/id cache is enabled
+     *
+     * @return true if lookups go through the cache
+     */
+    bool IsCacheEnabled() const;
+
+    /**
+     * @brief Drop the cache contents so they are reloaded on next lookup
+     */
+    void InvalidateCache();
+
+    /**
+     * @brief Get the hit and miss counters of the cache
+     *
+     * @return IdNameCacheStats Counters since construction or the last reset
+     */
+    IdNameCacheStats GetCacheStats() const;
+
+    /**
+     * @brief Reset the hit and miss counters of the cache
+     */
+    void ResetCacheStats();
+
 private:
     DatabaseManager* database_manager;  ///< Pointer to the DatabaseManager instance
     IdNameTable table; ///< The table type being managed
     QString table_name; ///< The name of the table in the database
+    QString insert_or_ignore_sql; ///< SQL inserting a name unless it exists
+    QString insert_sql; ///< SQL inserting a name known to be missing
+    QString select_id_sql; ///< SQL selecting the ID of a name
+    QString select_name_sql; ///< SQL selecting the name of an ID
+
+    bool cache_enabled; ///< Whether lookups go through the cache
+    bool cache_loaded; ///< Whether the cache holds the table contents
+    quint64 cache_rollback_count; ///< Rollback count of the connection when the cache was loaded
+    QHash<QString, int> cache_name_to_id; ///< Cached name to id mapping
+    QVector<QString> cache_id_to_name; ///< Cached id to name mapping, indexed by id
+    IdNameCacheStats cache_stats; ///< Cache hit and miss counters
+
+    void LoadCache(); ///< Loads the whole table into the cache if it is not loaded yet or may hold rolled back rows
+
+    void CacheName(int id, const QString& name); ///< Adds an id/name pair to the cache
+
+    /**
+     * @brief Look up the IDs of the given names in the database with chunked IN queries
+     *
+     * @param names Distinct, non-empty names to look up
+     * @param ids Map receiving the IDs of the names that were found
+     * @return true on success, false on a database error
+     */
+    bool SelectIdsByNames(const QStringList& names, QHash<QString, int>& ids);
 
     /**
      * @brief Convert IdNameTable enum to string
@@ -97,8 +240,6 @@ private:
      */
     const QString IdNameTableString(IdNameTable table);
 
-    void CreateTable(); ///< Creates the ID-Name table in the database
-
 };
 
 #endif //ID_NAME_TABLE_MANAGER_H
@@ -0,0 +1,55 @@
+#include "library.h"
+
+Library::Library(DatabaseManager* db_manager)
+    : database_manager(db_manager)
+{
+    author_manager = new IdNameTableManager(database_manager, IdNameTable::Author);
+    language_manager = new IdNameTableManager(database_manager, IdNameTable::Language);
+    country_manager = new IdNameTableManager(database_manager, IdNameTable::Country);
+    genre_manager = new IdNameTableManager(database_manager, IdNameTable::Genre);
+    book_manager = new BookManager(database_manager, author_manager, language_manager, country_manager, genre_manager);
+
+    publisher_manager = new IdNameTableManager(database_manager, IdNameTable::Publisher);
+    series_manager = new IdNameTableManager(database_manager, IdNameTable::Series);
+    edition_manager = new EditionManager(database_manager, publisher_manager, language_manager, series_manager, book_manager);
+
+    r_item_manager = new RItemManager(database_manager, edition_manager);
+
+    acquired_from_manager = new IdNameTableManager(database_manager, IdNameTable::AcquiredFrom);
+    shelf_manager = new IdNameTableManager(database_manager, IdNameTable::Shelf);
+    my_library_manager = new MyLibraryManager(database_manager, acquired_from_manager, shelf_manager, r_item_manager);
+
+    search_manager = new SearchManager(database_manager);
+}
+
+Library::~Library()
+{
+    delete search_manager;
+    delete my_library_manager;
+    delete shelf_manager;
+    delete acquired_from_manager;
+    delete r_item_manager;
+    delete edition_manager;
+    delete series_manager;
+    delete publisher_manager;
+    delete book_manager;
+    delete genre_manager;
+    delete country_manager;
+    delete language_manager;
+    delete author_manager;
+}
+
+IdNameTableManager* Library::GetIdNameTableManager(IdNameTable table) const
+{
+    switch (table) {
+        case IdNameTable::Author: return author_manager;
+        case IdNameTable::Publisher: return publisher_manager;
+        case IdNameTable::Language: return language_manager;
+        case IdNameTable::Country: return country_manager;
+        case IdNameTable::Genre: return genre_manager;
+        case IdNameTable::Series: return series_manager;
+        case IdNameTable::Shelf: return shelf_manager;
+        case IdNameTable::AcquiredFrom: return acquired_from_manager;
+        default: return nullptr;
+    }
+}
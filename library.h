@@ -0,0 +1,61 @@
+#ifndef LIBRARY_H
+#define LIBRARY_H
+
+#include "mylibrarymanager.h"
+#include "searchmanager.h"
+
+/**
+ * @file library.h
+ * @brief Header file for Library class.
+ *
+ * Library owns the full set of managers working on one database connection,
+ * wired together in dependency order.
+ */
+
+/**
+ * @class Library
+ * @brief Owns the managers of one database connection.
+ */
+class Library
+{
+public:
+    /**
+     * @brief Constructs all managers on the given database manager.
+     * 
+     * @param db_manager Pointer to the DatabaseManager instance, not owned.
+     */
+    explicit Library(DatabaseManager* db_manager);
+
+    /**
+     * @brief Destroys the managers in reverse construction order.
+     */
+    ~Library();
+
+    Library(const Library&) = delete;
+    Library& operator=(const Library&) = delete;
+
+    /**
+     * @brief Get the IdNameTableManager of a lookup table.
+     * 
+     * @param table The lookup table.
+     * @return IdNameTableManager* The manager of the table.
+     */
+    IdNameTableManager* GetIdNameTableManager(IdNameTable table) const;
+
+    DatabaseManager* database_manager; ///< Pointer to the DatabaseManager instance.
+    IdNameTableManager* author_manager; ///< Pointer to the IdNameTableManager instance for authors.
+    IdNameTableManager* language_manager; ///< Pointer to the IdNameTableManager instance for languages.
+    IdNameTableManager* country_manager; ///< Pointer to the IdNameTableManager instance for countries.
+    IdNameTableManager* genre_manager; ///< Pointer to the IdNameTableManager instance for genres.
+    BookManager* book_manager; ///< Pointer to the BookManager instance.
+    IdNameTableManager* publisher_manager; ///< Pointer to the IdNameTableManager instance for publishers.
+    IdNameTableManager* series_manager; ///< Pointer to the IdNameTableManager instance for series.
+    EditionManager* edition_manager; ///< Pointer to the EditionManager instance.
+    RItemManager* r_item_manager; ///< Pointer to the RItemManager instance.
+    IdNameTableManager* acquired_from_manager; ///< Pointer to the IdNameTableManager instance for acquired_from.
+    IdNameTableManager* shelf_manager; ///< Pointer to the IdNameTableManager instance for shelves.
+    MyLibraryManager* my_library_manager; ///< Pointer to the MyLibraryManager instance.
+    SearchManager* search_manager; ///< Pointer to the SearchManager instance.
+};
+
+#endif // LIBRARY_H
@@ -0,0 +1,203 @@
+#include "libraryexporter.h"
+#include "databaseexecutor.h"
+#include "tracer.h"
+
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QTextStream>
+
+namespace {
+
+// Names are joined with the ASCII unit separator, which cannot occur in them
+const QChar kNameSeparator(0x1f);
+
+/**
+ * @brief Columns of an export, in the order of the query and of the CSV header.
+ */
+enum ExportColumn {
+    BookIdColumn,
+    TitleColumn,
+    AuthorsColumn,
+    OriginalLanguageColumn,
+    GenresColumn,
+    PublisherColumn,
+    LanguageColumn,
+    SeriesColumn,
+    PageCountColumn,
+    IsbnColumn,
+    PublicationDateColumn,
+    EditionTypeColumn,
+    AcquiredDateColumn,
+    AcquiredFromColumn,
+    ShelfColumn,
+    NotesColumn,
+    ColumnCount
+};
+
+// CSV headers and JSON keys LibraryImporter maps back to the same fields. The lists
+// are "Author List" and "Genre List" because "Authors" and "Genres" are split on
+// commas, which names such as "Tolkien, J.R.R." contain.
+const char* const kCsvHeaders[ColumnCount] = {
+    "Book Id", "Title", "Author List", "Original Language", "Genre List", "Publisher", "Language", "Series",
+    "Number of Pages", "ISBN13", "Publication Date", "Binding", "Date Added",
+    "Acquired From", "Shelf", "Notes",
+};
+const char* const kJsonKeys[ColumnCount] = {
+    "book_id", "title", "authors", "original_language", "genres", "publisher", "language", "series",
+    "page_count", "isbn13", "publication_date", "format", "date_added",
+    "acquired_from", "shelf", "notes",
+};
+
+QString CsvField(QString value)
+{
+    if (value.contains(',') || value.contains('"') || value.contains('\n') || value.contains('\r')) {
+        value.replace('"', "\"\"");
+        return '"' + value + '"';
+    }
+    return value;
+}
+
+} // namespace
+
+LibraryExporter::LibraryExporter(Library* library)
+    : library(library)
+{
+}
+
+int LibraryExporter::ExportFile(const QString& path, ExportFormat format)
+{
+    if (format == ExportFormat::Auto) {
+        const QString suffix = QFileInfo(path).suffix().toLower();
+        format = (suffix == "json" || suffix == "jsonl" || suffix == "ndjson") ? ExportFormat::Json : ExportFormat::Csv;
+    }
+
+    // A failed export leaves an existing file untouched
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCritical() << "ExportFile: cannot open" << path << ":" << file.errorString();
+        return -1;
+    }
+
+    int written = ExportDevice(&file, format);
+    if (written == -1) {
+        file.cancelWriting();
+        return -1;
+    }
+
+    if (!file.commit()) {
+        qCritical() << "ExportFile: cannot write" << path << ":" << file.errorString();
+        return -1;
+    }
+
+    return written;
+}
+
+int LibraryExporter::ExportDevice(QIODevice* device, ExportFormat format)
+{
+    RT_TRACE_SCOPE("db", "LibraryExporter::ExportDevice");
+
+    if (!library || !library->database_manager || !library->database_manager->GetDatabase().isOpen()) {
+        qCritical() << "Database connection is not valid or open.";
+        return -1;
+    }
+
+    QSqlQuery query(library->database_manager->GetDatabase());
+    query.setForwardOnly(true);
+
+    // Streams in edition order, so the export needs no memory per row
+    if (!query.exec("SELECT Book.id, Book.title, "
+                    "(SELECT group_concat(Author.name, char(31)) FROM Book2Author "
+                    "JOIN Author ON Author.id = Book2Author.author_id WHERE Book2Author.book_id = Book.id), "
+                    "OriginalLanguage.name, "
+                    "(SELECT group_concat(Genre.name, char(31)) FROM Book2Genre "
+                    "JOIN Genre ON Genre.id = Book2Genre.genre_id WHERE Book2Genre.book_id = Book.id), "
+                    "Publisher.name, Language.name, Series.name, Edition.page_count, Edition.isbn, "
+                    "Edition.publication_date, Edition.type, MyLibrary.acquired_date, AcquiredFrom.name, "
+                    "Shelf.name, MyLibrary.notes "
+                    "FROM Book "
+                    "LEFT JOIN Language AS OriginalLanguage ON OriginalLanguage.id = Book.org_lang_id "
+                    "LEFT JOIN Edition ON Edition.book_id = Book.id "
+                    "LEFT JOIN Publisher ON Publisher.id = Edition.publisher_id "
+                    "LEFT JOIN Language ON Language.id = Edition.language_id "
+                    "LEFT JOIN Series ON Series.id = Edition.series_id "
+                    "LEFT JOIN RItem ON RItem.edition_id = Edition.id AND RItem.type = 0 "
+                    "LEFT JOIN MyLibrary ON MyLibrary.r_item_id = RItem.id "
+                    "LEFT JOIN AcquiredFrom ON AcquiredFrom.id = MyLibrary.acquired_from_id "
+                    "LEFT JOIN Shelf ON Shelf.id = MyLibrary.shelf_id "
+                    "ORDER BY Book.id, Edition.id, MyLibrary.id")) {
+        qCritical() << "ExportDevice:" << query.lastError().text();
+        return -1;
+    }
+
+    QTextStream out(device);
+    out.setEncoding(QStringConverter::Utf8);
+
+    if (format != ExportFormat::Json) {
+        QStringList headers;
+        for (const char* header : kCsvHeaders) {
+            headers.append(header);
+        }
+        out << headers.join(',') << '\n';
+    }
+
+    int written = 0;
+    while (query.next()) {
+        QStringList values;
+        for (int column = 0; column < ColumnCount; ++column) {
+            values.append(query.value(column).toString());
+        }
+        values[AcquiredDateColumn] = query.value(AcquiredDateColumn).toDateTime().date().toString(Qt::ISODate);
+
+        if (format == ExportFormat::Json) {
+            QJsonObject object;
+            for (int column = 0; column < ColumnCount; ++column) {
+                const QString& value = values.at(column);
+                if (value.isEmpty()) {
+                    continue;
+                }
+                if (column == AuthorsColumn || column == GenresColumn) {
+                    object.insert(kJsonKeys[column], QJsonArray::fromStringList(value.split(kNameSeparator)));
+                }
+                else if (column == BookIdColumn || column == PageCountColumn) {
+                    object.insert(kJsonKeys[column], value.toInt());
+                }
+                else {
+                    object.insert(kJsonKeys[column], value);
+                }
+            }
+            out << QString::fromUtf8(QJsonDocument(object).toJson(QJsonDocument::Compact)) << '\n';
+        }
+        else {
+            QStringList fields;
+            for (int column = 0; column < ColumnCount; ++column) {
+                QString value = values.at(column);
+                if (column == AuthorsColumn || column == GenresColumn) {
+                    value.replace(kNameSeparator, "; ");
+                }
+                fields.append(CsvField(value));
+            }
+            out << fields.join(',') << '\n';
+        }
+
+        written++;
+    }
+
+    out.flush();
+    if (out.status() != QTextStream::Ok) {
+        qCritical() << "ExportDevice: write failed";
+        return -1;
+    }
+
+    return written;
+}
+
+QFuture<int> LibraryExporter::ExportFileAsync(DatabaseExecutor* executor, const QString& path, ExportFormat format)
+{
+    return executor->Run([path, format](Library& library) {
+        LibraryExporter exporter(&library);
+        return exporter.ExportFile(path, format);
+    });
+}
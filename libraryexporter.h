@@ -0,0 +1,77 @@
+#ifndef LIBRARY_EXPORTER_H
+#define LIBRARY_EXPORTER_H
+
+#include "library.h"
+
+class QIODevice;
+
+/**
+ * @file libraryexporter.h
+ * @brief Header file for LibraryExporter class.
+ *
+ * LibraryExporter writes every edition, with its book and library entry,
+ * to a CSV file or to a file of one JSON object per line. The columns and
+ * keys are the ones LibraryImporter reads, so an export can be imported
+ * into another database. Every record carries the ID of its book, which
+ * the importer uses to write the editions of a book under one book.
+ */
+
+/**
+ * @brief Format of an export file.
+ */
+enum class ExportFormat {
+    Auto, ///< Picked from the file extension: .json, .jsonl and .ndjson are JSON, anything else CSV
+    Csv, ///< Comma-separated values with a header row
+    Json ///< One JSON object per line
+};
+
+/**
+ * @class LibraryExporter
+ * @brief Exports the library to files.
+ */
+class LibraryExporter
+{
+public:
+    /**
+     * @brief Constructs an exporter reading through the database of a library.
+     * 
+     * @param library The library to export, must outlive the exporter.
+     */
+    explicit LibraryExporter(Library* library);
+
+    /**
+     * @brief Exports the library to a file.
+     *
+     * There is one record per library entry, one per edition that is not
+     * in the library, and one per book without editions.
+     * 
+     * @param path Path of the file, replaced if it exists.
+     * @param format Format of the file.
+     * @return int The number of records written, or -1 on failure.
+     */
+    int ExportFile(const QString& path, ExportFormat format = ExportFormat::Auto);
+
+    /**
+     * @brief Exports the library to an open device, such as standard output.
+     * 
+     * @param device The device to write to.
+     * @param format Format of the data, Auto is treated as CSV.
+     * @return int The number of records written, or -1 on failure.
+     */
+    int ExportDevice(QIODevice* device, ExportFormat format);
+
+    /**
+     * @brief Exports the library on the database worker thread, see ExportFile().
+     * 
+     * @param executor The executor to run the export on.
+     * @param path Path of the file.
+     * @param format Format of the file.
+     * @return QFuture<int> The number of records written, or -1 on failure.
+     */
+    static QFuture<int> ExportFileAsync(DatabaseExecutor* executor, const QString& path, ExportFormat format = ExportFormat::Auto);
+
+private:
+    Library* library; ///< Library the export reads from
+};
+
+#endif // LIBRARY_EXPORTER_H
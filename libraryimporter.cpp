@@ -0,0 +1,809 @@
+#include "libraryimporter.h"
+#include "databaseexecutor.h"
+#include "tracer.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+namespace {
+
+const int kReadChunkSize = 64 * 1024;
+
+/**
+ * @brief Columns and keys an import file can map to.
+ */
+enum class ImportField {
+    Ignored,
+    BookKey,
+    Title,
+    Author, ///< A single author, which may contain a comma ("Last, First")
+    Authors, ///< A comma-separated list of authors
+    AuthorList, ///< A semicolon-separated list of authors, as LibraryExporter writes it
+    OriginalLanguage,
+    Language,
+    Genres,
+    GenreList, ///< A semicolon-separated list of genres, as LibraryExporter writes it
+    Publisher,
+    Series,
+    PageCount,
+    Isbn,
+    Isbn13,
+    PublicationDate,
+    EditionType,
+    AcquiredDate,
+    AcquiredFrom,
+    Shelf,
+    Notes
+};
+
+// Goodreads and LibraryThing column names, and their snake_case JSON spellings
+ImportField FieldForName(const QString& name)
+{
+    static const QHash<QString, ImportField> fields = {
+        {"book id", ImportField::BookKey},
+        {"book key", ImportField::BookKey},
+        {"title", ImportField::Title},
+        {"author", ImportField::Author},
+        {"primary author", ImportField::Author},
+        {"authors", ImportField::Authors},
+        {"additional authors", ImportField::Authors},
+        {"secondary author", ImportField::Authors},
+        {"author list", ImportField::AuthorList},
+        {"original language", ImportField::OriginalLanguage},
+        {"original languages", ImportField::OriginalLanguage},
+        {"language", ImportField::Language},
+        {"languages", ImportField::Language},
+        {"genre", ImportField::Genres},
+        {"genres", ImportField::Genres},
+        {"subjects", ImportField::Genres},
+        {"genre list", ImportField::GenreList},
+        {"publisher", ImportField::Publisher},
+        {"series", ImportField::Series},
+        {"number of pages", ImportField::PageCount},
+        {"num pages", ImportField::PageCount},
+        {"page count", ImportField::PageCount},
+        {"pages", ImportField::PageCount},
+        {"isbn", ImportField::Isbn},
+        {"isbn10", ImportField::Isbn},
+        {"isbn13", ImportField::Isbn13},
+        {"year published", ImportField::PublicationDate},
+        {"publication date", ImportField::PublicationDate},
+        {"publication year", ImportField::PublicationDate},
+        {"date", ImportField::PublicationDate},
+        {"binding", ImportField::EditionType},
+        {"format", ImportField::EditionType},
+        {"media", ImportField::EditionType},
+        {"date added", ImportField::AcquiredDate},
+        {"date acquired", ImportField::AcquiredDate},
+        {"acquired date", ImportField::AcquiredDate},
+        {"acquired", ImportField::AcquiredDate},
+        {"acquired from", ImportField::AcquiredFrom},
+        {"from where", ImportField::AcquiredFrom},
+        {"source", ImportField::AcquiredFrom},
+        {"shelf", ImportField::Shelf},
+        {"notes", ImportField::Notes},
+        {"private notes", ImportField::Notes},
+        {"private comment", ImportField::Notes},
+    };
+
+    QString key = name.trimmed().toLower();
+    key.replace('_', ' ');
+    return fields.value(key, ImportField::Ignored);
+}
+
+QStringList SplitList(const QString& value, QChar separator)
+{
+    QStringList items;
+    const QStringList parts = value.split(separator, Qt::SkipEmptyParts);
+    for (const QString& part : parts) {
+        QString item = part.trimmed();
+        if (!item.isEmpty()) {
+            items.append(item);
+        }
+    }
+    return items;
+}
+
+void ApplyField(ImportRecord& record, ImportField field, const QString& raw_value)
+{
+    const QString value = raw_value.trimmed();
+    if (value.isEmpty()) {
+        return;
+    }
+
+    switch (field) {
+    case ImportField::Ignored:
+        break;
+    case ImportField::BookKey:
+        record.book_key = value;
+        break;
+    case ImportField::Title:
+        record.title = value;
+        break;
+    case ImportField::Author:
+        record.authors.prepend(value); // The primary author goes first
+        break;
+    case ImportField::Authors:
+        record.authors.append(SplitList(value, ','));
+        break;
+    case ImportField::AuthorList:
+        record.authors.append(SplitList(value, ';'));
+        break;
+    case ImportField::OriginalLanguage:
+        record.original_language = value;
+        break;
+    case ImportField::Language:
+        record.language = value;
+        break;
+    case ImportField::Genres:
+        record.genres.append(SplitList(value, ','));
+        break;
+    case ImportField::GenreList:
+        record.genres.append(SplitList(value, ';'));
+        break;
+    case ImportField::Publisher:
+        record.publisher = value;
+        break;
+    case ImportField::Series:
+        record.series = value;
+        break;
+    case ImportField::PageCount:
+        record.page_count = value.toInt();
+        break;
+    case ImportField::Isbn:
+    case ImportField::Isbn13: {
+        // Goodreads writes ISBNs as ="0451524934" to keep spreadsheets from mangling them
+        QString isbn;
+        for (QChar c : value) {
+            if (c.isDigit() || c == 'X' || c == 'x') {
+                isbn += c.toUpper();
+            }
+        }
+        if (!isbn.isEmpty() && (field == ImportField::Isbn13 || record.isbn.isEmpty())) {
+            record.isbn = isbn;
+        }
+        break;
+    }
+    case ImportField::PublicationDate:
+        record.publication_date = value;
+        break;
+    case ImportField::EditionType:
+        record.edition_type = value;
+        break;
+    case ImportField::AcquiredDate: {
+        QDate date = QDate::fromString(value.left(10), "yyyy-MM-dd");
+        if (!date.isValid()) {
+            date = QDate::fromString(value.left(10), "yyyy/MM/dd");
+        }
+        if (date.isValid()) {
+            record.acquired_date = date.startOfDay();
+        }
+        break;
+    }
+    case ImportField::AcquiredFrom:
+        record.acquired_from = value;
+        break;
+    case ImportField::Shelf:
+        record.shelf = value;
+        break;
+    case ImportField::Notes:
+        record.notes = value;
+        break;
+    }
+}
+
+/**
+ * @brief Streaming reader of RFC 4180 style records, with quoted fields spanning lines.
+ */
+class CsvReader
+{
+public:
+    explicit CsvReader(QIODevice* device)
+        : stream(device),
+          position(0),
+          delimiter(',')
+    {
+        stream.setEncoding(QStringConverter::Utf8);
+    }
+
+    // Picks tab or comma, whichever the header line has more of
+    void DetectDelimiter()
+    {
+        Fill();
+        int line_end = buffer.indexOf('\n');
+        QStringView header = QStringView(buffer).left(line_end == -1 ? buffer.size() : line_end);
+        delimiter = header.count('\t') > header.count(',') ? '\t' : ',';
+    }
+
+    bool ReadRecord(QStringList& fields)
+    {
+        fields.clear();
+        QString field;
+        bool in_quotes = false;
+        bool started = false;
+
+        while (true) {
+            if (position >= buffer.size() && !Fill()) {
+                if (!started) {
+                    return false; // End of input
+                }
+                fields.append(field);
+                return true;
+            }
+
+            QChar c = buffer.at(position++);
+            started = true;
+
+            if (in_quotes) {
+                if (c != '"') {
+                    field += c;
+                }
+                else if ((position < buffer.size() || Fill()) && buffer.at(position) == '"') {
+                    field += c; // Escaped quote
+                    position++;
+                }
+                else {
+                    in_quotes = false;
+                }
+            }
+            else if (c == '"') {
+                in_quotes = true;
+            }
+            else if (c == delimiter) {
+                fields.append(field);
+                field.clear();
+            }
+            else if (c == '\n') {
+                fields.append(field);
+                return true;
+            }
+            else if (c != '\r') {
+                field += c;
+            }
+        }
+    }
+
+private:
+    QTextStream stream; ///< Decodes the device as UTF-8, skipping a byte order mark
+    QString buffer; ///< Decoded text not consumed yet
+    int position; ///< Read position in the buffer
+    QChar delimiter; ///< Field delimiter
+
+    // Replaces the consumed buffer with the next chunk
+    bool Fill()
+    {
+        buffer = stream.read(kReadChunkSize);
+        position = 0;
+        return !buffer.isEmpty();
+    }
+};
+
+/**
+ * @brief Streaming reader of JSON objects from an array or from one object per line.
+ *
+ * Top-level objects are cut out of the byte stream by tracking nesting
+ * outside strings, then parsed one at a time.
+ */
+class JsonReader
+{
+public:
+    explicit JsonReader(QIODevice* device)
+        : device(device),
+          position(0)
+    {
+    }
+
+    bool ReadObject(QJsonObject& object)
+    {
+        // Skip to the next object, past array brackets, commas and whitespace
+        while (true) {
+            if (position >= buffer.size() && !Fill()) {
+                return false;
+            }
+            if (buffer.at(position) == '{') {
+                break;
+            }
+            position++;
+        }
+
+        QByteArray text;
+        int depth = 0;
+        bool in_string = false;
+        bool escaped = false;
+
+        while (true) {
+            if (position >= buffer.size()) {
+                if (!Fill()) {
+                    qWarning() << "ImportFile: truncated JSON object";
+                    return false;
+                }
+            }
+
+            // Scan to the end of the object or of the buffer, then copy the span at once
+            int start = position;
+            bool complete = false;
+            while (position < buffer.size() && !complete) {
+                char c = buffer.at(position++);
+                if (in_string) {
+                    if (escaped) {
+                        escaped = false;
+                    }
+                    else if (c == '\\') {
+                        escaped = true;
+                    }
+                    else if (c == '"') {
+                        in_string = false;
+                    }
+                }
+                else if (c == '"') {
+                    in_string = true;
+                }
+                else if (c == '{' || c == '[') {
+                    depth++;
+                }
+                else if (c == '}' || c == ']') {
+                    complete = --depth == 0;
+                }
+            }
+            text.append(buffer.constData() + start, position - start);
+
+            if (complete) {
+                break;
+            }
+        }
+
+        QJsonParseError error;
+        QJsonDocument document = QJsonDocument::fromJson(text, &error);
+        if (error.error != QJsonParseError::NoError) {
+            qWarning() << "ImportFile: skipping invalid JSON object:" << error.errorString();
+            object = QJsonObject();
+            return true;
+        }
+
+        object = document.object();
+        return true;
+    }
+
+private:
+    QIODevice* device; ///< Device the bytes are read from
+    QByteArray buffer; ///< Bytes not consumed yet
+    int position; ///< Read position in the buffer
+
+    bool Fill()
+    {
+        buffer = device->read(kReadChunkSize);
+        position = 0;
+        return !buffer.isEmpty();
+    }
+};
+
+QString JsonValueText(const QJsonValue& value)
+{
+    if (value.isString()) {
+        return value.toString();
+    }
+    if (value.isDouble()) {
+        return QString::number(value.toDouble(), 'g', 15);
+    }
+    return QString();
+}
+
+ImportRecord RecordFromJson(const QJsonObject& object)
+{
+    ImportRecord record;
+    for (auto it = object.constBegin(); it != object.constEnd(); ++it) {
+        ImportField field = FieldForName(it.key());
+        if (field == ImportField::Ignored) {
+            continue;
+        }
+
+        if (it.value().isArray()) {
+            // Arrays are lists of names, so elements must not be split on commas
+            const QJsonArray values = it.value().toArray();
+            for (const QJsonValue& element : values) {
+                QString text = JsonValueText(element).trimmed();
+                if (text.isEmpty()) {
+                    continue;
+                }
+                if (field == ImportField::Author || field == ImportField::Authors || field == ImportField::AuthorList) {
+                    record.authors.append(text);
+                }
+                else if (field == ImportField::Genres || field == ImportField::GenreList) {
+                    record.genres.append(text);
+                }
+                else {
+                    ApplyField(record, field, text);
+                }
+            }
+        }
+        else {
+            ApplyField(record, field, JsonValueText(it.value()));
+        }
+    }
+    return record;
+}
+
+QVariant NullableInt(int id)
+{
+    return id > 0 ? QVariant(id) : QVariant(QVariant::Int);
+}
+
+QVariant NullableString(const QString& value)
+{
+    return value.isEmpty() ? QVariant(QVariant::String) : QVariant(value);
+}
+
+} // namespace
+
+LibraryImporter::LibraryImporter(Library* library)
+    : library(library),
+      last_book_id(-1)
+{
+}
+
+int LibraryImporter::ImportFile(const QString& path, const ImportOptions& options, const ImportProgressCallback& progress)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCritical() << "ImportFile: cannot open" << path << ":" << file.errorString();
+        return -1;
+    }
+
+    ImportFormat format = options.format;
+    if (format == ImportFormat::Auto) {
+        const QString suffix = QFileInfo(path).suffix().toLower();
+        format = (suffix == "json" || suffix == "jsonl" || suffix == "ndjson") ? ImportFormat::Json : ImportFormat::Csv;
+    }
+
+    return ImportDevice(&file, format, options, progress);
+}
+
+int LibraryImporter::ImportDevice(QIODevice* device, ImportFormat format, const ImportOptions& options, const ImportProgressCallback& progress)
+{
+    RT_TRACE_SCOPE("db", "LibraryImporter::ImportDevice");
+
+    if (!library || !library->database_manager || !library->database_manager->GetDatabase().isOpen()) {
+        qCritical() << "Database connection is not valid or open.";
+        return -1;
+    }
+
+    // New names would each reach the views as an event, the Reset at the end reloads them all at once
+    ScopedChangeSuppression suppression(library->database_manager);
+
+    // Book keys are only meaningful within one file
+    last_book_key.clear();
+    last_book_id = -1;
+
+    ImportProgress state;
+    state.bytes_total = device->isSequential() ? 0 : device->size();
+
+    const int batch_size = qMax(1, options.batch_size);
+    QList<ImportRecord> batch;
+    batch.reserve(batch_size);
+
+    // Writes the batch and reports progress, false stops the import
+    bool failed = false;
+    auto flush = [&]() {
+        int imported = ImportBatch(batch, options.add_to_library, &state.records_skipped);
+        batch.clear();
+        if (imported == -1) {
+            failed = true;
+            return false;
+        }
+        state.books_imported += imported;
+        state.bytes_read = device->pos();
+        return !progress || progress(state);
+    };
+
+    bool stopped = false;
+    if (format == ImportFormat::Json) {
+        JsonReader reader(device);
+        QJsonObject object;
+        while (!stopped && reader.ReadObject(object)) {
+            state.records_read++;
+            batch.append(RecordFromJson(object));
+            if (batch.size() == batch_size) {
+                stopped = !flush();
+            }
+        }
+    }
+    else {
+        CsvReader reader(device);
+        reader.DetectDelimiter();
+
+        QStringList fields;
+        QList<ImportField> columns;
+        if (reader.ReadRecord(fields)) {
+            for (const QString& header : fields) {
+                columns.append(FieldForName(header));
+            }
+        }
+        if (!columns.contains(ImportField::Title)) {
+            qCritical() << "ImportFile: the header has no Title column";
+            return -1;
+        }
+
+        while (!stopped && reader.ReadRecord(fields)) {
+            if (fields.size() == 1 && fields.first().isEmpty()) {
+                continue; // Blank line
+            }
+            state.records_read++;
+
+            ImportRecord record;
+            for (int i = 0; i < fields.size() && i < columns.size(); ++i) {
+                ApplyField(record, columns.at(i), fields.at(i));
+            }
+            batch.append(record);
+
+            if (batch.size() == batch_size) {
+                stopped = !flush();
+            }
+        }
+    }
+
+    if (!stopped && !batch.isEmpty()) {
+        flush();
+    }
+
+    if (state.books_imported > 0) {
+        // Too many rows for row-level updates, views reload instead
+        library->database_manager->PublishChange(ChangeEvent{ChangeType::Reset, -1, QString()});
+    }
+
+    qInfo() << "ImportFile: read" << state.records_read << "records, imported" << state.books_imported
+            << "books, skipped" << state.records_skipped;
+
+    return failed ? -1 : state.books_imported;
+}
+
+QFuture<int> LibraryImporter::ImportFileAsync(DatabaseExecutor* executor, const QString& path, const ImportOptions& options, const ImportProgressCallback& progress)
+{
+    return executor->Run([path, options, progress](Library& library) {
+        LibraryImporter importer(&library);
+        return importer.ImportFile(path, options, progress);
+    });
+}
+
+int LibraryImporter::ImportBatch(const QList<ImportRecord>& records, bool add_to_library, int* skipped)
+{
+    RT_TRACE_SCOPE("db", "LibraryImporter::ImportBatch");
+
+    DatabaseManager* database_manager = library->database_manager;
+
+    QStringList isbns;
+    for (const ImportRecord& record : records) {
+        if (!record.isbn.isEmpty()) {
+            isbns.append(record.isbn);
+        }
+    }
+    isbns.removeDuplicates();
+
+    ScopedTransaction transaction(database_manager);
+    if (!transaction.IsActive()) {
+        qCritical() << "ImportBatch: failed to begin transaction";
+        return -1;
+    }
+
+    QSet<QString> known_isbns;
+    if (!SelectExistingIsbns(isbns, known_isbns)) {
+        return -1;
+    }
+
+    // Skip untitled records and known ISBNs before any name is written, so skipped records leave no rows behind
+    QList<ImportRecord> accepted;
+    accepted.reserve(records.size());
+    for (const ImportRecord& record : records) {
+        if (record.title.isEmpty() || (!record.isbn.isEmpty() && known_isbns.contains(record.isbn))) {
+            if (skipped) {
+                (*skipped)++;
+            }
+            continue;
+        }
+        if (!record.isbn.isEmpty()) {
+            known_isbns.insert(record.isbn); // Later duplicates in the file are skipped too
+        }
+        accepted.append(record);
+    }
+    if (accepted.isEmpty()) {
+        return transaction.Commit() ? 0 : -1;
+    }
+
+    // Collect the names of the accepted records, so each table is resolved with bulk lookups
+    QStringList authors, genres, languages, publishers, series, shelves, acquired_from;
+    for (const ImportRecord& record : std::as_const(accepted)) {
+        authors.append(record.authors);
+        genres.append(record.genres);
+        languages.append(record.original_language);
+        languages.append(record.language);
+        publishers.append(record.publisher.isEmpty() ? QString(kUnknownPublisher) : record.publisher);
+        series.append(record.series);
+        if (add_to_library) {
+            shelves.append(record.shelf);
+            acquired_from.append(record.acquired_from);
+        }
+    }
+
+    QHash<QString, int> author_ids, genre_ids, language_ids, publisher_ids, series_ids, shelf_ids, acquired_from_ids;
+    if (!ResolveNames(library->author_manager, authors, author_ids)
+        || !ResolveNames(library->genre_manager, genres, genre_ids)
+        || !ResolveNames(library->language_manager, languages, language_ids)
+        || !ResolveNames(library->publisher_manager, publishers, publisher_ids)
+        || !ResolveNames(library->series_manager, series, series_ids)
+        || !ResolveNames(library->shelf_manager, shelves, shelf_ids)
+        || !ResolveNames(library->acquired_from_manager, acquired_from, acquired_from_ids)) {
+        return -1; // Rolled back by the transaction scope
+    }
+
+    // Documents are built once per book at the end instead of once per inserted row
+    if (!library->search_manager->SuspendIndexing()) {
+        return -1;
+    }
+
+    QSqlQuery* book_query = database_manager->GetCachedQuery("INSERT INTO Book (title, org_lang_id, country_id, type) VALUES (:title, :org_lang_id, NULL, NULL)");
+    QSqlQuery* author_query = database_manager->GetCachedQuery("INSERT OR IGNORE INTO Book2Author (book_id, author_id) VALUES (:book_id, :author_id)");
+    QSqlQuery* genre_query = database_manager->GetCachedQuery("INSERT OR IGNORE INTO Book2Genre (book_id, genre_id) VALUES (:book_id, :genre_id)");
+    QSqlQuery* edition_query = database_manager->GetCachedQuery("INSERT INTO Edition (book_id, publisher_id, language_id, series_id, page_count, publication_date, isbn, type, cover_image_path) "
+                                                                "VALUES (:book_id, :publisher_id, :language_id, :series_id, :page_count, :publication_date, :isbn, :type, NULL)");
+    QSqlQuery* r_item_query = database_manager->GetCachedQuery("INSERT INTO RItem (type, edition_id, issue_id) VALUES (:type, :edition_id, NULL)");
+    QSqlQuery* my_library_query = database_manager->GetCachedQuery("INSERT INTO MyLibrary (r_item_id, acquired_from_id, acquired_date, price, shelf_id, notes) "
+                                                                    "VALUES (:r_item_id, :acquired_from_id, :acquired_date, NULL, :shelf_id, :notes)");
+    if (!book_query || !author_query || !genre_query || !edition_query || !r_item_query || !my_library_query) {
+        return -1;
+    }
+
+    int imported = 0;
+    int first_book_id = -1;
+    int first_my_library_id = -1;
+
+    for (const ImportRecord& record : std::as_const(accepted)) {
+        // A record continuing the book of the previous one, possibly in the previous batch, only adds an edition
+        const bool same_book = !record.book_key.isEmpty() && record.book_key == last_book_key && last_book_id > 0;
+        int book_id = last_book_id;
+
+        if (!same_book) {
+            book_query->bindValue(":title", record.title);
+            book_query->bindValue(":org_lang_id", NullableInt(language_ids.value(record.original_language)));
+            if (!database_manager->Exec(book_query)) {
+                qCritical() << "ImportBatch: Book:" << book_query->lastError().text();
+                return -1;
+            }
+            book_id = book_query->lastInsertId().toInt();
+            last_book_key = record.book_key;
+            last_book_id = book_id;
+
+            for (const QString& author : record.authors) {
+                author_query->bindValue(":book_id", book_id);
+                author_query->bindValue(":author_id", author_ids.value(author));
+                if (!database_manager->Exec(author_query)) {
+                    qCritical() << "ImportBatch: Book2Author:" << author_query->lastError().text();
+                    return -1;
+                }
+            }
+
+            for (const QString& genre : record.genres) {
+                genre_query->bindValue(":book_id", book_id);
+                genre_query->bindValue(":genre_id", genre_ids.value(genre));
+                if (!database_manager->Exec(genre_query)) {
+                    qCritical() << "ImportBatch: Book2Genre:" << genre_query->lastError().text();
+                    return -1;
+                }
+            }
+
+            imported++;
+        }
+
+        // The book of a continued record is the oldest of the batch, so it is reindexed too
+        if (first_book_id == -1) {
+            first_book_id = book_id;
+        }
+
+        edition_query->bindValue(":book_id", book_id);
+        edition_query->bindValue(":publisher_id", publisher_ids.value(record.publisher.isEmpty() ? QString(kUnknownPublisher) : record.publisher));
+        edition_query->bindValue(":language_id", NullableInt(language_ids.value(record.language)));
+        edition_query->bindValue(":series_id", NullableInt(series_ids.value(record.series)));
+        edition_query->bindValue(":page_count", NullableInt(record.page_count));
+        edition_query->bindValue(":publication_date", NullableString(record.publication_date));
+        edition_query->bindValue(":isbn", NullableString(record.isbn));
+        edition_query->bindValue(":type", NullableString(record.edition_type));
+        if (!database_manager->Exec(edition_query)) {
+            qCritical() << "ImportBatch: Edition:" << edition_query->lastError().text();
+            return -1;
+        }
+        int edition_id = edition_query->lastInsertId().toInt();
+
+        r_item_query->bindValue(":type", static_cast<int>(RItemType::Edition));
+        r_item_query->bindValue(":edition_id", edition_id);
+        if (!database_manager->Exec(r_item_query)) {
+            qCritical() << "ImportBatch: RItem:" << r_item_query->lastError().text();
+            return -1;
+        }
+        int r_item_id = r_item_query->lastInsertId().toInt();
+
+        if (add_to_library) {
+            my_library_query->bindValue(":r_item_id", r_item_id);
+            my_library_query->bindValue(":acquired_from_id", NullableInt(acquired_from_ids.value(record.acquired_from)));
+            my_library_query->bindValue(":acquired_date", record.acquired_date.isValid() ? QVariant(record.acquired_date) : QVariant(QVariant::DateTime));
+            my_library_query->bindValue(":shelf_id", NullableInt(shelf_ids.value(record.shelf)));
+            my_library_query->bindValue(":notes", NullableString(record.notes));
+            if (!database_manager->Exec(my_library_query)) {
+                qCritical() << "ImportBatch: MyLibrary:" << my_library_query->lastError().text();
+                return -1;
+            }
+            if (first_my_library_id == -1) {
+                first_my_library_id = my_library_query->lastInsertId().toInt();
+            }
+        }
+    }
+
+    if (!library->search_manager->ResumeIndexing(first_book_id, first_my_library_id)) {
+        return -1;
+    }
+
+    if (!transaction.Commit()) {
+        qCritical() << "ImportBatch: failed to commit transaction";
+        return -1;
+    }
+
+    return imported;
+}
+
+bool LibraryImporter::ResolveNames(IdNameTableManager* manager, const QStringList& names, QHash<QString, int>& ids)
+{
+    QStringList distinct;
+    for (const QString& name : names) {
+        if (!name.isEmpty() && !ids.contains(name)) {
+            ids.insert(name, -1);
+            distinct.append(name);
+        }
+    }
+
+    const QList<int> resolved = manager->InsertIfNotExists(distinct);
+    for (int i = 0; i < distinct.size(); ++i) {
+        if (resolved.at(i) == -1) {
+            qCritical() << "ImportBatch: failed to resolve" << distinct.at(i);
+            return false;
+        }
+        ids.insert(distinct.at(i), resolved.at(i));
+    }
+
+    return true;
+}
+
+bool LibraryImporter::SelectExistingIsbns(const QStringList& isbns, QSet<QString>& existing)
+{
+    // Stay below SQLite's default limit on host parameters
+    const int chunk_size = 500;
+
+    QSqlDatabase db = library->database_manager->GetDatabase();
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+
+    for (int start = 0; start < isbns.size(); start += chunk_size) {
+        const QStringList chunk = isbns.mid(start, chunk_size);
+
+        QStringList placeholders;
+        placeholders.reserve(chunk.size());
+        for (int i = 0; i < chunk.size(); ++i) {
+            placeholders.append("?");
+        }
+
+        query.prepare(QString("SELECT isbn FROM Edition WHERE isbn IN (%1)").arg(placeholders.join(',')));
+        for (const QString& isbn : chunk) {
+            query.addBindValue(isbn);
+        }
+        if (!library->database_manager->Exec(&query)) {
+            qCritical() << "SelectExistingIsbns:" << query.lastError().text();
+            return false;
+        }
+
+        while (query.next()) {
+            existing.insert(query.value(0).toString());
+        }
+    }
+
+    return true;
+}
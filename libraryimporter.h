@@ -0,0 +1,176 @@
+#ifndef LIBRARY_IMPORTER_H
+#define LIBRARY_IMPORTER_H
+
+#include "library.h"
+
+#include <QSet>
+
+#include <functional>
+
+class QIODevice;
+
+/**
+ * @file libraryimporter.h
+ * @brief Header file for LibraryImporter class.
+ *
+ * LibraryImporter streams library exports into the database. CSV and TSV
+ * files (Goodreads, LibraryThing) and JSON files (an array of objects or
+ * one object per line) are parsed record by record, so files of any size
+ * are imported in constant memory. Records are written in batches: the
+ * names of a batch are resolved with one bulk lookup per table, and the
+ * rows are written with cached statements in one transaction per batch.
+ */
+
+/**
+ * @brief Format of an import file.
+ */
+enum class ImportFormat {
+    Auto, ///< Detected from the file extension: .json, .jsonl and .ndjson are JSON, anything else CSV
+    Csv, ///< Comma- or tab-separated values with a header row
+    Json ///< A JSON array of objects, or one JSON object per line
+};
+
+struct ImportOptions {
+    ImportFormat format = ImportFormat::Auto; ///< Format of the file
+    int batch_size = 5000; ///< Records written per transaction
+    bool add_to_library = true; ///< Whether every imported edition is also added to MyLibrary
+};
+
+struct ImportProgress {
+    qint64 bytes_read = 0; ///< Bytes of the file parsed so far
+    qint64 bytes_total = 0; ///< Size of the file, 0 if unknown
+    int records_read = 0; ///< Records parsed so far
+    int books_imported = 0; ///< Books written so far
+    int records_skipped = 0; ///< Records skipped for lacking a title or having a known ISBN
+};
+
+/**
+ * @brief Called after every committed batch; returning false stops the import.
+ */
+using ImportProgressCallback = std::function<bool(const ImportProgress&)>;
+
+/**
+ * @brief One book of an import file, with its edition and library entry.
+ */
+struct ImportRecord {
+    QString book_key; ///< Key shared by consecutive records of one book, such as the Book Id of an export; empty if the record is a book of its own
+    QString title; ///< Title of the book
+    QStringList authors; ///< Authors of the book
+    QString original_language; ///< Original language of the book
+    QStringList genres; ///< Genres of the book
+    QString publisher; ///< Publisher of the edition
+    QString language; ///< Language of the edition
+    QString series; ///< Series of the edition
+    int page_count = 0; ///< Number of pages, 0 if unknown
+    QString isbn; ///< ISBN of the edition, digits and X only
+    QString publication_date; ///< Publication date as written in the file
+    QString edition_type; ///< Binding or format of the edition
+    QDateTime acquired_date; ///< Date the item was acquired
+    QString acquired_from; ///< Where the item was acquired
+    QString shelf; ///< Shelf the item is on
+    QString notes; ///< Private notes on the item
+};
+
+/**
+ * @class LibraryImporter
+ * @brief Bulk imports library export files.
+ */
+class LibraryImporter
+{
+public:
+    static constexpr const char* kUnknownPublisher = "Unknown"; ///< Publisher of editions imported without one
+
+    /**
+     * @brief Constructs an importer writing through the managers of a library.
+     * 
+     * @param library The library to import into, must outlive the importer.
+     */
+    explicit LibraryImporter(Library* library);
+
+    /**
+     * @brief Imports a file.
+     *
+     * Records without a title, and records whose ISBN is already in the
+     * database or earlier in the file, are skipped. Consecutive records
+     * with the same book key are imported as editions of one book. A failed batch is
+     * rolled back; the batches before it stay imported.
+     * 
+     * @param path Path of the file.
+     * @param options Import options.
+     * @param progress Optional progress callback.
+     * @return int The number of books imported, or -1 on failure.
+     */
+    int ImportFile(const QString& path,
+                   const ImportOptions& options = ImportOptions(),
+                   const ImportProgressCallback& progress = ImportProgressCallback());
+
+    /**
+     * @brief Imports records from an open device, such as standard input.
+     * 
+     * @param device The device to read from.
+     * @param format Format of the data, Auto is treated as CSV.
+     * @param options Import options, the format is ignored.
+     * @param progress Optional progress callback.
+     * @return int The number of books imported, or -1 on failure.
+     */
+    int ImportDevice(QIODevice* device,
+                     ImportFormat format,
+                     const ImportOptions& options = ImportOptions(),
+                     const ImportProgressCallback& progress = ImportProgressCallback());
+
+    /**
+     * @brief Imports a file on the database worker thread, see ImportFile().
+     *
+     * The progress callback is called on the worker thread.
+     * 
+     * @param executor The executor to run the import on.
+     * @param path Path of the file.
+     * @param options Import options.
+     * @param progress Optional progress callback.
+     * @return QFuture<int> The number of books imported, or -1 on failure.
+     */
+    static QFuture<int> ImportFileAsync(DatabaseExecutor* executor,
+                                        const QString& path,
+                                        const ImportOptions& options = ImportOptions(),
+                                        const ImportProgressCallback& progress = ImportProgressCallback());
+
+    /**
+     * @brief Writes a batch of records in one transaction.
+     *
+     * A record with the same book key as the record written before it,
+     * also at the end of the previous batch, adds its edition to that
+     * record's book instead of creating a book.
+     * 
+     * @param records The records to write.
+     * @param add_to_library Whether every edition is also added to MyLibrary.
+     * @param skipped Incremented for every record that is skipped.
+     * @return int The number of books written, or -1 on failure.
+     */
+    int ImportBatch(const QList<ImportRecord>& records, bool add_to_library, int* skipped = nullptr);
+
+private:
+    Library* library; ///< Managers the import writes through
+    QString last_book_key; ///< Book key of the last record written
+    int last_book_id; ///< ID of the book of the last record written, -1 if none
+
+    /**
+     * @brief Looks up the names of a lookup table, inserting the missing ones.
+     * 
+     * @param manager The manager of the table.
+     * @param names The names, may contain duplicates and empty names.
+     * @param ids Receives the ID of every non-empty name.
+     * @return true on success, false on a database error.
+     */
+    static bool ResolveNames(IdNameTableManager* manager, const QStringList& names, QHash<QString, int>& ids);
+
+    /**
+     * @brief Selects which of the given ISBNs already have an edition.
+     * 
+     * @param isbns Distinct, non-empty ISBNs.
+     * @param existing Receives the ISBNs that were found.
+     * @return true on success, false on a database error.
+     */
+    bool SelectExistingIsbns(const QStringList& isbns, QSet<QString>& existing);
+};
+
+#endif // LIBRARY_IMPORTER_H
@@ -1,11 +1,33 @@
 #include "mainwindow.h"
+#include "tracer.h"
 
 #include <QApplication>
+#include <QElapsedTimer>
 
 int main(int argc, char *argv[])
 {
+    // Startup times are measured from here, before Qt loads its plugins
+    QElapsedTimer startup_timer;
+    startup_timer.start();
+
     QApplication a(argc, argv);
-    MainWindow w;
-    w.show();
-    return a.exec();
+
+    // READING_TRACKER_TRACE=<file> records startup and the whole session
+    const QString trace_path = qEnvironmentVariable("READING_TRACKER_TRACE");
+    if (Tracer::kCompiledIn && !trace_path.isEmpty()) {
+        Tracer::Instance().Start();
+    }
+
+    int result;
+    {
+        MainWindow w(nullptr, startup_timer);
+        w.show();
+        result = a.exec();
+    }
+
+    if (Tracer::kCompiledIn && !trace_path.isEmpty()) {
+        Tracer::Instance().Stop();
+        Tracer::Instance().WriteChromeTrace(trace_path);
+    }
+    return result;
 }
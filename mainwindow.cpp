@@ -2,65 +2,154 @@
 #include "ui_mainwindow.h"
 
 #include "addedition.h"
+#include "cataloguelistmodel.h"
+#include "editiontablemodel.h"
+#include "editionfilter.h"
+#include "ritemlistmodel.h"
+#include "namecompletionmodel.h"
+#include "libraryimporter.h"
+#include "calibreimporter.h"
+#include "tracer.h"
 
 #include <QMessageBox>
 #include <QCompleter>
-#include <QStandardItemModel>
+#include <QFileDialog>
+#include <QSaveFile>
+#include <QSignalBlocker>
+#include <QTimer>
 
-MainWindow::MainWindow(QWidget *parent)
+namespace {
+
+const int kInitialLoadDelayMs = 500; // Longest wait for the first paint before loading anyway
+
+} // namespace
+
+MainWindow::MainWindow(QWidget *parent, const QElapsedTimer& startup_timer)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
+    , startup_timer(startup_timer)
+    , first_paint_ms(-1)
+    , initial_load_started(false)
+    , interactive(false)
+    , pending_loads(0)
+    , catalogue_loading(false)
+    , catalogue_changed(false)
+    , catalogue_reset(false)
 {
+    RT_TRACE_SCOPE("ui", "MainWindow::MainWindow");
+
     ui->setupUi(this);
 
-    // Initialize EditionManager and BookManager
-    DatabaseManager* database_manager = new DatabaseManager();
+    // Writes run on the writer executor's thread. Reads run on a read-only
+    // connection of their own, which WAL lets run alongside a long import.
+    connection_pool = new DatabaseConnectionPool();
+    executor = new DatabaseExecutor(connection_pool, ConnectionRole::Writer, this);
+    reader_executor = new DatabaseExecutor(connection_pool, ConnectionRole::Reader, this);
+
+    // Opens the connections and migrates the schema on the workers while the window is painted
+    executor->Run([](Library&) {});
+    reader_executor->Run([](Library&) {});
+
+    // The views keep their models, refreshes reload them in place
+    edition_model = new EditionTableModel(reader_executor, this);
+    ui->tableViewEditions->setModel(edition_model);
+
+    // Resets clear hidden sections, so hide the Edition ID column after each one
+    connect(edition_model, &QAbstractItemModel::modelReset, this, [this]() {
+        ui->tableViewEditions->setColumnHidden(EditionTableModel::IdColumn, true);
+    });
+
+    edition_filter = new EditionFilter(edition_model, this);
+    connect(ui->lineEditEditionFilter, &QLineEdit::textChanged, edition_filter, &EditionFilter::SetQuery);
+
+    r_item_model = new RItemListModel(reader_executor, this);
+    ui->listViewRItems->setModel(r_item_model);
+
+    // The combo boxes list the shared snapshot instead of holding their own items
+    book_list_model = new CatalogueListModel(CatalogueListModel::Kind::Books, this);
+    ui->comboBoxBook->setModel(book_list_model);
+    r_item_list_model = new CatalogueListModel(CatalogueListModel::Kind::RItems, this);
+    ui->comboBoxRItem->setModel(r_item_list_model);
+
+    // Tracing spans are compiled out unless READING_TRACKER_ENABLE_TRACING is set
+    ui->actionRecordTrace->setVisible(Tracer::kCompiledIn);
+    {
+        // A trace started from the environment keeps recording
+        QSignalBlocker blocker(ui->actionRecordTrace);
+        ui->actionRecordTrace->setChecked(Tracer::Instance().IsRecording());
+    }
 
-    author_manager = new IdNameTableManager(database_manager, IdNameTable::Author);
-    language_manager = new IdNameTableManager(database_manager, IdNameTable::Language);
-    country_manager = new IdNameTableManager(database_manager, IdNameTable::Country);
-    genre_manager = new IdNameTableManager(database_manager, IdNameTable::Genre);
-    book_manager = new BookManager(database_manager, author_manager, language_manager, country_manager, genre_manager);
+    // Inserts are applied row by row from the committed change events
+    connect(connection_pool->GetChangeNotifier(), &ChangeNotifier::Changed, this, &MainWindow::ApplyChanges);
 
-    publisher_manager = new IdNameTableManager(database_manager, IdNameTable::Publisher);
-    //language_manager = new IdNameTableManager(database_manager, IdNameTable::Language); // Already created for BookManager
-    series_manager = new IdNameTableManager(database_manager, IdNameTable::Series);
-    edition_manager = new EditionManager(database_manager, publisher_manager, language_manager, series_manager, book_manager);
+    if (!this->startup_timer.isValid()) {
+        this->startup_timer.start();
+    }
 
-    r_item_manager = new RItemManager(database_manager, edition_manager);
+    // Nothing is loaded before the window is shown, see event(). A window that is
+    // not painted, e.g. started minimized, loads after a short delay instead.
+    QTimer::singleShot(kInitialLoadDelayMs, this, &MainWindow::StartInitialLoad);
+}
 
-    acquired_from_manager = new IdNameTableManager(database_manager, IdNameTable::AcquiredFrom);
-    shelf_manager = new IdNameTableManager(database_manager, IdNameTable::Shelf);
-    my_library_manager = new MyLibraryManager(database_manager, shelf_manager, r_item_manager);
+MainWindow::~MainWindow()
+{
+    // Finish pending jobs before the UI goes away
+    delete reader_executor;
+    delete executor;
+    qDeleteAll(name_indexes);
+    delete connection_pool;
+    delete ui;
+}
 
-    // Set up completers for input fields
-    RefreshBookCompleters();
+bool MainWindow::event(QEvent* event)
+{
+    bool handled = QMainWindow::event(event);
 
-    RefreshEditionCompleters();
-    RefreshEditionsView();
+    // The frame is flushed after the paint events, queue the load behind it
+    if (event->type() == QEvent::Paint && first_paint_ms < 0) {
+        first_paint_ms = startup_timer.elapsed();
+        QTimer::singleShot(0, this, &MainWindow::StartInitialLoad);
+    }
 
-    RefreshMyLibraryCompleters();
+    return handled;
 }
 
-MainWindow::~MainWindow()
+void MainWindow::StartInitialLoad()
 {
-    delete my_library_manager;
-    delete shelf_manager;
-    delete acquired_from_manager;
-    delete r_item_manager;
-    delete edition_manager;
-    delete series_manager;
-    delete publisher_manager;
-    delete book_manager;
-    delete genre_manager;
-    delete country_manager;
-    delete language_manager;
-    delete author_manager;
-    delete ui;
+    RT_TRACE_SCOPE("ui", "MainWindow::StartInitialLoad");
+
+    if (initial_load_started) {
+        return;
+    }
+    initial_load_started = true;
+
+    RefreshAll();
+}
+
+void MainWindow::BeginLoad()
+{
+    pending_loads++;
+}
+
+void MainWindow::EndLoad()
+{
+    pending_loads--;
+    if (pending_loads > 0 || interactive || !initial_load_started) {
+        return;
+    }
+
+    // Every tab and completer has its first data
+    interactive = true;
+    qint64 interactive_ms = startup_timer.elapsed();
+    qInfo().noquote() << QString("Startup: first paint after %1 ms, interactive after %2 ms")
+                             .arg(first_paint_ms).arg(interactive_ms);
+    ui->statusbar->showMessage(QString("Ready in %1 ms").arg(interactive_ms), 5000);
 }
 
 void MainWindow::on_pushButtonAddBook_clicked()
 {
+    RT_TRACE_SCOPE("ui", "MainWindow::on_pushButtonAddBook_clicked");
+
     BookData book_data;
 
     // Collect book data from UI inputs (not shown here)
@@ -85,35 +174,38 @@ void MainWindow::on_pushButtonAddBook_clicked()
         return;
     }
 
-    int book_id = book_manager->InsertBook(book_data);
+    ui->pushButtonAddBook->setEnabled(false); // Until the insert completes
 
-    if (book_id != -1) {
-        QMessageBox::information(this, "Success", "Book added successfully!");
-    }
-    else {
-        QMessageBox::warning(this, "Error", "Failed to add book.");
-    }
+    BookManager::InsertBookAsync(executor, book_data).then(this, [this](int book_id) {
+        ui->pushButtonAddBook->setEnabled(true);
 
-    // Clear input fields after adding the book
-    ui->lineEditTitle->clear();
-    ui->lineEditAuthors->clear();
-    ui->lineEditOriginalLanguage->clear();
-    ui->lineEditCountry->clear();
-    ui->lineEditGenres->clear();
+        if (book_id != -1) {
+            QMessageBox::information(this, "Success", "Book added successfully!");
+        }
+        else {
+            QMessageBox::warning(this, "Error", "Failed to add book.");
+        }
 
-    RefreshBookCompleters(); // Refresh completers to include new entries
-    ui->lineEditTitle->setFocus(); // Set focus back to title input
+        // Clear input fields after adding the book
+        ui->lineEditTitle->clear();
+        ui->lineEditAuthors->clear();
+        ui->lineEditOriginalLanguage->clear();
+        ui->lineEditCountry->clear();
+        ui->lineEditGenres->clear();
 
-    RefreshEditionCompleters();
+        ui->lineEditTitle->setFocus(); // Set focus back to title input
+    });
 }
 
 void MainWindow::RefreshBookCompleters()
 {
+    RT_TRACE_SCOPE("ui", "MainWindow::RefreshBookCompleters");
+
     // Refresh completers for input fields
-    RefreshQCompleter(author_manager, ui->lineEditAuthors);
-    RefreshQCompleter(language_manager, ui->lineEditOriginalLanguage);
-    RefreshQCompleter(country_manager, ui->lineEditCountry);
-    RefreshQCompleter(genre_manager, ui->lineEditGenres);
+    RefreshQCompleter(IdNameTable::Author, ui->lineEditAuthors);
+    RefreshQCompleter(IdNameTable::Language, ui->lineEditOriginalLanguage);
+    RefreshQCompleter(IdNameTable::Country, ui->lineEditCountry);
+    RefreshQCompleter(IdNameTable::Genre, ui->lineEditGenres);
 }
 
 /// @todo Rename to AddRItem instead of AddEdition
@@ -121,6 +213,8 @@ void MainWindow::RefreshBookCompleters()
 /// @bug When page_count is not set, it inserts last page_count value instead of NULL
 void MainWindow::on_pushButtonAddEdition_clicked()
 {
+    RT_TRACE_SCOPE("ui", "MainWindow::on_pushButtonAddEdition_clicked");
+
     EditionData edition_data;
 
     edition_data.book_id = ui->comboBoxBook->currentData().toInt();
@@ -143,144 +237,231 @@ void MainWindow::on_pushButtonAddEdition_clicked()
         return;
     }
 
-    int r_item_id = r_item_manager->InsertEdition(edition_data);
+    ui->pushButtonAddEdition->setEnabled(false); // Until the insert completes
 
-    if (r_item_id != -1) {
-        QMessageBox::information(this, "Success", "Edition added successfully!");
-    }
-    else {
-        QMessageBox::warning(this, "Error", "Failed to add edition.");
-    }
+    RItemManager::InsertEditionAsync(executor, edition_data).then(this, [this](int r_item_id) {
+        ui->pushButtonAddEdition->setEnabled(true);
 
-    // Clear input fields after adding the edition
-    ui->comboBoxBook->setCurrentIndex(-1);
-    ui->lineEditPublisher->clear();
-    ui->lineEditLanguage->clear();
-    ui->lineEditSeries->clear();
-    ui->spinBoxPageCount->clear();
+        if (r_item_id != -1) {
+            QMessageBox::information(this, "Success", "Edition added successfully!");
+        }
+        else {
+            QMessageBox::warning(this, "Error", "Failed to add edition.");
+        }
 
-    RefreshEditionCompleters(); // Refresh completers to include new entries
-    ui->comboBoxBook->setFocus(); // Set focus back to book combo box
+        // Clear input fields after adding the edition
+        ui->comboBoxBook->setCurrentIndex(-1);
+        ui->lineEditPublisher->clear();
+        ui->lineEditLanguage->clear();
+        ui->lineEditSeries->clear();
+        ui->spinBoxPageCount->clear();
 
-    RefreshEditionsView(); // Refresh the editions view to show the new edition
-
-    RefreshMyLibraryCompleters();
+        ui->comboBoxBook->setFocus(); // Set focus back to book combo box
+    });
 }
 
 void MainWindow::RefreshEditionCompleters()
 {
-    // Refresh combo box for books with their IDs, titles and authors
-    if (!book_manager) {
-        qCritical() << "BookManager is not initialized.";
-        return;
-    }
-    if (!publisher_manager || !language_manager || !series_manager) {
-        qCritical() << "IdNameTableManager instances are not initialized.";
-        return;
-    }
-    
-    QMap<int, QString> books = book_manager->GetAllBooks();
-    ui->comboBoxBook->clear();
-    for (auto it = books.constBegin(); it != books.constEnd(); ++it) {
-        ui->comboBoxBook->addItem(it.value(), it.key());
-    }
+    RT_TRACE_SCOPE("ui", "MainWindow::RefreshEditionCompleters");
 
     // Refresh completers for edition-related input fields
-    RefreshQCompleter(publisher_manager, ui->lineEditPublisher);
-    RefreshQCompleter(language_manager, ui->lineEditLanguage);
-    RefreshQCompleter(series_manager, ui->lineEditSeries);
+    RefreshQCompleter(IdNameTable::Publisher, ui->lineEditPublisher);
+    RefreshQCompleter(IdNameTable::Language, ui->lineEditLanguage);
+    RefreshQCompleter(IdNameTable::Series, ui->lineEditSeries);
 }
 
-void MainWindow::RefreshQCompleter(IdNameTableManager* manager, QLineEdit* lineEdit)
+void MainWindow::RefreshQCompleter(IdNameTable table, QLineEdit* lineEdit)
 {
-    if (!manager) {
-        qCritical() << "IdNameTableManager is not initialized.";
+    RT_TRACE_SCOPE("ui", "MainWindow::RefreshQCompleter");
+
+    NameCompletionIndex* index = GetNameIndex(table);
+
+    // The index is built on the database thread and swapped in whole
+    BeginLoad();
+    NameCompletionIndex::LoadAsync(reader_executor, table).then(this, [this, index, lineEdit](QFuture<NameCompletionIndex> future) {
+        RT_TRACE_SCOPE("ui", "MainWindow::RefreshQCompleter/index");
+
+        *index = future.takeResult();
+        AttachCompleter(index, lineEdit);
+        RefreshCompletionModels(index);
+        EndLoad();
+    });
+}
+
+void MainWindow::AttachCompleter(NameCompletionIndex* index, QLineEdit* lineEdit)
+{
+    // One completer per line edit, attached when its index first arrives and kept across refreshes
+    if (lineEdit->completer()) {
         return;
     }
 
-    QStringList names = manager->GetAllNames();
-    QCompleter* completer = new QCompleter(names, this);
+    QCompleter* completer = new QCompleter(lineEdit);
+    NameCompletionModel* model = new NameCompletionModel(index, NameCompletionModel::kDefaultLimit, completer);
+    completion_models.append(model);
+    connect(lineEdit, &QLineEdit::textEdited, model, &NameCompletionModel::SetQuery);
+
+    // The model already holds the matches, so the completer must not filter them again
+    completer->setModel(model);
     completer->setCaseSensitivity(Qt::CaseInsensitive);
-    completer->setCompletionMode(QCompleter::PopupCompletion);
-    completer->setFilterMode(Qt::MatchContains);
+    completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
     completer->setCompletionRole(Qt::DisplayRole);
     lineEdit->setCompleter(completer);
 }
 
-void MainWindow::RefreshEditionsView()
+NameCompletionIndex* MainWindow::GetNameIndex(IdNameTable table)
 {
-    if (!edition_manager) {
-        qCritical() << "EditionManager is not initialized.";
-        return;
-    }
-    
-    QMap<int, QString> editions = edition_manager->GetAllEditions();
-    QStandardItemModel* model = new QStandardItemModel(this);
-    model->setColumnCount(4);
-    model->setHeaderData(0, Qt::Horizontal, "Edition ID");
-    model->setHeaderData(1, Qt::Horizontal, "Title");
-    model->setHeaderData(2, Qt::Horizontal, "Publisher");
-    model->setHeaderData(3, Qt::Horizontal, "Authors");
-
-    int row = 0;
-    for (auto it = editions.constBegin(); it != editions.constEnd(); ++it) {
-        // Assuming label format: "Title - Publisher - Author1, Author2, ..."
-        QStringList parts = it.value().split(" - ");
-        QString title = parts.value(0);
-        QString publisher = parts.value(1);
-        QString authors = parts.value(2);
-
-        QStandardItem* itemEditionId = new QStandardItem(QString::number(it.key()));
-        QStandardItem* itemTitle = new QStandardItem(title);
-        QStandardItem* itemPublisher = new QStandardItem(publisher);
-        QStandardItem* itemAuthors = new QStandardItem(authors);
-
-        model->setItem(row, 0, itemEditionId);
-        model->setItem(row, 1, itemTitle);
-        model->setItem(row, 2, itemPublisher);
-        model->setItem(row, 3, itemAuthors);
-        row++;
+    // Line edits completing from the same table share its index
+    NameCompletionIndex*& index = name_indexes[table];
+    if (!index) {
+        index = new NameCompletionIndex();
     }
+    return index;
+}
 
-    ui->tableViewEditions->setModel(model);
-    ui->tableViewEditions->resizeColumnsToContents();
+void MainWindow::InsertName(IdNameTable table, const QString& name)
+{
+    RT_TRACE_SCOPE("ui", "MainWindow::InsertName");
 
-    // Hide the Edition ID column
-    ui->tableViewEditions->setColumnHidden(0, true);
+    NameCompletionIndex* index = GetNameIndex(table);
+    index->Insert(name);
+    RefreshCompletionModels(index);
 }
 
-void MainWindow::RefreshMyLibraryCompleters()
+void MainWindow::RefreshCompletionModels(const NameCompletionIndex* index)
+{
+    for (NameCompletionModel* model : std::as_const(completion_models)) {
+        if (model->GetIndex() == index) {
+            model->Refresh();
+        }
+    }
+}
+
+void MainWindow::RefreshCatalogue(bool full)
 {
-    if (!my_library_manager || !shelf_manager) {
-        qCritical() << "MyLibraryManager or ShelfManager is not initialized.";
+    RT_TRACE_SCOPE("ui", "MainWindow::RefreshCatalogue");
+
+    // Changes during a load are picked up by one more load once it is delivered
+    if (catalogue_loading) {
+        catalogue_changed = true;
+        catalogue_reset = catalogue_reset || full;
         return;
     }
 
-    QMap<int, QString> r_items = r_item_manager->GetAllRItems();
-    ui->comboBoxRItem->clear();
-    for (auto it = r_items.constBegin(); it != r_items.constEnd(); ++it) {
-        ui->comboBoxRItem->addItem(it.value(), it.key());
+    catalogue_loading = true;
+    BeginLoad();
+    CatalogueSnapshot::LoadAsync(reader_executor, full ? nullptr : catalogue)
+        .then(this, [this](QSharedPointer<const CatalogueSnapshot> loaded) {
+            RT_TRACE_SCOPE("ui", "MainWindow::RefreshCatalogue/snapshot");
+
+            catalogue_loading = false;
+            if (loaded) {
+                catalogue = loaded;
+                book_list_model->SetCatalogue(catalogue);
+                r_item_list_model->SetCatalogue(catalogue);
+                edition_filter->SetCatalogue(catalogue);
+            }
+
+            if (catalogue_changed) {
+                bool full = catalogue_reset;
+                catalogue_changed = false;
+                catalogue_reset = false;
+                RefreshCatalogue(full);
+            }
+            EndLoad();
+        });
+}
+
+void MainWindow::ApplyChanges(const QList<ChangeEvent>& events)
+{
+    RT_TRACE_SCOPE("ui", "MainWindow::ApplyChanges");
+
+    bool catalogue_appended = false;
+    bool editions_appended = false;
+    bool r_items_appended = false;
+
+    for (const ChangeEvent& event : events) {
+        switch (event.type) {
+        case ChangeType::BookInserted:
+            catalogue_appended = true;
+            break;
+        case ChangeType::EditionInserted:
+            catalogue_appended = true;
+            editions_appended = true;
+            break;
+        case ChangeType::RItemInserted:
+            catalogue_appended = true;
+            r_items_appended = true;
+            break;
+        case ChangeType::NameInserted:
+            InsertName(event.table, event.name);
+            break;
+        case ChangeType::MyLibraryInserted:
+            break; // MyLibrary items are not listed yet
+        case ChangeType::Reset:
+            RefreshAll();
+            return;
+        }
+    }
+
+    // New rows have the highest IDs, the snapshot appends them and the lazy models fetch them as their next page
+    if (catalogue_appended) {
+        RefreshCatalogue(false);
+    }
+    if (editions_appended) {
+        edition_model->FetchAppended();
     }
+    if (r_items_appended) {
+        r_item_model->FetchAppended();
+    }
+}
+
+void MainWindow::RefreshAll()
+{
+    RT_TRACE_SCOPE("ui", "MainWindow::RefreshAll");
+
+    RefreshCatalogue(true);
+
+    RefreshBookCompleters();
+
+    RefreshEditionCompleters();
+    RefreshEditionsView();
+
+    RefreshMyLibraryCompleters();
+    RefreshRItemsView();
+}
+
+void MainWindow::RefreshEditionsView()
+{
+    RT_TRACE_SCOPE("ui", "MainWindow::RefreshEditionsView");
+
+    // An active filter shows the matches of the new snapshot instead
+    if (!edition_filter->IsActive()) {
+        BeginLoad();
+        connect(edition_model, &EditionTableModel::PageLoaded, this, &MainWindow::EndLoad, Qt::SingleShotConnection);
+        edition_model->Reload();
+    }
+}
+
+void MainWindow::RefreshMyLibraryCompleters()
+{
+    RT_TRACE_SCOPE("ui", "MainWindow::RefreshMyLibraryCompleters");
 
     // Refresh completers for MyLibrary-related input fields
-    RefreshQCompleter(acquired_from_manager, ui->lineEditAcquiredFrom);
-    RefreshQCompleter(shelf_manager, ui->lineEditShelfName);
+    RefreshQCompleter(IdNameTable::AcquiredFrom, ui->lineEditAcquiredFrom);
+    RefreshQCompleter(IdNameTable::Shelf, ui->lineEditShelfName);
 }
 
 /// @todo Add QMessageBox to inform user about success or failure
 /// @todo Edit input fields for more user-friendly experience
 void MainWindow::on_pushButtonAddMyLibrary_clicked()
 {
-    if (!my_library_manager) {
-        qCritical() << "MyLibraryManager is not initialized.";
-        return;
-    }
+    RT_TRACE_SCOPE("ui", "MainWindow::on_pushButtonAddMyLibrary_clicked");
 
     MyLibraryData item_data;
 
-    // Get the selected RItem
+    // Get the selected RItem, InsertRItem checks that it exists
     item_data.r_item_id = ui->comboBoxRItem->currentData().toInt();
-    if (!r_item_manager->RItemExists(item_data.r_item_id)) {
+    if (item_data.r_item_id <= 0) {
         qCritical() << "Invalid RItem selected.";
         return;
     }
@@ -296,42 +477,123 @@ void MainWindow::on_pushButtonAddMyLibrary_clicked()
 
     item_data.notes = ui->lineEditNotes->text();
 
-    // Add the RItem to the MyLibrary
-    my_library_manager->InsertRItem(item_data);
-
-    RefreshMyLibraryCompleters(); // Refresh completers to include new entries
+    // Add the RItem to the MyLibrary, new names reach the completers as change events
+    MyLibraryManager::InsertRItemAsync(executor, item_data);
 }
 
 void MainWindow::RefreshRItemsView()
 {
-    if (!r_item_manager) {
-        qCritical() << "RItemManager is not initialized.";
+    RT_TRACE_SCOPE("ui", "MainWindow::RefreshRItemsView");
+
+    BeginLoad();
+    connect(r_item_model, &RItemListModel::PageLoaded, this, &MainWindow::EndLoad, Qt::SingleShotConnection);
+    r_item_model->Reload();
+}
+
+
+void MainWindow::on_pushButtonAddEdition_2_clicked()
+{
+    RT_TRACE_SCOPE("ui", "MainWindow::on_pushButtonAddEdition_2_clicked");
+
+    AddEdition dialog(this);
+    dialog.exec();
+}
+
+void MainWindow::on_actionImportLibrary_triggered()
+{
+    RT_TRACE_SCOPE("ui", "MainWindow::on_actionImportLibrary_triggered");
+
+    QString path = QFileDialog::getOpenFileName(this, "Import Library", QString(),
+                                                "Library exports (*.csv *.tsv *.json *.jsonl);;All files (*)");
+    if (path.isEmpty()) {
         return;
     }
 
-    QMap<int, QString> r_items = r_item_manager->GetAllRItems();
-    QStandardItemModel* model = new QStandardItemModel(this);
-    model->setColumnCount(2);
-    model->setHeaderData(0, Qt::Horizontal, "RItem ID");
-    model->setHeaderData(1, Qt::Horizontal, "Label");
+    ui->actionImportLibrary->setEnabled(false); // Until the import completes
+
+    // Progress is reported on the database thread, which the executor joins before the window goes away
+    auto progress = [this](const ImportProgress& state) {
+        QString message = QString("Importing: %1 books, %2 skipped").arg(state.books_imported).arg(state.records_skipped);
+        QMetaObject::invokeMethod(this, [this, message]() {
+            ui->statusbar->showMessage(message);
+        });
+        return true;
+    };
+
+    LibraryImporter::ImportFileAsync(executor, path, ImportOptions(), progress).then(this, [this](int imported) {
+        ui->actionImportLibrary->setEnabled(true);
+        ui->statusbar->clearMessage();
+
+        if (imported != -1) {
+            QMessageBox::information(this, "Success", QString("Imported %1 books.").arg(imported));
+        }
+        else {
+            QMessageBox::warning(this, "Error", "Failed to import the library.");
+        }
+    });
+}
 
-    int row = 0;
-    for (auto it = r_items.constBegin(); it != r_items.constEnd(); ++it) {
-        QStandardItem* itemRItemId = new QStandardItem(QString::number(it.key()));
-        QStandardItem* itemLabel = new QStandardItem(it.value());
+void MainWindow::on_actionImportCalibre_triggered()
+{
+    RT_TRACE_SCOPE("ui", "MainWindow::on_actionImportCalibre_triggered");
 
-        model->setItem(row, 0, itemRItemId);
-        model->setItem(row, 1, itemLabel);
-        row++;
+    QString path = QFileDialog::getOpenFileName(this, "Import Calibre Library", QString(),
+                                                "Calibre library (metadata.db)");
+    if (path.isEmpty()) {
+        return;
     }
 
-    ui->listViewRItems->setModel(model);
-}
+    ui->actionImportCalibre->setEnabled(false); // Until the import completes
+    ui->statusbar->showMessage("Importing the Calibre library...");
 
+    CalibreImporter::ImportAsync(executor, path).then(this, [this](int imported) {
+        ui->actionImportCalibre->setEnabled(true);
+        ui->statusbar->clearMessage();
 
-void MainWindow::on_pushButtonAddEdition_2_clicked()
+        if (imported != -1) {
+            QMessageBox::information(this, "Success", QString("Imported %1 books.").arg(imported));
+        }
+        else {
+            QMessageBox::warning(this, "Error", "Failed to import the Calibre library.");
+        }
+    });
+}
+
+void MainWindow::on_actionSaveQueryStats_triggered()
 {
-    AddEdition dialog(this);
-    dialog.exec();
+    QString path = QFileDialog::getSaveFileName(this, "Save Query Statistics", "query_stats.txt",
+                                                "Text files (*.txt);;All files (*)");
+    if (path.isEmpty()) {
+        return;
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)
+        || file.write(connection_pool->GetQueryProfiler()->Report().toUtf8()) == -1
+        || !file.commit()) {
+        QMessageBox::warning(this, "Error", "Failed to save the query statistics: " + file.errorString());
+    }
 }
 
+void MainWindow::on_actionRecordTrace_toggled(bool checked)
+{
+    Tracer& tracer = Tracer::Instance();
+    if (checked) {
+        tracer.Start();
+        ui->statusbar->showMessage("Recording a trace...");
+        return;
+    }
+
+    tracer.Stop();
+    ui->statusbar->clearMessage();
+
+    QString path = QFileDialog::getSaveFileName(this, "Save Trace", "trace.json",
+                                                "Chrome trace (*.json);;All files (*)");
+    if (path.isEmpty()) {
+        return;
+    }
+
+    if (tracer.WriteChromeTrace(path) == -1) {
+        QMessageBox::warning(this, "Error", "Failed to save the trace.");
+    }
+}
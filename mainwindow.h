@@ -1,10 +1,18 @@
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
-#include "mylibrarymanager.h"
+#include "cataloguesnapshot.h"
 
 #include <QMainWindow>
 #include <QLineEdit>
+#include <QElapsedTimer>
+
+class CatalogueListModel;
+class EditionTableModel;
+class EditionFilter;
+class RItemListModel;
+class NameCompletionIndex;
+class NameCompletionModel;
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -17,9 +25,18 @@ class MainWindow : public QMainWindow
     Q_OBJECT
 
 public:
-    MainWindow(QWidget *parent = nullptr);
+    /**
+     * @brief Builds the window. Its data is loaded in the background once it has been painted.
+     *
+     * @param parent Parent widget.
+     * @param startup_timer Timer started with the process, reports time to first paint and to interactive. Started here if invalid.
+     */
+    MainWindow(QWidget *parent = nullptr, const QElapsedTimer& startup_timer = QElapsedTimer());
     ~MainWindow();
 
+protected:
+    bool event(QEvent* event) override; ///< Starts the initial load once the window has been painted.
+
 private slots:
     void on_pushButtonAddBook_clicked();
     void on_pushButtonAddEdition_clicked();
@@ -27,26 +44,61 @@ private slots:
 
     void on_pushButtonAddEdition_2_clicked();
 
+    void on_actionImportLibrary_triggered(); ///< Imports a CSV or JSON library export chosen by the user.
+
+    void on_actionImportCalibre_triggered(); ///< Imports a Calibre library chosen by the user.
+
+    void on_actionSaveQueryStats_triggered(); ///< Saves the statement statistics of the session to a file chosen by the user.
+
+    void on_actionRecordTrace_toggled(bool checked); ///< Starts recording a trace, or stops and saves it to a file chosen by the user.
+
+    void ApplyChanges(const QList<ChangeEvent>& events); ///< Applies committed database changes to the views and completers.
+
 private:
     Ui::MainWindow *ui;
-    IdNameTableManager* author_manager; ///< Pointer to the IdNameTableManager instance for authors.
-    IdNameTableManager* language_manager; ///< Pointer to the IdNameTableManager instance for languages.
-    IdNameTableManager* country_manager; ///< Pointer to the IdNameTableManager instance for countries.
-    IdNameTableManager* genre_manager; ///< Pointer to the IdNameTableManager instance for genres.
-    BookManager* book_manager; ///< Pointer to the BookManager instance.
-    IdNameTableManager* publisher_manager; ///< Pointer to the IdNameTableManager instance for publishers.
-    IdNameTableManager* series_manager; ///< Pointer to the IdNameTableManager instance for series.
-    EditionManager* edition_manager; ///< Pointer to the EditionManager instance.
-    RItemManager* r_item_manager; ///< Pointer to the RItemManager instance.
-    IdNameTableManager* acquired_from_manager; ///< Pointer to the IdNameTableManager instance for acquired_from.
-    IdNameTableManager* shelf_manager; ///< Pointer to the IdNameTableManager instance for shelves.
-    MyLibraryManager* my_library_manager; ///< Pointer to the MyLibraryManager instance.
+    DatabaseConnectionPool* connection_pool; ///< Per-thread connections to the application database.
+    DatabaseExecutor* executor; ///< Runs inserts and imports on the database writer thread.
+    DatabaseExecutor* reader_executor; ///< Runs the list, page, snapshot and completion queries on a read-only connection.
+    EditionTableModel* edition_model; ///< Lazily filled model of the editions view.
+    EditionFilter* edition_filter; ///< Live filter of the editions view.
+    RItemListModel* r_item_model; ///< Lazily filled model of the readable items view.
+    QSharedPointer<const CatalogueSnapshot> catalogue; ///< Snapshot shared by the combo boxes and the edition filter.
+    CatalogueListModel* book_list_model; ///< Books of the snapshot, listed in the book combo box.
+    CatalogueListModel* r_item_list_model; ///< Readable items of the snapshot, listed in the MyLibrary combo box.
+    QMap<IdNameTable, NameCompletionIndex*> name_indexes; ///< Completion indexes by lookup table.
+    QList<NameCompletionModel*> completion_models; ///< Completion models of the line edits, owned by their completers.
+    QElapsedTimer startup_timer; ///< Started with the process, measures the startup times.
+    qint64 first_paint_ms; ///< Time to first paint, -1 until the window has been painted.
+    bool initial_load_started; ///< Whether the first refresh has been issued.
+    bool interactive; ///< Whether every load of the first refresh has been delivered.
+    int pending_loads; ///< Loads issued by refreshes that have not been delivered yet.
+    bool catalogue_loading; ///< Whether a snapshot load is in flight.
+    bool catalogue_changed; ///< Whether the catalogue changed while a snapshot was loading.
+    bool catalogue_reset; ///< Whether the next snapshot must be loaded in full.
+
+    void StartInitialLoad(); ///< Issues the first refresh, after the first paint.
+
+    void BeginLoad(); ///< Counts a load issued by a refresh.
+
+    void EndLoad(); ///< Counts a delivered load and reports the time to interactive once the first refresh is complete.
+
+    void RefreshAll(); ///< Reloads every view, combo box and completer.
 
     void RefreshBookCompleters(); ///< Refreshes the completers for input fields.
 
     void RefreshEditionCompleters(); ///< Refreshes the completers for edition-related input fields.
 
-    void RefreshQCompleter(IdNameTableManager* manager, QLineEdit* lineEdit); ///< Refreshes a specific completer for a given IdNameTableManager and QLineEdit.
+    void RefreshQCompleter(IdNameTable table, QLineEdit* lineEdit); ///< Refreshes a specific completer for a given ID-Name table and QLineEdit.
+
+    void AttachCompleter(NameCompletionIndex* index, QLineEdit* lineEdit); ///< Gives a line edit a completer over an index, unless it has one.
+
+    NameCompletionIndex* GetNameIndex(IdNameTable table); ///< Returns the completion index of a table, creating it on first use.
+
+    void InsertName(IdNameTable table, const QString& name); ///< Inserts a name into the completion index of a table.
+
+    void RefreshCompletionModels(const NameCompletionIndex* index); ///< Queries the completion models of an index again.
+
+    void RefreshCatalogue(bool full); ///< Loads the snapshot again, in full or only the rows added since the current one.
 
     void RefreshEditionsView(); ///< Refreshes the editions view in the UI.
 
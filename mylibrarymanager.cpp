@@ -1,14 +1,20 @@
 #include "mylibrarymanager.h"
+#include "databaseexecutor.h"
+#include "tracer.h"
 
-MyLibraryManager::MyLibraryManager(DatabaseManager* db_manager, IdNameTableManager* shelf_manager, RItemManager* r_item_manager)
-    : database_manager(db_manager), shelf_manager(shelf_manager), r_item_manager(r_item_manager)
+MyLibraryManager::MyLibraryManager(DatabaseManager* db_manager,
+                                   IdNameTableManager* acquired_from_manager,
+                                   IdNameTableManager* shelf_manager,
+                                   RItemManager* r_item_manager)
+    : database_manager(db_manager),
+      acquired_from_manager(acquired_from_manager),
+      shelf_manager(shelf_manager),
+      r_item_manager(r_item_manager)
 {
     if (!database_manager || !database_manager->GetDatabase().isOpen()) {
         qCritical() << "Database connection is not valid or open.";
         return; // Database error
     }
-
-    CreateMyLibraryTable();
 }
 
 MyLibraryManager::~MyLibraryManager()
@@ -18,6 +24,8 @@ MyLibraryManager::~MyLibraryManager()
 
 int MyLibraryManager::InsertRItem(const MyLibraryData& item_data)
 {
+    RT_TRACE_SCOPE("db", "MyLibraryManager::InsertRItem");
+
     if (!database_manager || !database_manager->GetDatabase().isOpen()) {
         qCritical() << "Database connection is not valid or open.";
         return -1; // Database error
@@ -29,60 +37,45 @@ int MyLibraryManager::InsertRItem(const MyLibraryData& item_data)
         return -1; // Invalid data
     }
 
-    QSqlDatabase db = database_manager->GetDatabase();
-    QSqlQuery query(db);
+    QSqlQuery* query = database_manager->GetCachedQuery("INSERT INTO MyLibrary (r_item_id, acquired_from_id, acquired_date, price, shelf_id, notes) "
+                                                        "VALUES (:r_item_id, :acquired_from_id, :acquired_date, :price, :shelf_id, :notes)");
+    if (!query) {
+        return -1; // Database error
+    }
 
-    query.prepare("INSERT INTO MyLibrary (r_item_id, acquired_from_id, acquired_date, price, shelf_id, notes) "
-                  "VALUES (:r_item_id, :acquired_from_id, :acquired_date, :price, :shelf_id, :notes)");
-    query.bindValue(":r_item_id", item_data.r_item_id);
+    query->bindValue(":r_item_id", item_data.r_item_id);
     int acquired_from_id = acquired_from_manager->InsertIfNotExists(item_data.acquired_from.trimmed());
     if(acquired_from_id == -1) {
-        query.bindValue(":acquired_from_id", QVariant(QVariant::Int)); // Will be NULL in SQL
+        query->bindValue(":acquired_from_id", QVariant(QVariant::Int)); // Will be NULL in SQL
     }
     else {
-        query.bindValue(":acquired_from_id", acquired_from_id);
+        query->bindValue(":acquired_from_id", acquired_from_id);
     }
-    query.bindValue(":acquired_date", item_data.acquired_date.isNull() ? QVariant(QVariant::DateTime) : item_data.acquired_date);
-    query.bindValue(":price", (item_data.price == 0.0) ? QVariant(QVariant::Double) : item_data.price);
+    query->bindValue(":acquired_date", item_data.acquired_date.isNull() ? QVariant(QVariant::DateTime) : item_data.acquired_date);
+    query->bindValue(":price", (item_data.price == 0.0) ? QVariant(QVariant::Double) : item_data.price);
     int shelf_id = shelf_manager->InsertIfNotExists(item_data.shelf_name);
     if(shelf_id == -1) {
-        query.bindValue(":shelf_id", QVariant(QVariant::Int)); // Will be NULL in SQL
+        query->bindValue(":shelf_id", QVariant(QVariant::Int)); // Will be NULL in SQL
     }
     else {
-        query.bindValue(":shelf_id", shelf_id);
+        query->bindValue(":shelf_id", shelf_id);
     }
-    query.bindValue(":notes", item_data.notes.trimmed().isEmpty() ? QVariant(QVariant::String) : item_data.notes);
+    query->bindValue(":notes", item_data.notes.trimmed().isEmpty() ? QVariant(QVariant::String) : item_data.notes);
 
-    if (!query.exec()) {
-        qCritical() << "Failed to insert MyLibrary data:" << query.lastError().text();
+    if (!database_manager->Exec(query)) {
+        qCritical() << "Failed to insert MyLibrary data:" << query->lastError().text();
         return -1; // Insertion failed
     }
 
-    return query.lastInsertId().toInt(); // Return the MyLibrary ID of the inserted item
+    int my_library_id = query->lastInsertId().toInt();
+    database_manager->PublishChange(ChangeEvent{ChangeType::MyLibraryInserted, my_library_id, QString()});
+
+    return my_library_id; // Return the MyLibrary ID of the inserted item
 }
 
-void MyLibraryManager::CreateMyLibraryTable()
+QFuture<int> MyLibraryManager::InsertRItemAsync(DatabaseExecutor* executor, const MyLibraryData& item_data)
 {
-    if (!database_manager || !database_manager->GetDatabase().isOpen()) {
-        qCritical() << "Database connection is not valid or open.";
-        return; // Database error
-    }
-
-    QSqlDatabase db = database_manager->GetDatabase();
-    QSqlQuery query(db);
-
-    // Create the MyLibrary table if it does not exist
-    query.exec("CREATE TABLE IF NOT EXISTS MyLibrary ("
-               "id INTEGER PRIMARY KEY AUTOINCREMENT, "
-               "r_item_id INTEGER NOT NULL, "
-               "acquired_from_id INTEGER, "
-               "acquired_date DATETIME, "
-               "price FLOAT, "
-               "shelf_id INTEGER, "
-               "created_at DATETIME DEFAULT CURRENT_TIMESTAMP, "
-               "notes TEXT, "
-               "FOREIGN KEY(r_item_id) REFERENCES RItem(id), "
-               "FOREIGN KEY(shelf_id) REFERENCES Shelf(id), "
-               "FOREIGN KEY(acquired_from_id) REFERENCES AcquiredFrom(id)"
-               ")");
+    return executor->Run([item_data](Library& library) {
+        return library.my_library_manager->InsertRItem(item_data);
+    });
 }
@@ -24,13 +24,17 @@ class MyLibraryManager
 {
 public:
     /**
-     * @brief Constructs a MyLibraryManager object and initializes the library table.
+     * @brief Constructs a MyLibraryManager object.
      * 
      * @param db_manager Pointer to the DatabaseManager instance.
+     * @param acquired_from_manager Pointer to the IdNameTableManager instance for acquired_from.
      * @param shelf_manager Pointer to the IdNameTableManager instance for shelves.
      * @param r_item_manager Pointer to the RItemManager instance.
      */
-    MyLibraryManager(DatabaseManager* db_manager, IdNameTableManager* shelf_manager, RItemManager* r_item_manager);
+    MyLibraryManager(DatabaseManager* db_manager,
+                     IdNameTableManager* acquired_from_manager,
+                     IdNameTableManager* shelf_manager,
+                     RItemManager* r_item_manager);
 
     ~MyLibraryManager(); ///< Destructor
 
@@ -43,13 +47,20 @@ public:
      */
     int InsertRItem(const MyLibraryData& item_data);
 
+    /**
+     * @brief Inserts a new item into the library on the database worker thread.
+     * 
+     * @param executor The executor to run the insert on.
+     * @param item_data The data of the item to insert.
+     * @return QFuture<int> The MyLibrary ID of the inserted item, or -1 on failure.
+     */
+    static QFuture<int> InsertRItemAsync(DatabaseExecutor* executor, const MyLibraryData& item_data);
+
 private:
     DatabaseManager* database_manager; ///< Pointer to the DatabaseManager instance.
     IdNameTableManager* acquired_from_manager; ///< Pointer to the IdNameTableManager instance for acquired_from.
     IdNameTableManager* shelf_manager; ///< Pointer to the IdNameTableManager instance for shelves.
     RItemManager* r_item_manager; ///< Pointer to the RItemManager instance.
-
-    void CreateMyLibraryTable(); ///< Creates the MyLibrary table in the database.
 };
 
 #endif // MY_LIBRARY_MANAGER_H
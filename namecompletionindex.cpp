@@ -0,0 +1,233 @@
+#include "namecompletionindex.h"
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+NameCompletionIndex::NameCompletionIndex()
+{
+}
+
+void NameCompletionIndex::Reset(const QStringList& new_names)
+{
+    names.clear();
+    sorted_ids.clear();
+    bigram_postings.clear();
+    postings.clear();
+
+    QVector<QString> folded_names;
+    folded_names.reserve(new_names.size());
+    names.reserve(new_names.size());
+    for (const QString& name : new_names) {
+        folded_names.append(name.toCaseFolded());
+        names.append(name);
+        IndexGrams(names.size() - 1, folded_names.constLast());
+    }
+
+    // Folded once here, the lookups fold only the names they compare
+    sorted_ids.resize(names.size());
+    std::iota(sorted_ids.begin(), sorted_ids.end(), 0);
+    std::sort(sorted_ids.begin(), sorted_ids.end(), [&folded_names](int a, int b) {
+        return folded_names.at(a) < folded_names.at(b) || (folded_names.at(a) == folded_names.at(b) && a < b);
+    });
+}
+
+void NameCompletionIndex::Insert(const QString& name)
+{
+    int id = names.size();
+    names.append(name);
+
+    const QString folded = name.toCaseFolded();
+    IndexGrams(id, folded);
+
+    // The new ID is the highest, so it goes after the names that fold the same
+    auto position = std::upper_bound(sorted_ids.cbegin(), sorted_ids.cend(), folded, [this](const QString& value, int other) {
+        return value < names.at(other).toCaseFolded();
+    });
+    sorted_ids.insert(position - sorted_ids.cbegin(), id);
+}
+
+QStringList NameCompletionIndex::Find(const QString& query, int limit) const
+{
+    QStringList matches;
+    if (limit <= 0) {
+        return matches;
+    }
+
+    const QString folded = query.toCaseFolded();
+
+    // Names starting with the query are adjacent in the sorted IDs
+    auto it = std::lower_bound(sorted_ids.cbegin(), sorted_ids.cend(), folded, [this](int id, const QString& value) {
+        return names.at(id).toCaseFolded() < value;
+    });
+    for (; it != sorted_ids.cend() && matches.size() < limit && StartsWith(*it, folded); ++it) {
+        matches.append(names.at(*it));
+    }
+    if (matches.size() == limit || folded.isEmpty()) {
+        return matches;
+    }
+
+    // Every name starting with the query is listed by now, the others follow
+    auto accept = [&](int id) {
+        if (!StartsWith(id, folded)) {
+            matches.append(names.at(id));
+        }
+        return matches.size() < limit;
+    };
+
+    if (folded.size() == 1) {
+        // The names containing a character are those of the bigrams it starts,
+        // merged in index ID order
+        using Cursor = std::pair<QVector<int>::const_iterator, QVector<int>::const_iterator>;
+        QVector<Cursor> cursors;
+        const quint32 first = Bigram(folded.at(0), QChar());
+        const quint32 last = first | 0xFFFF;
+        for (auto list = bigram_postings.lowerBound(first); list != bigram_postings.cend() && list.key() <= last; ++list) {
+            cursors.append({list.value().cbegin(), list.value().cend()});
+        }
+
+        auto later = [](const Cursor& a, const Cursor& b) {
+            return *a.first > *b.first;
+        };
+        std::make_heap(cursors.begin(), cursors.end(), later);
+
+        int previous_id = -1;
+        while (!cursors.isEmpty()) {
+            std::pop_heap(cursors.begin(), cursors.end(), later);
+            Cursor& cursor = cursors.last();
+            int id = *cursor.first;
+            if (++cursor.first == cursor.second) {
+                cursors.removeLast();
+            }
+            else {
+                std::push_heap(cursors.begin(), cursors.end(), later);
+            }
+
+            // A name containing the character several times is in several lists
+            if (id != previous_id) {
+                previous_id = id;
+                if (!accept(id)) {
+                    break;
+                }
+            }
+        }
+    }
+    else if (folded.size() == 2) {
+        // A bigram is the whole query, every name in its list contains it
+        auto list = bigram_postings.constFind(Bigram(folded.at(0), folded.at(1)));
+        if (list != bigram_postings.cend()) {
+            for (int id : list.value()) {
+                if (!accept(id)) {
+                    break;
+                }
+            }
+        }
+    }
+    else {
+        // Walk the shortest posting list and probe the others
+        QVector<const QVector<int>*> lists;
+        const QVector<quint64> trigrams = Trigrams(folded);
+        for (quint64 trigram : trigrams) {
+            auto list = postings.constFind(trigram);
+            if (list == postings.constEnd()) {
+                return matches; // No name contains this trigram
+            }
+            lists.append(&list.value());
+        }
+        std::sort(lists.begin(), lists.end(), [](const QVector<int>* a, const QVector<int>* b) {
+            return a->size() < b->size();
+        });
+
+        for (int id : *lists.first()) {
+            bool candidate = true;
+            for (int i = 1; i < lists.size() && candidate; ++i) {
+                candidate = std::binary_search(lists.at(i)->cbegin(), lists.at(i)->cend(), id);
+            }
+
+            // Sharing the trigrams does not guarantee they appear in order
+            if (candidate && names.at(id).toCaseFolded().contains(folded) && !accept(id)) {
+                break;
+            }
+        }
+    }
+
+    return matches;
+}
+
+int NameCompletionIndex::Size() const
+{
+    return names.size();
+}
+
+QFuture<NameCompletionIndex> NameCompletionIndex::LoadAsync(DatabaseExecutor* executor, IdNameTable table)
+{
+    return executor->Run([table](Library& library) {
+        NameCompletionIndex index;
+        index.Reset(library.GetIdNameTableManager(table)->GetAllNames());
+        return index;
+    });
+}
+
+void NameCompletionIndex::IndexGrams(int id, const QString& folded)
+{
+    // IDs only grow, so appending keeps every posting list sorted
+    const QVector<quint32> bigrams = Bigrams(folded);
+    for (quint32 bigram : bigrams) {
+        bigram_postings[bigram].append(id);
+    }
+
+    const QVector<quint64> trigrams = Trigrams(folded);
+    for (quint64 trigram : trigrams) {
+        postings[trigram].append(id);
+    }
+}
+
+bool NameCompletionIndex::StartsWith(int id, const QString& folded) const
+{
+    return names.at(id).toCaseFolded().startsWith(folded);
+}
+
+quint32 NameCompletionIndex::Bigram(QChar first, QChar second)
+{
+    return (quint32(first.unicode()) << 16) | quint32(second.unicode());
+}
+
+QVector<quint32> NameCompletionIndex::Bigrams(const QString& folded)
+{
+    QVector<quint32> bigrams;
+    if (folded.isEmpty()) {
+        return bigrams;
+    }
+
+    bigrams.reserve(folded.size());
+    for (int i = 0; i + 1 < folded.size(); ++i) {
+        bigrams.append(Bigram(folded.at(i), folded.at(i + 1)));
+    }
+    bigrams.append(Bigram(folded.at(folded.size() - 1), QChar())); // End marker, names contain no NUL
+
+    std::sort(bigrams.begin(), bigrams.end());
+    bigrams.erase(std::unique(bigrams.begin(), bigrams.end()), bigrams.end());
+    return bigrams;
+}
+
+quint64 NameCompletionIndex::Trigram(const QChar* chars)
+{
+    return (quint64(chars[0].unicode()) << 32) | (quint64(chars[1].unicode()) << 16) | quint64(chars[2].unicode());
+}
+
+QVector<quint64> NameCompletionIndex::Trigrams(const QString& folded)
+{
+    QVector<quint64> trigrams;
+    if (folded.size() < 3) {
+        return trigrams;
+    }
+
+    trigrams.reserve(folded.size() - 2);
+    for (int i = 0; i + 3 <= folded.size(); ++i) {
+        trigrams.append(Trigram(folded.constData() + i));
+    }
+
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    return trigrams;
+}
@@ -0,0 +1,96 @@
+#ifndef NAME_COMPLETION_INDEX_H
+#define NAME_COMPLETION_INDEX_H
+
+#include "databaseexecutor.h"
+
+#include <QHash>
+#include <QMap>
+#include <QVector>
+
+/**
+ * @file namecompletionindex.h
+ * @brief Header file for NameCompletionIndex class.
+ *
+ * NameCompletionIndex answers case-insensitive "contains" queries over the
+ * names of one lookup table. Names starting with the query are found by
+ * binary search in the names sorted by their case-folded text. The others
+ * come from the names containing the query's bigram, or every one of its
+ * trigrams, so no query scans the whole table.
+ */
+
+/**
+ * @class NameCompletionIndex
+ * @brief Trigram index over the names of a lookup table.
+ *
+ * Names are kept once, in the order they were added. Each posting list
+ * holds the index IDs of the names containing a case-folded bigram or
+ * trigram; the last character of a name also forms a bigram with an end
+ * marker, so every character of a name starts one of its bigrams.
+ */
+class NameCompletionIndex
+{
+public:
+    /**
+     * @brief Constructs an empty index.
+     */
+    NameCompletionIndex();
+
+    /**
+     * @brief Replaces the indexed names.
+     * 
+     * @param names The names to index, in the order results not starting with the query should prefer.
+     */
+    void Reset(const QStringList& names);
+
+    /**
+     * @brief Adds a name to the index.
+     * 
+     * @param name The name to add, which must not be indexed yet.
+     */
+    void Insert(const QString& name);
+
+    /**
+     * @brief Finds the names containing the query, ignoring case.
+     *
+     * Names starting with the query are listed first, ordered by their
+     * case-folded text, then the others in the order they were added. The
+     * search stops as soon as limit names are found.
+     * 
+     * @param query Text the names must contain, an empty query matches every name.
+     * @param limit Maximum number of names to return.
+     * @return QStringList The matching names.
+     */
+    QStringList Find(const QString& query, int limit) const;
+
+    /**
+     * @brief Returns the number of indexed names.
+     * 
+     * @return int The number of names.
+     */
+    int Size() const;
+
+    /**
+     * @brief Loads the names of a lookup table and indexes them on the database worker thread.
+     * 
+     * @param executor The executor to run the query on.
+     * @param table The lookup table.
+     * @return QFuture<NameCompletionIndex> The index of the table's names.
+     */
+    static QFuture<NameCompletionIndex> LoadAsync(DatabaseExecutor* executor, IdNameTable table);
+
+private:
+    QVector<QString> names; ///< Indexed names, the position is the name's index ID
+    QVector<int> sorted_ids; ///< Index IDs ordered by case-folded name, then index ID
+    QMap<quint32, QVector<int>> bigram_postings; ///< Ascending index IDs of the names containing each bigram, ordered so a character's bigrams are adjacent
+    QHash<quint64, QVector<int>> postings; ///< Ascending index IDs of the names containing each trigram
+
+    void IndexGrams(int id, const QString& folded); ///< Appends a new name to the posting lists of its bigrams and trigrams
+    bool StartsWith(int id, const QString& folded) const; ///< Whether a name starts with a case-folded query
+
+    static quint32 Bigram(QChar first, QChar second); ///< Packs two case-folded characters into a key
+    static QVector<quint32> Bigrams(const QString& folded); ///< Distinct bigrams of a case-folded text, with the end marker
+    static quint64 Trigram(const QChar* chars); ///< Packs three case-folded characters into a key
+    static QVector<quint64> Trigrams(const QString& folded); ///< Distinct trigrams of a case-folded text
+};
+
+#endif // NAME_COMPLETION_INDEX_H
@@ -0,0 +1,44 @@
+#include "namecompletionmodel.h"
+
+NameCompletionModel::NameCompletionModel(const NameCompletionIndex* index, int limit, QObject* parent)
+    : QAbstractListModel(parent),
+      index(index),
+      limit(limit)
+{
+}
+
+int NameCompletionModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : matches.size();
+}
+
+QVariant NameCompletionModel::data(const QModelIndex& model_index, int role) const
+{
+    if (!model_index.isValid() || model_index.row() >= matches.size()) {
+        return QVariant();
+    }
+
+    if (role == Qt::DisplayRole || role == Qt::EditRole) {
+        return matches.at(model_index.row());
+    }
+
+    return QVariant();
+}
+
+const NameCompletionIndex* NameCompletionModel::GetIndex() const
+{
+    return index;
+}
+
+void NameCompletionModel::SetQuery(const QString& new_query)
+{
+    query = new_query;
+    Refresh();
+}
+
+void NameCompletionModel::Refresh()
+{
+    beginResetModel();
+    matches = index->Find(query, limit);
+    endResetModel();
+}
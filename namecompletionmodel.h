@@ -0,0 +1,67 @@
+#ifndef NAME_COMPLETION_MODEL_H
+#define NAME_COMPLETION_MODEL_H
+
+#include "namecompletionindex.h"
+
+#include <QAbstractListModel>
+
+/**
+ * @file namecompletionmodel.h
+ * @brief Header file for NameCompletionModel class.
+ *
+ * NameCompletionModel exposes the top matches of a NameCompletionIndex for
+ * the text typed into a line edit. It is meant for a QCompleter in
+ * UnfilteredPopupCompletion mode, which shows the rows as they are.
+ */
+
+/**
+ * @class NameCompletionModel
+ * @brief List model of the names matching the current completion query.
+ */
+class NameCompletionModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    static constexpr int kDefaultLimit = 20; ///< Default number of names shown in the popup
+
+    /**
+     * @brief Constructs an empty model over an index.
+     * 
+     * @param index The index to query, must outlive the model.
+     * @param limit Maximum number of names in the model.
+     * @param parent Parent QObject.
+     */
+    NameCompletionModel(const NameCompletionIndex* index, int limit = kDefaultLimit, QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    /**
+     * @brief Returns the index the model queries.
+     * 
+     * @return const NameCompletionIndex* The index.
+     */
+    const NameCompletionIndex* GetIndex() const;
+
+public slots:
+    /**
+     * @brief Replaces the rows with the names matching a new query.
+     * 
+     * @param query The text typed so far.
+     */
+    void SetQuery(const QString& query);
+
+    /**
+     * @brief Queries the index again, after it changed.
+     */
+    void Refresh();
+
+private:
+    const NameCompletionIndex* index; ///< Index the names come from
+    int limit; ///< Maximum number of names in the model
+    QString query; ///< Current query
+    QStringList matches; ///< Names matching the current query
+};
+
+#endif // NAME_COMPLETION_MODEL_H
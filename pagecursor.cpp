@@ -0,0 +1,20 @@
+#include "pagecursor.h"
+
+QString PageSeekSql(const QString& key_column, const QString& id_column)
+{
+    if (key_column.isEmpty()) {
+        return id_column + " > :after_id";
+    }
+
+    // The first term is an index range, the second skips the ties already listed
+    return key_column + " >= :key AND (" + key_column + " > :key OR " + id_column + " > :after_id)";
+}
+
+void BindPageCursor(QSqlQuery* query, const PageCursor& cursor, bool keyed)
+{
+    if (keyed) {
+        // Every text sorts at or after the empty string, so the first page starts there
+        query->bindValue(":key", cursor.key.isNull() ? QString("") : cursor.key.toString());
+    }
+    query->bindValue(":after_id", cursor.id);
+}
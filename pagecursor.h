@@ -0,0 +1,51 @@
+#ifndef PAGE_CURSOR_H
+#define PAGE_CURSOR_H
+
+#include <QSqlQuery>
+#include <QString>
+#include <QVariant>
+
+/**
+ * @file pagecursor.h
+ * @brief Header file for the PageCursor struct and the keyset helpers.
+ *
+ * The List*Page() methods of the managers page through a table with keyset
+ * seeks: a page starts right after the (sort key, ID) of the last row of
+ * the previous page, which an index on the sort key finds directly. Every
+ * page costs the same however deep into the table it is, where OFFSET
+ * would step over all the earlier rows.
+ */
+
+/**
+ * @brief Position after the last row of a page, where the next page starts.
+ *
+ * A default constructed cursor starts at the first page. Cursors are built
+ * from the last row of a page by the CursorAfter() methods of the managers.
+ */
+struct PageCursor {
+    QVariant key; ///< Sort key of the last row, null when sorting by ID or for the first page
+    int id = 0; ///< ID of the last row, breaks ties between equal keys, 0 for the first page
+};
+
+/**
+ * @brief Builds the seek condition of a page sorted by a key, then by ID.
+ *
+ * The condition binds :key and :after_id, see BindPageCursor(). It is
+ * written so the range on the key column can be answered from an index.
+ *
+ * @param key_column The sort key column, an empty string when sorting by ID only.
+ * @param id_column The ID column.
+ * @return QString The SQL condition.
+ */
+QString PageSeekSql(const QString& key_column, const QString& id_column);
+
+/**
+ * @brief Binds a cursor to a query built with PageSeekSql().
+ *
+ * @param query The query to bind.
+ * @param cursor The cursor of the page.
+ * @param keyed Whether the condition has a key column.
+ */
+void BindPageCursor(QSqlQuery* query, const PageCursor& cursor, bool keyed);
+
+#endif // PAGE_CURSOR_H
@@ -0,0 +1,194 @@
+#include "queryprofiler.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QMutexLocker>
+#include <QRegularExpression>
+#include <QTextStream>
+
+#include <algorithm>
+
+qint64 QueryStats::PercentileUs(double percentile) const
+{
+    quint64 rank = static_cast<quint64>(calls * percentile / 100.0 + 0.5);
+    quint64 seen = 0;
+    for (int bucket = 0; bucket < histogram.size(); ++bucket) {
+        seen += histogram.at(bucket);
+        if (seen >= qMax<quint64>(1, rank)) {
+            return bucket == histogram.size() - 1 ? max_ns / 1000 : QueryProfiler::BucketUpperBoundUs(bucket);
+        }
+    }
+    return max_ns / 1000;
+}
+
+bool QueryStats::HasFullScan() const
+{
+    // "SCAN t" reads the whole table; index scans, FTS lookups and constant rows say so
+    for (const QString& step : plan) {
+        QString detail = step.trimmed();
+        if (detail.startsWith("SCAN ") && !detail.contains("USING") && !detail.contains("VIRTUAL TABLE")
+            && !detail.contains("CONSTANT ROW")) {
+            return true;
+        }
+    }
+    return false;
+}
+
+qint64 QueryProfiler::BucketUpperBoundUs(int bucket)
+{
+    return qint64(1) << bucket;
+}
+
+QString QueryProfiler::Template(const QString& sql)
+{
+    // Lists of placeholders or integers, as built for IN, vary in length but not in shape; a
+    // single value folds too, so a list of one does not make a template of its own
+    static const QRegularExpression value_list("\\(\\s*(\\?|\\d+)(\\s*,\\s*(\\?|\\d+))*\\s*\\)");
+
+    QString text = sql.simplified();
+    text.replace(value_list, "(...)");
+    return text;
+}
+
+void QueryProfiler::SetSlowLogPath(const QString& path)
+{
+    QMutexLocker locker(&mutex);
+    slow_log_path = path;
+}
+
+bool QueryProfiler::Record(const QString& sql, qint64 elapsed_ns, qint64 rows, bool ok)
+{
+    QMutexLocker locker(&mutex);
+    QueryStats& entry = StatsFor(sql);
+
+    bool first = entry.calls == 0;
+    entry.calls++;
+    if (!ok) {
+        entry.failures++;
+    }
+    entry.rows += qMax<qint64>(0, rows);
+    entry.total_ns += elapsed_ns;
+    entry.max_ns = qMax(entry.max_ns, elapsed_ns);
+
+    // Bucket b holds latencies below 2^b microseconds
+    quint64 elapsed_us = static_cast<quint64>(elapsed_ns / 1000);
+    int bucket = 0;
+    while (bucket < kBucketCount - 1 && elapsed_us >= static_cast<quint64>(BucketUpperBoundUs(bucket))) {
+        bucket++;
+    }
+    entry.histogram[bucket]++;
+
+    return first;
+}
+
+void QueryProfiler::RecordRows(const QString& sql, qint64 rows)
+{
+    QMutexLocker locker(&mutex);
+    StatsFor(sql).rows += qMax<qint64>(0, rows);
+}
+
+void QueryProfiler::SetPlan(const QString& sql, const QStringList& plan)
+{
+    QMutexLocker locker(&mutex);
+    StatsFor(sql).plan = plan;
+}
+
+void QueryProfiler::LogSlowQuery(const QString& sql, const QVariantList& values, qint64 elapsed_ns, const QStringList& plan)
+{
+    QStringList value_texts;
+    for (const QVariant& value : values) {
+        value_texts.append(value.isNull() ? QString("NULL") : value.toString().left(100));
+    }
+
+    QMutexLocker locker(&mutex);
+    StatsFor(sql).slow_calls++;
+
+    qWarning().noquote() << QString("Slow query (%1 ms): %2").arg(elapsed_ns / 1e6, 0, 'f', 1).arg(Template(sql));
+
+    if (slow_log_path.isEmpty()) {
+        return;
+    }
+
+    QFile file(slow_log_path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        qWarning() << "Cannot write the slow query log" << slow_log_path << ":" << file.errorString();
+        return;
+    }
+
+    QTextStream out(&file);
+    out << QDateTime::currentDateTime().toString(Qt::ISODateWithMs)
+        << ' ' << QString::number(elapsed_ns / 1e6, 'f', 3) << " ms\n"
+        << "  sql: " << Template(sql) << '\n';
+    if (!value_texts.isEmpty()) {
+        out << "  values: " << value_texts.join(", ") << '\n';
+    }
+    for (const QString& step : plan) {
+        out << "  plan: " << step << '\n';
+    }
+}
+
+QList<QueryStats> QueryProfiler::GetStats() const
+{
+    QList<QueryStats> result;
+    {
+        QMutexLocker locker(&mutex);
+        result = stats.values();
+    }
+
+    std::sort(result.begin(), result.end(), [](const QueryStats& a, const QueryStats& b) {
+        return a.total_ns > b.total_ns;
+    });
+    return result;
+}
+
+QString QueryProfiler::Report() const
+{
+    const QList<QueryStats> entries = GetStats();
+
+    QString report;
+    QTextStream out(&report);
+    out << QString("%1 %2 %3 %4 %5 %6 %7 %8 %9\n")
+               .arg("calls", 9).arg("failed", 6).arg("slow", 6).arg("rows", 10).arg("total_ms", 10)
+               .arg("mean_us", 9).arg("p50_us", 9).arg("p99_us", 9).arg("max_us", 9);
+
+    for (const QueryStats& entry : entries) {
+        out << QString("%1 %2 %3 %4 %5 %6 %7 %8 %9\n")
+                   .arg(entry.calls, 9).arg(entry.failures, 6).arg(entry.slow_calls, 6).arg(entry.rows, 10)
+                   .arg(entry.total_ns / 1e6, 10, 'f', 1)
+                   .arg(entry.calls > 0 ? entry.total_ns / 1000 / static_cast<qint64>(entry.calls) : 0, 9)
+                   .arg(QString("<%1").arg(entry.PercentileUs(50)), 9)
+                   .arg(QString("<%1").arg(entry.PercentileUs(99)), 9)
+                   .arg(entry.max_ns / 1000, 9);
+        out << "  " << entry.sql << '\n';
+        for (const QString& step : entry.plan) {
+            out << "    plan: " << step << '\n';
+        }
+        if (entry.HasFullScan()) {
+            out << "    warning: full table scan\n";
+        }
+    }
+
+    out.flush();
+    return report;
+}
+
+void QueryProfiler::Reset()
+{
+    QMutexLocker locker(&mutex);
+    templates.clear();
+    stats.clear();
+}
+
+QueryStats& QueryProfiler::StatsFor(const QString& sql)
+{
+    auto it = templates.constFind(sql);
+    QString key = it != templates.constEnd() ? it.value() : templates.insert(sql, Template(sql)).value();
+
+    QueryStats& entry = stats[key];
+    if (entry.histogram.isEmpty()) {
+        entry.sql = key;
+        entry.histogram.resize(kBucketCount);
+    }
+    return entry;
+}
@@ -0,0 +1,155 @@
+#ifndef QUERY_PROFILER_H
+#define QUERY_PROFILER_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVariantList>
+#include <QVector>
+
+/**
+ * @file queryprofiler.h
+ * @brief Header file for QueryProfiler class.
+ *
+ * QueryProfiler collects statement statistics from the connections that
+ * execute through DatabaseManager::Exec(). Statements are grouped by SQL
+ * template: the SQL text with whitespace collapsed and IN lists of
+ * placeholders or integers folded, so every lookup of the same shape
+ * lands in one entry whatever its values.
+ *
+ * Latencies go into a histogram of power-of-two microsecond buckets. The
+ * query plan of a template is captured with EXPLAIN QUERY PLAN when it
+ * first runs, which points out full table scans without waiting for a
+ * slow call. Calls above the slow threshold of the connection's profile
+ * are appended to the slow-query log with their values and plan.
+ */
+
+/**
+ * @brief Statistics of one SQL template.
+ */
+struct QueryStats {
+    QString sql; ///< The SQL template
+    quint64 calls = 0; ///< Executions
+    quint64 failures = 0; ///< Executions that returned an error
+    quint64 slow_calls = 0; ///< Executions above the slow threshold
+    quint64 rows = 0; ///< Rows changed by writes and rows read by recorded reads
+    qint64 total_ns = 0; ///< Total execution time
+    qint64 max_ns = 0; ///< Longest execution time
+    QVector<quint64> histogram; ///< Executions per latency bucket, see QueryProfiler::BucketUpperBoundUs()
+    QStringList plan; ///< EXPLAIN QUERY PLAN lines, empty for statements without a plan
+
+    /**
+     * @brief Estimates a latency percentile from the histogram.
+     * 
+     * @param percentile The percentile, from 0 to 100.
+     * @return qint64 Upper bound in microseconds of the bucket holding the percentile.
+     */
+    qint64 PercentileUs(double percentile) const;
+
+    /**
+     * @brief Checks the plan for a table scanned without an index.
+     * 
+     * @return true if a plan step scans a whole table.
+     */
+    bool HasFullScan() const;
+};
+
+/**
+ * @class QueryProfiler
+ * @brief Thread-safe collector of statement statistics, shared by the connections of a database.
+ */
+class QueryProfiler
+{
+public:
+    static constexpr int kBucketCount = 24; ///< Latency buckets, the last one is unbounded
+
+    /**
+     * @brief Get the upper bound of a latency bucket.
+     * 
+     * @param bucket The bucket, 0 to kBucketCount - 1.
+     * @return qint64 2^bucket microseconds.
+     */
+    static qint64 BucketUpperBoundUs(int bucket);
+
+    /**
+     * @brief Turns SQL text into its template.
+     * 
+     * @param sql The SQL text.
+     * @return QString The template.
+     */
+    static QString Template(const QString& sql);
+
+    /**
+     * @brief Sets the file slow queries are appended to.
+     * 
+     * @param path Path of the log file, empty to only log slow queries as warnings.
+     */
+    void SetSlowLogPath(const QString& path);
+
+    /**
+     * @brief Records one execution of a statement.
+     * 
+     * @param sql SQL text of the statement.
+     * @param elapsed_ns Execution time.
+     * @param rows Rows changed by the statement, 0 for reads.
+     * @param ok Whether the statement succeeded.
+     * @return true if this is the first execution of the template, whose plan should be captured.
+     */
+    bool Record(const QString& sql, qint64 elapsed_ns, qint64 rows, bool ok);
+
+    /**
+     * @brief Adds the rows a read returned to its template.
+     * 
+     * @param sql SQL text of the statement.
+     * @param rows Rows read.
+     */
+    void RecordRows(const QString& sql, qint64 rows);
+
+    /**
+     * @brief Stores the query plan of a template.
+     * 
+     * @param sql SQL text of the statement.
+     * @param plan EXPLAIN QUERY PLAN lines.
+     */
+    void SetPlan(const QString& sql, const QStringList& plan);
+
+    /**
+     * @brief Counts a slow execution and appends it to the slow-query log.
+     * 
+     * @param sql SQL text of the statement.
+     * @param values Values bound to the statement.
+     * @param elapsed_ns Execution time.
+     * @param plan EXPLAIN QUERY PLAN lines.
+     */
+    void LogSlowQuery(const QString& sql, const QVariantList& values, qint64 elapsed_ns, const QStringList& plan);
+
+    /**
+     * @brief Get the statistics of every template, by descending total time.
+     * 
+     * @return QList<QueryStats> The statistics.
+     */
+    QList<QueryStats> GetStats() const;
+
+    /**
+     * @brief Formats the statistics as a text report, by descending total time.
+     * 
+     * @return QString The report.
+     */
+    QString Report() const;
+
+    /**
+     * @brief Drops all statistics.
+     */
+    void Reset();
+
+private:
+    mutable QMutex mutex; ///< Guards the members below
+    QHash<QString, QString> templates; ///< Template by SQL text, so each text is folded once
+    QHash<QString, QueryStats> stats; ///< Statistics by template
+    QString slow_log_path; ///< File slow queries are appended to, may be empty
+
+    QueryStats& StatsFor(const QString& sql); ///< Statistics of the template of an SQL text, must be called with the mutex held
+};
+
+#endif // QUERY_PROFILER_H
@@ -0,0 +1,109 @@
+#include "ritemlistmodel.h"
+#include "tracer.h"
+
+RItemListModel::RItemListModel(DatabaseExecutor* executor, QObject* parent)
+    : QAbstractListModel(parent),
+      executor(executor),
+      fetching(false),
+      at_end(true), // Nothing is fetched before the first Reload()
+      tail_changed(false),
+      generation(0)
+{
+}
+
+int RItemListModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : r_items.size();
+}
+
+QVariant RItemListModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= r_items.size()) {
+        return QVariant();
+    }
+
+    const RItemListRow& r_item = r_items.at(index.row());
+
+    switch (role) {
+    case Qt::DisplayRole:
+        return r_item.label;
+    case Qt::UserRole:
+        return r_item.r_item_id;
+    default:
+        return QVariant();
+    }
+}
+
+bool RItemListModel::canFetchMore(const QModelIndex& parent) const
+{
+    return !parent.isValid() && !at_end;
+}
+
+void RItemListModel::fetchMore(const QModelIndex& parent)
+{
+    RT_TRACE_SCOPE("ui", "RItemListModel::fetchMore");
+
+    // The view asks again once the pending page has been inserted
+    if (parent.isValid() || at_end || fetching) {
+        return;
+    }
+
+    fetching = true;
+    // Listed by ID, so appended items are picked up by the next page
+    PageCursor after = r_items.isEmpty() ? PageCursor() : RItemManager::CursorAfter(r_items.last(), RItemSortKey::Id);
+    quint64 page_generation = generation;
+
+    RItemManager::ListRItemsPageAsync(executor, RItemSortKey::Id, after, kPageSize)
+        .then(this, [this, page_generation](const QList<RItemListRow>& page) {
+            if (page_generation == generation) {
+                AppendPage(page);
+            }
+        });
+}
+
+void RItemListModel::Reload()
+{
+    RT_TRACE_SCOPE("ui", "RItemListModel::Reload");
+
+    beginResetModel();
+    r_items.clear();
+    r_items.squeeze();
+    fetching = false;
+    at_end = false;
+    tail_changed = false;
+    generation++;
+    endResetModel();
+
+    fetchMore(QModelIndex());
+}
+
+void RItemListModel::FetchAppended()
+{
+    RT_TRACE_SCOPE("ui", "RItemListModel::FetchAppended");
+
+    at_end = false;
+    if (fetching) {
+        tail_changed = true;
+        return;
+    }
+
+    fetchMore(QModelIndex());
+}
+
+void RItemListModel::AppendPage(const QList<RItemListRow>& page)
+{
+    RT_TRACE_SCOPE("ui", "RItemListModel::AppendPage");
+
+    // A page queried before rows were appended may have missed them
+    fetching = false;
+    at_end = page.size() < kPageSize && !tail_changed;
+    tail_changed = false;
+
+    if (!page.isEmpty()) {
+        beginInsertRows(QModelIndex(), r_items.size(), r_items.size() + page.size() - 1);
+        r_items.append(page);
+        endInsertRows();
+    }
+
+    emit PageLoaded();
+}
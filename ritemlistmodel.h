@@ -0,0 +1,76 @@
+#ifndef R_ITEM_LIST_MODEL_H
+#define R_ITEM_LIST_MODEL_H
+
+#include "databaseexecutor.h"
+
+#include <QAbstractListModel>
+#include <QVector>
+
+/**
+ * @file ritemlistmodel.h
+ * @brief Header file for RItemListModel class.
+ *
+ * RItemListModel backs the readable items list. Rows are loaded a page at a
+ * time through RItemManager::ListRItemsPageAsync() as the view scrolls.
+ */
+
+/**
+ * @class RItemListModel
+ * @brief Lazily filled list model of readable item labels, ordered by item ID.
+ *
+ * The display role holds the item label and Qt::UserRole the item ID.
+ */
+class RItemListModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    static constexpr int kPageSize = 256; ///< Number of items fetched per page
+
+    /**
+     * @brief Constructs an empty model, call Reload() to fetch the first page.
+     * 
+     * @param executor The executor to run the page queries on, must outlive the model.
+     * @param parent Parent QObject.
+     */
+    explicit RItemListModel(DatabaseExecutor* executor, QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+    /**
+     * @brief Drops the loaded rows and fetches the first page again.
+     *
+     * Pages still in flight from before the reload are discarded.
+     */
+    void Reload();
+
+    /**
+     * @brief Resumes fetching after rows were appended to the table.
+     *
+     * New rows have the highest IDs, so they are picked up by the next page
+     * instead of reloading the loaded rows.
+     */
+    void FetchAppended();
+
+signals:
+    /**
+     * @brief Emitted after a fetched page has been appended, also when it was empty.
+     */
+    void PageLoaded();
+
+private:
+    DatabaseExecutor* executor; ///< Executor the page queries run on
+    QVector<RItemListRow> r_items; ///< Rows loaded so far, ordered by item ID
+    bool fetching; ///< Whether a page query is in flight
+    bool at_end; ///< Whether the last page has been loaded
+    bool tail_changed; ///< Whether rows were appended while a page was in flight
+    quint64 generation; ///< Incremented by Reload() to discard stale pages
+
+    void AppendPage(const QList<RItemListRow>& page); ///< Appends a fetched page to the rows
+};
+
+#endif // R_ITEM_LIST_MODEL_H
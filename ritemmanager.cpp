@@ -1,4 +1,8 @@
 #include "ritemmanager.h"
+#include "databaseexecutor.h"
+#include "tracer.h"
+
+#include <algorithm>
 
 RItemManager::RItemManager(DatabaseManager* db_manager, EditionManager* edition_manager)
     : database_manager(db_manager), edition_manager(edition_manager)
@@ -7,9 +11,6 @@ RItemManager::RItemManager(DatabaseManager* db_manager, EditionManager* edition_
         qCritical() << "Database connection is not valid or open.";
         return; // Database error
     }
-
-    // Initialize RItem-related tables
-    CreateRItemTable();
 }
 
 RItemManager::~RItemManager()
@@ -19,11 +20,20 @@ RItemManager::~RItemManager()
 
 int RItemManager::InsertEdition(const EditionData& edition_data)
 {
+    RT_TRACE_SCOPE("db", "RItemManager::InsertEdition");
+
     if (!database_manager || !database_manager->GetDatabase().isOpen()) {
         qCritical() << "Database connection is not valid or open.";
         return -1; // Database error
     }
 
+    // The edition and its readable item are written atomically
+    ScopedTransaction transaction(database_manager);
+    if (!transaction.IsActive()) {
+        qCritical() << "InsertEdition: failed to begin transaction";
+        return -1; // Database error
+    }
+
     // Insert the edition data into the database
     int edition_id = edition_manager->InsertEdition(edition_data);
     if (edition_id == -1) {
@@ -37,152 +47,289 @@ int RItemManager::InsertEdition(const EditionData& edition_data)
     item_data.issue_id = -1; // NULL
 
     int r_item_id = InsertRItem(item_data);
+    if (r_item_id == -1) {
+        return -1; // Insertion failed, edition is rolled back
+    }
+
+    if (!transaction.Commit()) {
+        qCritical() << "InsertEdition: failed to commit transaction";
+        return -1; // Insertion failed
+    }
 
     return r_item_id;
 }
 
+QFuture<int> RItemManager::InsertEditionAsync(DatabaseExecutor* executor, const EditionData& edition_data)
+{
+    return executor->Run([edition_data](Library& library) {
+        return library.r_item_manager->InsertEdition(edition_data);
+    });
+}
+
 bool RItemManager::RItemExists(int r_item_id) const
 {
+    RT_TRACE_SCOPE("db", "RItemManager::RItemExists");
+
     if (!database_manager || !database_manager->GetDatabase().isOpen()) {
         qCritical() << "Database connection is not valid or open.";
         return false;
     }
 
-    QSqlDatabase db = database_manager->GetDatabase();
-    QSqlQuery query(db);
+    QSqlQuery* query = database_manager->GetCachedQuery("SELECT 1 FROM RItem WHERE id = :id LIMIT 1");
+    if (!query) {
+        return false;
+    }
 
-    query.prepare("SELECT 1 FROM RItem WHERE id = :id LIMIT 1");
-    query.bindValue(":id", r_item_id);
+    query->bindValue(":id", r_item_id);
 
-    if (!query.exec()) {
-        qCritical() << "RItemExists:" << query.lastError().text();
+    if (!database_manager->Exec(query)) {
+        qCritical() << "RItemExists:" << query->lastError().text();
         return false;
     }
 
-    return query.next(); // Returns true if a row exists
+    bool exists = query->next(); // True if a row exists
+    query->finish();
+    return exists;
 }
 
-/// @todo Return with more details about the item, not just IDs
 QMap<int, QString> RItemManager::GetAllRItems() const
 {
     QMap<int, QString> r_items;
 
+    const QList<RItemListRow> rows = ListRItems();
+    for (const RItemListRow& row : rows) {
+        r_items.insert(row.r_item_id, row.label);
+    }
+
+    return r_items;
+}
+
+QList<RItemListRow> RItemManager::ListRItems(const QList<int>& r_item_ids) const
+{
+    RT_TRACE_SCOPE("db", "RItemManager::ListRItems");
+
     if (!database_manager || !database_manager->GetDatabase().isOpen()) {
         qCritical() << "Database connection is not valid or open.";
-        return r_items;
+        return QList<RItemListRow>();
     }
 
     QSqlDatabase db = database_manager->GetDatabase();
     QSqlQuery query(db);
+    query.setForwardOnly(true);
 
-    // Get all readable items with their IDs and types
-    if (!query.exec("SELECT id, type, edition_id, issue_id FROM RItem")) {
-        qCritical() << "GetAllRItems:" << query.lastError().text();
-        return r_items;
+    if (r_item_ids.isEmpty()) {
+        if (!database_manager->Exec(query, SelectRItemsSql("RItem"))) {
+            qCritical() << "ListRItems:" << query.lastError().text();
+            return QList<RItemListRow>();
+        }
+        return ReadRItems(query);
     }
 
-    while (query.next()) {
-        int r_item_id = query.value(0).toInt();
-        RItemType type = static_cast<RItemType>(query.value(1).toInt());
-        int edition_id = query.value(2).toInt();
-        // int issue_id = query.value(3).toInt(); // Not used for edition label
-
-        QString label;
-
-        if (type == RItemType::Edition && edition_id > 0 && edition_manager) {
-            // Get edition details from EditionManager
-            QSqlDatabase db2 = database_manager->GetDatabase();
-            QSqlQuery editionQuery(db2);
-            editionQuery.prepare("SELECT Book.title, Publisher.name, Book.id "
-                                 "FROM Edition "
-                                 "LEFT JOIN Book ON Edition.book_id = Book.id "
-                                 "LEFT JOIN Publisher ON Edition.publisher_id = Publisher.id "
-                                 "WHERE Edition.id = :edition_id");
-            editionQuery.bindValue(":edition_id", edition_id);
-
-            QString title, publisher, authors;
-            int book_id = -1;
-            if (editionQuery.exec() && editionQuery.next()) {
-                title = editionQuery.value(0).toString();
-                publisher = editionQuery.value(1).toString();
-                book_id = editionQuery.value(2).toInt();
-            }
-
-            QStringList authorList = edition_manager->GetAuthorsForEdition(edition_id);
-            authors = authorList.join(", ");
-
-            label = title;
-            if (!authors.isEmpty()) {
-                label += " - " + authors;
-            }
-            if (!publisher.isEmpty()) {
-                label += " - " + publisher;
-            }
+    // Sorted, so the rows of consecutive chunks stay ordered by ID
+    QList<int> ids = r_item_ids;
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+    // A single item, as resolved after every insert, reuses one cached statement
+    if (ids.size() == 1) {
+        QSqlQuery* cached_query = database_manager->GetCachedQuery(SelectRItemsSql("(SELECT * FROM RItem WHERE id = :id)"));
+        if (!cached_query) {
+            return QList<RItemListRow>();
         }
-        else if (type == RItemType::Issue) {
-            label = QString("Issue ID %1").arg(r_item_id);
+        cached_query->bindValue(":id", ids.first());
+        if (!database_manager->Exec(cached_query)) {
+            qCritical() << "ListRItems:" << cached_query->lastError().text();
+            return QList<RItemListRow>();
         }
-        else {
-            label = QString("Unknown Type ID %1").arg(r_item_id);
+        return ReadRItems(*cached_query);
+    }
+
+    // Bound in chunks to stay below SQLite's limit on host parameters
+    const int chunk_size = 500;
+    QList<RItemListRow> rows;
+
+    for (int start = 0; start < ids.size(); start += chunk_size) {
+        const QList<int> chunk = ids.mid(start, chunk_size);
+
+        QStringList placeholders;
+        placeholders.reserve(chunk.size());
+        for (int i = 0; i < chunk.size(); ++i) {
+            placeholders.append("?");
         }
 
-        r_items.insert(r_item_id, label);
+        query.prepare(SelectRItemsSql("(SELECT * FROM RItem WHERE id IN (" + placeholders.join(',') + "))"));
+        for (int r_item_id : chunk) {
+            query.addBindValue(r_item_id);
+        }
+        if (!database_manager->Exec(&query)) {
+            qCritical() << "ListRItems:" << query.lastError().text();
+            return QList<RItemListRow>();
+        }
+
+        rows.append(ReadRItems(query));
     }
 
-    return r_items;
+    return rows;
 }
 
-void RItemManager::CreateRItemTable()
+QList<RItemListRow> RItemManager::ListRItemsPage(RItemSortKey sort_key, const PageCursor& after, int limit) const
 {
+    RT_TRACE_SCOPE("db", "RItemManager::ListRItemsPage");
+
     if (!database_manager || !database_manager->GetDatabase().isOpen()) {
         qCritical() << "Database connection is not valid or open.";
-        return; // Database error
+        return QList<RItemListRow>();
     }
 
-    QSqlDatabase db = database_manager->GetDatabase();
-    QSqlQuery query(db);
+    if (limit <= 0) {
+        qWarning() << "ListRItemsPage failed: limit must be greater than 0";
+        return QList<RItemListRow>();
+    }
+
+    // Limit the items before joining the authors so a page never splits an item
+    bool by_title = sort_key == RItemSortKey::Title;
+    QString source = by_title
+        ? "(SELECT RItem.* FROM RItem JOIN Edition ON Edition.id = RItem.edition_id "
+          "JOIN Book ON Book.id = Edition.book_id "
+          "WHERE " + PageSeekSql("Book.title", "RItem.id") + " ORDER BY Book.title, RItem.id LIMIT :limit)"
+        : "(SELECT * FROM RItem WHERE " + PageSeekSql("", "id") + " ORDER BY id LIMIT :limit)";
+    QSqlQuery* query = database_manager->GetCachedQuery(SelectRItemsSql(source, sort_key));
+    if (!query) {
+        return QList<RItemListRow>();
+    }
+
+    BindPageCursor(query, after, by_title);
+    query->bindValue(":limit", limit);
+
+    if (!database_manager->Exec(query)) {
+        qCritical() << "ListRItemsPage:" << query->lastError().text();
+        return QList<RItemListRow>();
+    }
+
+    return ReadRItems(*query);
+}
+
+QFuture<QList<RItemListRow>> RItemManager::ListRItemsPageAsync(DatabaseExecutor* executor, RItemSortKey sort_key, const PageCursor& after, int limit)
+{
+    return executor->Run([sort_key, after, limit](Library& library) {
+        return library.r_item_manager->ListRItemsPage(sort_key, after, limit);
+    });
+}
+
+PageCursor RItemManager::CursorAfter(const RItemListRow& r_item, RItemSortKey sort_key)
+{
+    return PageCursor{sort_key == RItemSortKey::Title ? QVariant(r_item.title) : QVariant(), r_item.r_item_id};
+}
 
-    // Create the RItem table if it does not exist
-    query.exec("CREATE TABLE IF NOT EXISTS RItem ("
-               "id INTEGER PRIMARY KEY AUTOINCREMENT, "
-               "type INTEGER, " // Store enum as INTEGER, 0 for edition, 1 for issue
-               "edition_id INTEGER, "
-               "issue_id INTEGER, "
-               "FOREIGN KEY(edition_id) REFERENCES Edition(id), "
-               "FOREIGN KEY(issue_id) REFERENCES Issue(id))");
+QString RItemManager::SelectRItemsSql(const QString& source, RItemSortKey sort_key)
+{
+    // One row per (item, author) pair, grouped by item through the ordering
+    return "SELECT R.id, R.type, R.edition_id, R.issue_id, "
+           "Edition.book_id, Book.title, Publisher.name, Author.name "
+           "FROM " + source + " AS R "
+           "LEFT JOIN Edition ON Edition.id = R.edition_id "
+           "LEFT JOIN Book ON Book.id = Edition.book_id "
+           "LEFT JOIN Publisher ON Publisher.id = Edition.publisher_id "
+           "LEFT JOIN Book2Author ON Book2Author.book_id = Edition.book_id "
+           "LEFT JOIN Author ON Author.id = Book2Author.author_id "
+           "ORDER BY " + QString(sort_key == RItemSortKey::Title ? "Book.title, " : "") + "R.id, Author.name";
+}
+
+QList<RItemListRow> RItemManager::ReadRItems(QSqlQuery& query)
+{
+    QList<RItemListRow> r_items;
+
+    while (query.next()) {
+        int r_item_id = query.value(0).toInt();
+        if (r_items.isEmpty() || r_items.last().r_item_id != r_item_id) {
+            RItemListRow row;
+            row.r_item_id = r_item_id;
+            row.type = static_cast<RItemType>(query.value(1).toInt());
+            row.edition_id = query.value(2).toInt();
+            row.issue_id = query.value(3).toInt();
+            row.book_id = query.value(4).toInt();
+            row.title = query.value(5).toString();
+            row.publisher = query.value(6).toString();
+            r_items.append(row);
+        }
+        if (!query.value(7).isNull()) {
+            r_items.last().authors.append(query.value(7).toString());
+        }
+    }
+
+    for (RItemListRow& row : r_items) {
+        row.label = RItemLabel(row);
+    }
+
+    return r_items;
+}
+
+QString RItemManager::RItemLabel(const RItemListRow& r_item)
+{
+    if (r_item.type == RItemType::Edition && r_item.edition_id > 0) {
+        QString label = r_item.title;
+        if (!r_item.authors.isEmpty()) {
+            label += " - " + r_item.authors.join(", ");
+        }
+        if (!r_item.publisher.isEmpty()) {
+            label += " - " + r_item.publisher;
+        }
+        return label;
+    }
+    if (r_item.type == RItemType::Issue) {
+        return QString("Issue ID %1").arg(r_item.r_item_id);
+    }
+    return QString("Unknown Type ID %1").arg(r_item.r_item_id);
+}
+
+QFuture<QList<RItemListRow>> RItemManager::ListRItemsAsync(DatabaseExecutor* executor, const QList<int>& r_item_ids)
+{
+    return executor->Run([r_item_ids](Library& library) {
+        return library.r_item_manager->ListRItems(r_item_ids);
+    });
 }
 
 int RItemManager::InsertRItem(const RItemData& item_data)
 {
+    RT_TRACE_SCOPE("db", "RItemManager::InsertRItem");
+
     if (!database_manager || !database_manager->GetDatabase().isOpen()) {
         qCritical() << "Database connection is not valid or open.";
         return -1; // Database error
     }
 
-    QSqlDatabase db = database_manager->GetDatabase();
-    QSqlQuery query(db);
+    QSqlQuery* query = database_manager->GetCachedQuery("INSERT INTO RItem (type, edition_id, issue_id) VALUES (:type, :edition_id, :issue_id)");
+    if (!query) {
+        return -1; // Database error
+    }
 
-    query.prepare("INSERT INTO RItem (type, edition_id, issue_id) VALUES (:type, :edition_id, :issue_id)");
-    query.bindValue(":type", static_cast<int>(item_data.type));
+    query->bindValue(":type", static_cast<int>(item_data.type));
 
     // Only one of edition_id or issue_id should be set, the other should be NULL
     if(item_data.type == RItemType::Edition && item_data.edition_id > 0 && item_data.issue_id == -1) {
-        query.bindValue(":edition_id", item_data.edition_id);
-        query.bindValue(":issue_id", QVariant(QVariant::Int)); // Will be NULL in SQL
+        query->bindValue(":edition_id", item_data.edition_id);
+        query->bindValue(":issue_id", QVariant(QVariant::Int)); // Will be NULL in SQL
     }
     else if(item_data.type == RItemType::Issue && item_data.issue_id > 0 && item_data.edition_id == -1) {
-        query.bindValue(":edition_id", QVariant(QVariant::Int)); // Will be NULL in SQL
-        query.bindValue(":issue_id", item_data.issue_id);
+        query->bindValue(":edition_id", QVariant(QVariant::Int)); // Will be NULL in SQL
+        query->bindValue(":issue_id", item_data.issue_id);
     }
     else {
         qWarning() << "InsertRItem failed: Invalid item data";
         return -1; // Invalid input
     }
 
-    if (!query.exec()) {
-        qCritical() << "InsertRItem:" << query.lastError().text();
+    if (!database_manager->Exec(query)) {
+        qCritical() << "InsertRItem:" << query->lastError().text();
         return -1; // Insertion failed
     }
 
-    return query.lastInsertId().toInt(); // Return the ID of the inserted RItem
+    int r_item_id = query->lastInsertId().toInt();
+
+    // Views show the item by its label, resolve it while the row is at hand
+    const QList<RItemListRow> rows = ListRItems({r_item_id});
+    database_manager->PublishChange(ChangeEvent{ChangeType::RItemInserted, r_item_id,
+                                                rows.isEmpty() ? QString() : rows.first().label});
+
+    return r_item_id; // Return the ID of the inserted RItem
 }
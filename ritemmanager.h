@@ -14,6 +14,26 @@ struct RItemData {
     RItemType type; ///< Type of the item (Edition or Issue)
 };
 
+struct RItemListRow {
+    int r_item_id; ///< ID of the readable item
+    RItemType type; ///< Type of the item (Edition or Issue)
+    int edition_id; ///< ID of the edition, 0 if the item is not an edition
+    int issue_id; ///< ID of the issue, 0 if the item is not an issue
+    int book_id; ///< ID of the book of the edition, 0 if not an edition
+    QString title; ///< Title of the book of the edition
+    QString publisher; ///< Publisher of the edition
+    QStringList authors; ///< Authors of the book, ordered by name
+    QString label; ///< Display label of the item
+};
+
+/**
+ * @brief Orders of the readable item pages, see RItemManager::ListRItemsPage().
+ */
+enum class RItemSortKey {
+    Id, ///< By item ID, the order items were added in
+    Title ///< By book title, then item ID, only items of an edition
+};
+
 class RItemManager
 {
 public:
@@ -35,6 +55,15 @@ public:
      */
     int InsertEdition(const EditionData& edition_data);
 
+    /**
+     * @brief Inserts a new edition and its readable item on the database worker thread.
+     * 
+     * @param executor The executor to run the insert on.
+     * @param edition_data The edition data of the item to insert.
+     * @return QFuture<int> The ID of the inserted item, or -1 on failure.
+     */
+    static QFuture<int> InsertEditionAsync(DatabaseExecutor* executor, const EditionData& edition_data);
+
     /**
      * @brief Checks if a readable item exists in the database.
      * 
@@ -50,6 +79,64 @@ public:
      */
     QMap<int, QString> GetAllRItems() const;
 
+    /**
+     * @brief Resolves the details and labels of readable items in a single query.
+     * 
+     * @param r_item_ids IDs of the items to resolve, or an empty list for all items.
+     * @return QList<RItemListRow> The resolved items ordered by ID. Unknown IDs are skipped.
+     */
+    QList<RItemListRow> ListRItems(const QList<int>& r_item_ids = {}) const;
+
+    /**
+     * @brief Resolves readable items on the database worker thread, see ListRItems().
+     * 
+     * @param executor The executor to run the query on.
+     * @param r_item_ids IDs of the items to resolve, or an empty list for all items.
+     * @return QFuture<QList<RItemListRow>> The resolved items ordered by ID.
+     */
+    static QFuture<QList<RItemListRow>> ListRItemsAsync(DatabaseExecutor* executor, const QList<int>& r_item_ids = {});
+
+    /**
+     * @brief Lists one page of readable items, seeking to the page through an index, for lazily filled views.
+     *
+     * Sorted by title, only items of an edition are listed, and items of books
+     * sharing a title are sorted by ID after the seek.
+     * 
+     * @param sort_key Order of the items.
+     * @param after Cursor after the last item of the previous page, default constructed for the first page.
+     * @param limit Maximum number of items in the page.
+     * @return QList<RItemListRow> The items, fewer than limit on the last page.
+     */
+    QList<RItemListRow> ListRItemsPage(RItemSortKey sort_key, const PageCursor& after, int limit) const;
+
+    /**
+     * @brief Lists one page of readable items on the database worker thread, see ListRItemsPage().
+     * 
+     * @param executor The executor to run the query on.
+     * @param sort_key Order of the items.
+     * @param after Cursor after the last item of the previous page.
+     * @param limit Maximum number of items in the page.
+     * @return QFuture<QList<RItemListRow>> The items.
+     */
+    static QFuture<QList<RItemListRow>> ListRItemsPageAsync(DatabaseExecutor* executor, RItemSortKey sort_key, const PageCursor& after, int limit);
+
+    /**
+     * @brief Builds the cursor of the page following a readable item.
+     * 
+     * @param r_item The last item of a page.
+     * @param sort_key Order the page was listed in.
+     * @return PageCursor The cursor of the next page.
+     */
+    static PageCursor CursorAfter(const RItemListRow& r_item, RItemSortKey sort_key);
+
+    /**
+     * @brief Builds the display label of a readable item: "Title - Author1, Author2 - Publisher".
+     * 
+     * @param r_item The item row to build the label for, its label is ignored.
+     * @return QString The display label.
+     */
+    static QString RItemLabel(const RItemListRow& r_item);
+
     /// @todo IssueManager should be implemented similarly to EditionManager
     // int InsertIssue(const IssueData& issue_data);
 
@@ -57,9 +144,10 @@ private:
     DatabaseManager* database_manager; ///< Pointer to the DatabaseManager instance.
     EditionManager* edition_manager; ///< Pointer to the EditionManager instance.
 
-    void CreateRItemTable(); ///< Creates the RItem table in the database.
-
     int InsertRItem(const RItemData& item_data); ///< Inserts a new RItem into the database.
+
+    static QString SelectRItemsSql(const QString& source, RItemSortKey sort_key = RItemSortKey::Id); ///< Item query over a table or subquery aliased as R.
+    static QList<RItemListRow> ReadRItems(QSqlQuery& query); ///< Groups the author rows and builds the labels.
 };
 
 #endif // R_ITEM_MANAGER_H
\ No newline at end of file
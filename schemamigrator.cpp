@@ -0,0 +1,313 @@
+#include "schemamigrator.h"
+#include "databasemanager.h"
+
+namespace {
+
+// Shipped migrations are built with these helpers, so they are frozen along with them
+
+// Search documents: books at rowid 2 * Book.id, MyLibrary notes at rowid 2 * MyLibrary.id + 1
+QString IndexBooksSql(const QString& book_filter)
+{
+    return "INSERT INTO SearchIndex (rowid, kind, ref_id, title, authors, series, publishers) "
+           "SELECT Book.id * 2, 0, Book.id, Book.title, "
+           "(SELECT group_concat(Author.name, ', ') FROM Book2Author "
+           "JOIN Author ON Author.id = Book2Author.author_id WHERE Book2Author.book_id = Book.id), "
+           "(SELECT group_concat(DISTINCT Series.name) FROM Edition "
+           "JOIN Series ON Series.id = Edition.series_id WHERE Edition.book_id = Book.id), "
+           "(SELECT group_concat(DISTINCT Publisher.name) FROM Edition "
+           "JOIN Publisher ON Publisher.id = Edition.publisher_id WHERE Edition.book_id = Book.id) "
+           "FROM Book WHERE " + book_filter;
+}
+
+QString ReindexBooksSql(const QString& book_filter)
+{
+    return "DELETE FROM SearchIndex WHERE rowid IN (SELECT Book.id * 2 FROM Book WHERE " + book_filter + "); "
+           + IndexBooksSql(book_filter);
+}
+
+QString IndexNotesSql(const QString& my_library_filter)
+{
+    return "INSERT INTO SearchIndex (rowid, kind, ref_id, notes) "
+           "SELECT MyLibrary.id * 2 + 1, 1, MyLibrary.id, MyLibrary.notes FROM MyLibrary "
+           "WHERE MyLibrary.notes IS NOT NULL AND " + my_library_filter;
+}
+
+QString TriggerSql(const QString& name, const QString& event, const QString& body)
+{
+    return "CREATE TRIGGER IF NOT EXISTS " + name + " " + event + " BEGIN " + body + "; END";
+}
+
+// Guards the insert triggers, SearchManager::SuspendIndexing() sets the flag for a bulk write
+const QString kIndexingNotSuspended = " WHEN (SELECT suspended FROM SearchIndexState WHERE id = 1) = 0";
+
+} // namespace
+
+SchemaMigrator::SchemaMigrator(DatabaseManager* db_manager)
+    : database_manager(db_manager)
+{
+}
+
+bool SchemaMigrator::Migrate()
+{
+    // Ensure the database connection is valid
+    if (!database_manager || !database_manager->GetDatabase().isOpen()) {
+        qCritical() << "Database connection is not valid or open.";
+        return false; // Database error
+    }
+
+    int current_version = GetCurrentVersion();
+    if (current_version == -1) {
+        return false;
+    }
+
+    if (current_version > GetLatestVersion()) {
+        qWarning() << "Database schema version" << current_version
+                   << "is newer than the supported version" << GetLatestVersion();
+        return true; // Leave a newer schema untouched
+    }
+
+    for (const SchemaMigration& migration : Migrations()) {
+        if (migration.version <= current_version) {
+            continue;
+        }
+        if (!Apply(migration)) {
+            return false;
+        }
+        qInfo() << "Applied schema migration" << migration.version << ":" << migration.description;
+    }
+
+    return true;
+}
+
+int SchemaMigrator::GetCurrentVersion() const
+{
+    QSqlDatabase db = database_manager->GetDatabase();
+    QSqlQuery query(db);
+
+    if (!query.exec("PRAGMA user_version") || !query.next()) {
+        qCritical() << "GetCurrentVersion:" << query.lastError().text();
+        return -1;
+    }
+
+    return query.value(0).toInt();
+}
+
+int SchemaMigrator::GetLatestVersion()
+{
+    return Migrations().last().version;
+}
+
+const QList<SchemaMigration>& SchemaMigrator::Migrations()
+{
+    // Migrations are append-only: never edit one that has shipped, add a new one instead
+    static const QList<SchemaMigration> migrations = {
+        {
+            1,
+            "Create the base tables",
+            {
+                "CREATE TABLE IF NOT EXISTS Author (id INTEGER PRIMARY KEY AUTOINCREMENT, name TEXT UNIQUE NOT NULL)",
+                "CREATE TABLE IF NOT EXISTS Publisher (id INTEGER PRIMARY KEY AUTOINCREMENT, name TEXT UNIQUE NOT NULL)",
+                "CREATE TABLE IF NOT EXISTS Language (id INTEGER PRIMARY KEY AUTOINCREMENT, name TEXT UNIQUE NOT NULL)",
+                "CREATE TABLE IF NOT EXISTS Country (id INTEGER PRIMARY KEY AUTOINCREMENT, name TEXT UNIQUE NOT NULL)",
+                "CREATE TABLE IF NOT EXISTS Genre (id INTEGER PRIMARY KEY AUTOINCREMENT, name TEXT UNIQUE NOT NULL)",
+                "CREATE TABLE IF NOT EXISTS Series (id INTEGER PRIMARY KEY AUTOINCREMENT, name TEXT UNIQUE NOT NULL)",
+                "CREATE TABLE IF NOT EXISTS Shelf (id INTEGER PRIMARY KEY AUTOINCREMENT, name TEXT UNIQUE NOT NULL)",
+                "CREATE TABLE IF NOT EXISTS AcquiredFrom (id INTEGER PRIMARY KEY AUTOINCREMENT, name TEXT UNIQUE NOT NULL)",
+                "CREATE TABLE IF NOT EXISTS Book ("
+                "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+                "title TEXT NOT NULL, "
+                "org_lang_id INTEGER, "
+                "country_id INTEGER, "
+                "type TEXT, "
+                "FOREIGN KEY(org_lang_id) REFERENCES Language(id), "
+                "FOREIGN KEY(country_id) REFERENCES Country(id))",
+                "CREATE TABLE IF NOT EXISTS Book2Author ("
+                "book_id INTEGER, "
+                "author_id INTEGER, "
+                "PRIMARY KEY(book_id, author_id), "
+                "FOREIGN KEY(book_id) REFERENCES Book(id), "
+                "FOREIGN KEY(author_id) REFERENCES Author(id))",
+                "CREATE TABLE IF NOT EXISTS Book2Genre ("
+                "book_id INTEGER, "
+                "genre_id INTEGER, "
+                "PRIMARY KEY(book_id, genre_id), "
+                "FOREIGN KEY(book_id) REFERENCES Book(id), "
+                "FOREIGN KEY(genre_id) REFERENCES Genre(id))",
+                "CREATE TABLE IF NOT EXISTS Edition ("
+                "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+                "book_id INTEGER NOT NULL, "
+                "publisher_id INTEGER NOT NULL, "
+                "language_id INTEGER, "
+                "series_id INTEGER, "
+                "page_count INTEGER, "
+                "publication_date TEXT, "
+                "isbn TEXT, "
+                "type TEXT, "
+                "cover_image_path TEXT, "
+                "FOREIGN KEY(book_id) REFERENCES Book(id), "
+                "FOREIGN KEY(publisher_id) REFERENCES Publisher(id), "
+                "FOREIGN KEY(language_id) REFERENCES Language(id), "
+                "FOREIGN KEY(series_id) REFERENCES Series(id))",
+                "CREATE TABLE IF NOT EXISTS RItem ("
+                "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+                "type INTEGER, " // Store enum as INTEGER, 0 for edition, 1 for issue
+                "edition_id INTEGER, "
+                "issue_id INTEGER, "
+                "FOREIGN KEY(edition_id) REFERENCES Edition(id), "
+                "FOREIGN KEY(issue_id) REFERENCES Issue(id))",
+                "CREATE TABLE IF NOT EXISTS MyLibrary ("
+                "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+                "r_item_id INTEGER NOT NULL, "
+                "acquired_from_id INTEGER, "
+                "acquired_date DATETIME, "
+                "price FLOAT, "
+                "shelf_id INTEGER, "
+                "created_at DATETIME DEFAULT CURRENT_TIMESTAMP, "
+                "notes TEXT, "
+                "FOREIGN KEY(r_item_id) REFERENCES RItem(id), "
+                "FOREIGN KEY(shelf_id) REFERENCES Shelf(id), "
+                "FOREIGN KEY(acquired_from_id) REFERENCES AcquiredFrom(id)"
+                ")",
+            }
+        },
+        {
+            2,
+            "Index the join paths",
+            {
+                "CREATE INDEX IF NOT EXISTS idx_Book2Author_author_id ON Book2Author(author_id)",
+                "CREATE INDEX IF NOT EXISTS idx_Book2Genre_genre_id ON Book2Genre(genre_id)",
+                "CREATE INDEX IF NOT EXISTS idx_Edition_book_id ON Edition(book_id)",
+                "CREATE INDEX IF NOT EXISTS idx_Edition_publisher_id ON Edition(publisher_id)",
+                "CREATE INDEX IF NOT EXISTS idx_RItem_edition_id ON RItem(edition_id)",
+                "CREATE INDEX IF NOT EXISTS idx_MyLibrary_r_item_id ON MyLibrary(r_item_id)",
+            }
+        },
+        {
+            3,
+            "Add the full-text search index",
+            {
+                "CREATE VIRTUAL TABLE IF NOT EXISTS SearchIndex USING fts5("
+                "kind UNINDEXED, " // 0 for a book, 1 for MyLibrary notes
+                "ref_id UNINDEXED, "
+                "title, authors, series, publishers, notes, "
+                "tokenize = 'unicode61 remove_diacritics 2', "
+                "prefix = '2 3')",
+                "CREATE INDEX IF NOT EXISTS idx_Edition_series_id ON Edition(series_id)",
+                TriggerSql("trg_Book_search_insert", "AFTER INSERT ON Book",
+                           IndexBooksSql("Book.id = NEW.id")),
+                TriggerSql("trg_Book_search_update", "AFTER UPDATE OF title ON Book",
+                           ReindexBooksSql("Book.id = NEW.id")),
+                TriggerSql("trg_Book_search_delete", "AFTER DELETE ON Book",
+                           "DELETE FROM SearchIndex WHERE rowid = OLD.id * 2"),
+                TriggerSql("trg_Book2Author_search_insert", "AFTER INSERT ON Book2Author",
+                           ReindexBooksSql("Book.id = NEW.book_id")),
+                TriggerSql("trg_Book2Author_search_delete", "AFTER DELETE ON Book2Author",
+                           ReindexBooksSql("Book.id = OLD.book_id")),
+                TriggerSql("trg_Author_search_update", "AFTER UPDATE OF name ON Author",
+                           ReindexBooksSql("Book.id IN (SELECT book_id FROM Book2Author WHERE author_id = NEW.id)")),
+                TriggerSql("trg_Edition_search_insert", "AFTER INSERT ON Edition",
+                           ReindexBooksSql("Book.id = NEW.book_id")),
+                TriggerSql("trg_Edition_search_update", "AFTER UPDATE OF book_id, publisher_id, series_id ON Edition",
+                           ReindexBooksSql("Book.id IN (OLD.book_id, NEW.book_id)")),
+                TriggerSql("trg_Edition_search_delete", "AFTER DELETE ON Edition",
+                           ReindexBooksSql("Book.id = OLD.book_id")),
+                TriggerSql("trg_Publisher_search_update", "AFTER UPDATE OF name ON Publisher",
+                           ReindexBooksSql("Book.id IN (SELECT book_id FROM Edition WHERE publisher_id = NEW.id)")),
+                TriggerSql("trg_Series_search_update", "AFTER UPDATE OF name ON Series",
+                           ReindexBooksSql("Book.id IN (SELECT book_id FROM Edition WHERE series_id = NEW.id)")),
+                TriggerSql("trg_MyLibrary_search_insert", "AFTER INSERT ON MyLibrary",
+                           IndexNotesSql("MyLibrary.id = NEW.id")),
+                TriggerSql("trg_MyLibrary_search_update", "AFTER UPDATE OF notes ON MyLibrary",
+                           "DELETE FROM SearchIndex WHERE rowid = OLD.id * 2 + 1; " + IndexNotesSql("MyLibrary.id = NEW.id")),
+                TriggerSql("trg_MyLibrary_search_delete", "AFTER DELETE ON MyLibrary",
+                           "DELETE FROM SearchIndex WHERE rowid = OLD.id * 2 + 1"),
+                // Backfill the rows written before the index existed
+                IndexBooksSql("1"),
+                IndexNotesSql("1"),
+            }
+        },
+        {
+            4,
+            "Index edition ISBNs",
+            {
+                "CREATE INDEX IF NOT EXISTS idx_Edition_isbn ON Edition(isbn)",
+            }
+        },
+        {
+            5,
+            "Map imported Calibre books",
+            {
+                "CREATE TABLE IF NOT EXISTS CalibreBookMap ("
+                "library_uuid TEXT NOT NULL, "
+                "calibre_book_id INTEGER NOT NULL, "
+                "book_id INTEGER NOT NULL, "
+                "edition_id INTEGER NOT NULL, "
+                "PRIMARY KEY(library_uuid, calibre_book_id), "
+                "FOREIGN KEY(book_id) REFERENCES Book(id), "
+                "FOREIGN KEY(edition_id) REFERENCES Edition(id)"
+                ") WITHOUT ROWID",
+            }
+        },
+        {
+            6,
+            "Index book titles for keyset pages",
+            {
+                // Pages sorted by title seek here, editions and items join through their book
+                "CREATE INDEX IF NOT EXISTS idx_Book_title ON Book(title)",
+            }
+        },
+        {
+            7,
+            "Suspend search indexing with a flag instead of dropping triggers",
+            {
+                // Dropping the triggers for every import batch changed the schema, which
+                // invalidates the prepared statements of every connection
+                "CREATE TABLE IF NOT EXISTS SearchIndexState ("
+                "id INTEGER PRIMARY KEY CHECK (id = 1), "
+                "suspended INTEGER NOT NULL DEFAULT 0)",
+                "INSERT OR IGNORE INTO SearchIndexState (id, suspended) VALUES (1, 0)",
+                "DROP TRIGGER IF EXISTS trg_Book_search_insert",
+                "DROP TRIGGER IF EXISTS trg_Book2Author_search_insert",
+                "DROP TRIGGER IF EXISTS trg_Edition_search_insert",
+                "DROP TRIGGER IF EXISTS trg_MyLibrary_search_insert",
+                TriggerSql("trg_Book_search_insert", "AFTER INSERT ON Book" + kIndexingNotSuspended,
+                           IndexBooksSql("Book.id = NEW.id")),
+                TriggerSql("trg_Book2Author_search_insert", "AFTER INSERT ON Book2Author" + kIndexingNotSuspended,
+                           ReindexBooksSql("Book.id = NEW.book_id")),
+                TriggerSql("trg_Edition_search_insert", "AFTER INSERT ON Edition" + kIndexingNotSuspended,
+                           ReindexBooksSql("Book.id = NEW.book_id")),
+                TriggerSql("trg_MyLibrary_search_insert", "AFTER INSERT ON MyLibrary" + kIndexingNotSuspended,
+                           IndexNotesSql("MyLibrary.id = NEW.id")),
+            }
+        },
+    };
+
+    return migrations;
+}
+
+bool SchemaMigrator::Apply(const SchemaMigration& migration)
+{
+    ScopedTransaction transaction(database_manager);
+    if (!transaction.IsActive()) {
+        qCritical() << "Migration" << migration.version << ": failed to begin transaction";
+        return false;
+    }
+
+    QSqlDatabase db = database_manager->GetDatabase();
+    QSqlQuery query(db);
+
+    for (const QString& statement : migration.statements) {
+        if (!query.exec(statement)) {
+            qCritical() << "Migration" << migration.version << ":" << query.lastError().text();
+            return false; // Rolled back by the transaction scope
+        }
+    }
+
+    // user_version is part of the database header, so it commits with the schema changes
+    if (!query.exec(QString("PRAGMA user_version = %1").arg(migration.version))) {
+        qCritical() << "Migration" << migration.version << ":" << query.lastError().text();
+        return false;
+    }
+
+    return transaction.Commit();
+}
@@ -0,0 +1,68 @@
+#ifndef SCHEMA_MIGRATOR_H
+#define SCHEMA_MIGRATOR_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+class DatabaseManager;
+
+/**
+ * @file schemamigrator.h
+ * @brief Header file for SchemaMigrator class.
+ *
+ * The database schema is versioned with PRAGMA user_version. Each migration
+ * moves the schema from the previous version to its own version and is
+ * applied exactly once, inside a transaction.
+ */
+
+struct SchemaMigration {
+    int version; ///< Schema version after the migration is applied
+    QString description; ///< Short description of the migration
+    QStringList statements; ///< SQL statements of the migration, applied in order
+};
+
+/**
+ * @class SchemaMigrator
+ * @brief Applies pending schema migrations to a database.
+ */
+class SchemaMigrator
+{
+public:
+    /**
+     * @brief Constructs a SchemaMigrator for the given database.
+     * 
+     * @param db_manager Pointer to the DatabaseManager instance.
+     */
+    explicit SchemaMigrator(DatabaseManager* db_manager);
+
+    /**
+     * @brief Applies all migrations newer than the current schema version.
+     * 
+     * @return true if the schema is up to date, false on failure.
+     */
+    bool Migrate();
+
+    /**
+     * @brief Get the schema version stored in the database.
+     * 
+     * @return int The current schema version, or -1 on failure.
+     */
+    int GetCurrentVersion() const;
+
+    /**
+     * @brief Get the schema version the migrations lead to.
+     * 
+     * @return int The latest schema version.
+     */
+    static int GetLatestVersion();
+
+private:
+    DatabaseManager* database_manager; ///< Pointer to the DatabaseManager instance.
+
+    static const QList<SchemaMigration>& Migrations(); ///< The ordered list of migrations.
+
+    bool Apply(const SchemaMigration& migration); ///< Applies a single migration in a transaction.
+};
+
+#endif // SCHEMA_MIGRATOR_H
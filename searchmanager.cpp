@@ -0,0 +1,191 @@
+#include "searchmanager.h"
+#include "databaseexecutor.h"
+#include "tracer.h"
+
+#include <QRegularExpression>
+
+SearchManager::SearchManager(DatabaseManager* db_manager)
+    : database_manager(db_manager)
+{
+    if (!database_manager || !database_manager->GetDatabase().isOpen()) {
+        qCritical() << "Database connection is not valid or open.";
+        return; // Database error
+    }
+}
+
+QList<SearchResult> SearchManager::Search(const QString& text, int limit) const
+{
+    RT_TRACE_SCOPE("db", "SearchManager::Search");
+
+    QList<SearchResult> results;
+
+    if (!database_manager || !database_manager->GetDatabase().isOpen()) {
+        qCritical() << "Database connection is not valid or open.";
+        return results;
+    }
+
+    QString match = MatchExpression(text);
+    if (match.isEmpty() || limit <= 0) {
+        return results;
+    }
+
+    // bm25 weights follow the column order: kind, ref_id, title, authors, series, publishers, notes
+    QSqlQuery* query = database_manager->GetCachedQuery(
+        "SELECT SearchIndex.kind, SearchIndex.ref_id, "
+        "COALESCE(SearchIndex.title, (SELECT Book.title FROM MyLibrary "
+        "JOIN RItem ON RItem.id = MyLibrary.r_item_id "
+        "JOIN Edition ON Edition.id = RItem.edition_id "
+        "JOIN Book ON Book.id = Edition.book_id "
+        "WHERE MyLibrary.id = SearchIndex.ref_id)), "
+        "snippet(SearchIndex, -1, '[', ']', '...', 12), "
+        "bm25(SearchIndex, 0.0, 0.0, 10.0, 5.0, 2.0, 2.0, 1.0) AS score "
+        "FROM SearchIndex WHERE SearchIndex MATCH :match "
+        "ORDER BY score LIMIT :limit");
+    if (!query) {
+        return results;
+    }
+
+    query->bindValue(":match", match);
+    query->bindValue(":limit", limit);
+
+    if (!database_manager->Exec(query)) {
+        qCritical() << "Search:" << query->lastError().text();
+        return results;
+    }
+
+    qint64 row_count = 0;
+    while (query->next()) {
+        row_count++;
+        SearchResult result;
+        result.kind = query->value(0).toInt() == 0 ? SearchResultKind::Book : SearchResultKind::Note;
+        result.id = query->value(1).toInt();
+        result.title = query->value(2).toString();
+        result.snippet = query->value(3).toString();
+        result.score = query->value(4).toDouble();
+        results.append(result);
+    }
+
+    database_manager->RecordRows(*query, row_count);
+
+    return results;
+}
+
+QFuture<QList<SearchResult>> SearchManager::SearchAsync(DatabaseExecutor* executor, const QString& text, int limit)
+{
+    return executor->Run([text, limit](Library& library) {
+        return library.search_manager->Search(text, limit);
+    });
+}
+
+bool SearchManager::SuspendIndexing()
+{
+    RT_TRACE_SCOPE("db", "SearchManager::SuspendIndexing");
+
+    if (!database_manager || !database_manager->GetDatabase().isOpen()) {
+        qCritical() << "Database connection is not valid or open.";
+        return false;
+    }
+
+    if (database_manager->GetTransactionDepth() == 0) {
+        qWarning() << "SuspendIndexing failed: no transaction is open";
+        return false;
+    }
+
+    // Only the triggers fired by inserts check the flag, the update triggers are used to reindex
+    QSqlQuery* query = database_manager->GetCachedQuery("UPDATE SearchIndexState SET suspended = 1 WHERE id = 1");
+    if (!query) {
+        return false;
+    }
+
+    if (!database_manager->Exec(query)) {
+        qCritical() << "SuspendIndexing:" << query->lastError().text();
+        return false; // Rolled back with the caller's transaction
+    }
+
+    return true;
+}
+
+bool SearchManager::ResumeIndexing(int first_book_id, int first_my_library_id)
+{
+    RT_TRACE_SCOPE("db", "SearchManager::ResumeIndexing");
+
+    if (!database_manager || !database_manager->GetDatabase().isOpen()) {
+        qCritical() << "Database connection is not valid or open.";
+        return false;
+    }
+
+    QSqlQuery* query = database_manager->GetCachedQuery("UPDATE SearchIndexState SET suspended = 0 WHERE id = 1");
+    if (!query) {
+        return false;
+    }
+
+    if (!database_manager->Exec(query)) {
+        qCritical() << "ResumeIndexing:" << query->lastError().text();
+        return false;
+    }
+
+    // Setting a column to itself fires its update trigger, which rebuilds the document once
+    if (first_book_id > 0) {
+        query = database_manager->GetCachedQuery("UPDATE Book SET title = title WHERE id >= :id");
+        if (!query) {
+            return false;
+        }
+        query->bindValue(":id", first_book_id);
+        if (!database_manager->Exec(query)) {
+            qCritical() << "ResumeIndexing:" << query->lastError().text();
+            return false;
+        }
+    }
+
+    if (first_my_library_id > 0) {
+        query = database_manager->GetCachedQuery("UPDATE MyLibrary SET notes = notes WHERE id >= :id AND notes IS NOT NULL");
+        if (!query) {
+            return false;
+        }
+        query->bindValue(":id", first_my_library_id);
+        if (!database_manager->Exec(query)) {
+            qCritical() << "ResumeIndexing:" << query->lastError().text();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool SearchManager::OptimizeIndex()
+{
+    RT_TRACE_SCOPE("db", "SearchManager::OptimizeIndex");
+
+    if (!database_manager || !database_manager->GetDatabase().isOpen()) {
+        qCritical() << "Database connection is not valid or open.";
+        return false;
+    }
+
+    QSqlQuery query(database_manager->GetDatabase());
+    if (!database_manager->Exec(query, "INSERT INTO SearchIndex (SearchIndex) VALUES ('optimize')")) {
+        qCritical() << "OptimizeIndex:" << query.lastError().text();
+        return false;
+    }
+
+    return true;
+}
+
+QString SearchManager::MatchExpression(const QString& text)
+{
+    static const QRegularExpression whitespace("\\s+");
+    const QStringList words = text.split(whitespace, Qt::SkipEmptyParts);
+
+    // Quoting every word keeps FTS5 operators and punctuation from being interpreted
+    QStringList terms;
+    for (const QString& word : words) {
+        QString term = word;
+        term.replace('"', "\"\"");
+        terms.append('"' + term + '"');
+    }
+
+    if (!terms.isEmpty()) {
+        terms.last() += '*';
+    }
+
+    return terms.join(' ');
+}
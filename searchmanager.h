@@ -0,0 +1,113 @@
+#ifndef SEARCH_MANAGER_H
+#define SEARCH_MANAGER_H
+
+#include "databasemanager.h"
+
+#include <QFuture>
+
+class DatabaseExecutor;
+
+/**
+ * @file searchmanager.h
+ * @brief Header file for SearchManager class.
+ *
+ * SearchManager runs ranked full-text queries against the SearchIndex FTS5
+ * table. The index holds one document per book (title, authors, series and
+ * publishers of its editions) and one per MyLibrary item with notes, and is
+ * kept in sync with the tables by triggers.
+ */
+
+/**
+ * @brief Kind of document a search result refers to.
+ */
+enum class SearchResultKind {
+    Book, ///< A book, id is the Book ID
+    Note ///< The notes of a library item, id is the MyLibrary ID
+};
+
+struct SearchResult {
+    SearchResultKind kind; ///< Kind of the matching document
+    int id; ///< ID of the book or library item
+    QString title; ///< Title of the book, or of the book of the library item
+    QString snippet; ///< Matching text with the matched terms in [brackets]
+    double score; ///< bm25 score, lower is more relevant
+};
+
+class SearchManager
+{
+public:
+    static constexpr int kDefaultLimit = 50; ///< Default number of results
+
+    /**
+     * @brief Constructs a SearchManager object.
+     * 
+     * @param db_manager Pointer to the DatabaseManager instance.
+     */
+    explicit SearchManager(DatabaseManager* db_manager);
+
+    /**
+     * @brief Searches the index, most relevant results first.
+     *
+     * Every word of the text must match; the last word also matches as a
+     * prefix so results show up while typing. Title matches weigh most,
+     * then authors, then series and publishers, then notes.
+     * 
+     * @param text The text to search for, FTS5 syntax is not interpreted.
+     * @param limit Maximum number of results.
+     * @return QList<SearchResult> The results, empty if nothing matches or on error.
+     */
+    QList<SearchResult> Search(const QString& text, int limit = kDefaultLimit) const;
+
+    /**
+     * @brief Searches the index on the database worker thread, see Search().
+     * 
+     * @param executor The executor to run the query on.
+     * @param text The text to search for.
+     * @param limit Maximum number of results.
+     * @return QFuture<QList<SearchResult>> The results.
+     */
+    static QFuture<QList<SearchResult>> SearchAsync(DatabaseExecutor* executor, const QString& text, int limit = kDefaultLimit);
+
+    /**
+     * @brief Converts typed text into an FTS5 query of quoted terms.
+     * 
+     * @param text The text to convert.
+     * @return QString The query, empty if the text has no words.
+     */
+    static QString MatchExpression(const QString& text);
+
+    /**
+     * @brief Stops the triggers that index inserted books and notes, for a bulk write.
+     *
+     * Sets the flag in SearchIndexState that the insert triggers check, so
+     * the schema, and with it every prepared statement, stays valid. Must be
+     * called inside a transaction, and ResumeIndexing() must be called in
+     * the same transaction before it commits. Indexing the new rows once at
+     * the end is much cheaper than rebuilding a book's document for every
+     * author and edition row inserted.
+     * 
+     * @return true on success, false on a database error.
+     */
+    bool SuspendIndexing();
+
+    /**
+     * @brief Clears the flag set by SuspendIndexing() and indexes the rows written meanwhile.
+     * 
+     * @param first_book_id First Book ID inserted while indexing was suspended, or -1 if none.
+     * @param first_my_library_id First MyLibrary ID inserted while indexing was suspended, or -1 if none.
+     * @return true on success, false on a database error.
+     */
+    bool ResumeIndexing(int first_book_id, int first_my_library_id);
+
+    /**
+     * @brief Merges the index segments, which bulk writes leave fragmented.
+     * 
+     * @return true on success, false on a database error.
+     */
+    bool OptimizeIndex();
+
+private:
+    DatabaseManager* database_manager; ///< Pointer to the DatabaseManager instance.
+};
+
+#endif // SEARCH_MANAGER_H
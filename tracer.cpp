@@ -0,0 +1,152 @@
+#include "tracer.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QThread>
+
+Tracer& Tracer::Instance()
+{
+    static Tracer tracer;
+    return tracer;
+}
+
+Tracer::Tracer()
+    : recording(false),
+      dropped_events(0)
+{
+    clock.start();
+}
+
+void Tracer::Start()
+{
+    QMutexLocker locker(&mutex);
+    events.clear();
+    dropped_events = 0;
+    recording.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::Stop()
+{
+    recording.store(false, std::memory_order_relaxed);
+}
+
+bool Tracer::IsRecording() const
+{
+    return recording.load(std::memory_order_relaxed);
+}
+
+qint64 Tracer::NowNs() const
+{
+    return clock.nsecsElapsed();
+}
+
+void Tracer::Record(const char* category, const char* name, const QString& detail, qint64 start_ns, qint64 duration_ns)
+{
+    QThread* thread = QThread::currentThread();
+
+    QMutexLocker locker(&mutex);
+    if (events.size() >= kMaxEvents) {
+        dropped_events++;
+        return;
+    }
+
+    auto it = thread_ids.constFind(thread);
+    int thread_id;
+    if (it != thread_ids.constEnd()) {
+        thread_id = it.value();
+    }
+    else {
+        // Named threads such as the database workers keep their names in the trace
+        QString thread_name = thread->objectName();
+        if (thread_name.isEmpty()) {
+            bool main_thread = QCoreApplication::instance() && thread == QCoreApplication::instance()->thread();
+            thread_name = main_thread ? QString("Main") : QString("Thread %1").arg(thread_names.size());
+        }
+        thread_id = thread_names.size();
+        thread_names.append(thread_name);
+        thread_ids.insert(thread, thread_id);
+    }
+
+    events.append(TraceEvent{category, name, detail, start_ns, duration_ns, thread_id});
+}
+
+int Tracer::WriteChromeTrace(const QString& path) const
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCritical() << "Cannot write the trace" << path << ":" << file.errorString();
+        return -1;
+    }
+
+    QMutexLocker locker(&mutex);
+    const qint64 pid = QCoreApplication::applicationPid();
+
+    // One event per line keeps large traces diffable and greppable
+    file.write("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    auto write_event = [&file, &first](const QJsonObject& event) {
+        if (!first) {
+            file.write(",\n");
+        }
+        first = false;
+        file.write(QJsonDocument(event).toJson(QJsonDocument::Compact));
+    };
+
+    for (int thread_id = 0; thread_id < thread_names.size(); ++thread_id) {
+        write_event(QJsonObject{
+            {"name", "thread_name"}, {"ph", "M"}, {"pid", pid}, {"tid", thread_id},
+            {"args", QJsonObject{{"name", thread_names.at(thread_id)}}},
+        });
+    }
+
+    // Complete ("X") events in microseconds, nested by time on each thread
+    for (const TraceEvent& event : events) {
+        QJsonObject object{
+            {"name", event.name}, {"cat", event.category}, {"ph", "X"}, {"pid", pid}, {"tid", event.thread_id},
+            {"ts", event.start_ns / 1000.0}, {"dur", event.duration_ns / 1000.0},
+        };
+        if (!event.detail.isEmpty()) {
+            object.insert("args", QJsonObject{{"detail", event.detail}});
+        }
+        write_event(object);
+    }
+
+    file.write("\n]}\n");
+
+    if (dropped_events > 0) {
+        qWarning() << "Trace was limited to" << kMaxEvents << "spans," << dropped_events << "were dropped";
+    }
+
+    if (!file.commit()) {
+        qCritical() << "Cannot write the trace" << path << ":" << file.errorString();
+        return -1;
+    }
+
+    return events.size();
+}
+
+TraceScope::TraceScope(const char* category, const char* name, const QString& detail)
+    : category(category),
+      name(name),
+      detail(detail),
+      start_ns(-1)
+{
+    Tracer& tracer = Tracer::Instance();
+    if (tracer.IsRecording()) {
+        start_ns = tracer.NowNs();
+    }
+}
+
+TraceScope::~TraceScope()
+{
+    if (start_ns < 0) {
+        return; // Not recording when the span began
+    }
+
+    Tracer& tracer = Tracer::Instance();
+    tracer.Record(category, name, detail, start_ns, tracer.NowNs() - start_ns);
+}
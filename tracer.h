@@ -0,0 +1,153 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <atomic>
+
+class QThread;
+
+/**
+ * @file tracer.h
+ * @brief Header file for Tracer and TraceScope, and the RT_TRACE_SCOPE macros.
+ *
+ * Scoped spans time UI slots, refreshes, manager methods and statements, and
+ * Tracer writes them as Chrome trace-event JSON that chrome://tracing and
+ * ui.perfetto.dev open as a flame chart per thread.
+ *
+ * The macros compile to nothing unless READING_TRACKER_ENABLE_TRACING is
+ * defined (CMake option of the same name). When compiled in, a span costs
+ * one atomic load while the tracer is not recording.
+ */
+
+/**
+ * @brief One completed span.
+ */
+struct TraceEvent {
+    const char* category; ///< Category, e.g. "ui", "db" or "sql"
+    const char* name; ///< Span name, e.g. "MainWindow::RefreshAll"
+    QString detail; ///< Optional detail, e.g. the SQL text of a statement
+    qint64 start_ns; ///< Start time since the tracer was created
+    qint64 duration_ns; ///< Duration
+    int thread_id; ///< Index of the thread in the trace
+};
+
+/**
+ * @class Tracer
+ * @brief Process-wide, thread-safe recorder of trace spans.
+ */
+class Tracer
+{
+public:
+#if defined(READING_TRACKER_ENABLE_TRACING)
+    static constexpr bool kCompiledIn = true; ///< Whether the RT_TRACE_SCOPE macros record spans in this build
+#else
+    static constexpr bool kCompiledIn = false; ///< Whether the RT_TRACE_SCOPE macros record spans in this build
+#endif
+
+    static constexpr int kMaxEvents = 1000000; ///< Spans kept per recording, later ones are counted as dropped
+
+    /**
+     * @brief Get the process-wide tracer.
+     *
+     * @return Tracer& The tracer.
+     */
+    static Tracer& Instance();
+
+    /**
+     * @brief Drops the recorded spans and starts recording.
+     */
+    void Start();
+
+    /**
+     * @brief Stops recording, the recorded spans are kept until the next Start().
+     */
+    void Stop();
+
+    /**
+     * @brief Checks whether spans are being recorded.
+     *
+     * @return true while recording.
+     */
+    bool IsRecording() const;
+
+    /**
+     * @brief Get the time on the tracer's clock.
+     *
+     * @return qint64 Nanoseconds since the tracer was created.
+     */
+    qint64 NowNs() const;
+
+    /**
+     * @brief Records a completed span on the calling thread.
+     *
+     * @param category Category of the span, must be a string literal.
+     * @param name Name of the span, must be a string literal.
+     * @param detail Optional detail shown in the span's arguments.
+     * @param start_ns Start time from NowNs().
+     * @param duration_ns Duration.
+     */
+    void Record(const char* category, const char* name, const QString& detail, qint64 start_ns, qint64 duration_ns);
+
+    /**
+     * @brief Writes the recorded spans as Chrome trace-event JSON.
+     *
+     * @param path Path of the trace file, usually ending in .json.
+     * @return int Number of spans written, -1 on error.
+     */
+    int WriteChromeTrace(const QString& path) const;
+
+private:
+    Tracer();
+
+    QElapsedTimer clock; ///< Monotonic clock started when the tracer is created
+    std::atomic<bool> recording; ///< Whether spans are recorded
+    mutable QMutex mutex; ///< Guards the members below
+    QVector<TraceEvent> events; ///< Spans of the current recording
+    quint64 dropped_events; ///< Spans over kMaxEvents that were not kept
+    QHash<QThread*, int> thread_ids; ///< Index in the trace by thread
+    QStringList thread_names; ///< Thread names by index
+};
+
+/**
+ * @class TraceScope
+ * @brief Records a span from its construction to its destruction. Use through RT_TRACE_SCOPE.
+ */
+class TraceScope
+{
+public:
+    TraceScope(const char* category, const char* name, const QString& detail = QString());
+    ~TraceScope();
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* category; ///< Category of the span
+    const char* name; ///< Name of the span
+    QString detail; ///< Detail of the span
+    qint64 start_ns; ///< Start time, -1 when the tracer was not recording
+};
+
+#define RT_TRACE_CONCAT_INNER(a, b) a##b
+#define RT_TRACE_CONCAT(a, b) RT_TRACE_CONCAT_INNER(a, b)
+
+#if defined(READING_TRACKER_ENABLE_TRACING)
+/// Records a span over the rest of the enclosing block.
+#define RT_TRACE_SCOPE(category, name) \
+    TraceScope RT_TRACE_CONCAT(rt_trace_scope_, __LINE__)(category, name)
+/// Records a span with a detail, which is only evaluated while recording.
+#define RT_TRACE_SCOPE_DETAIL(category, name, detail) \
+    TraceScope RT_TRACE_CONCAT(rt_trace_scope_, __LINE__)(category, name, \
+        Tracer::Instance().IsRecording() ? QString(detail) : QString())
+#else
+#define RT_TRACE_SCOPE(category, name) static_cast<void>(0)
+#define RT_TRACE_SCOPE_DETAIL(category, name, detail) static_cast<void>(0)
+#endif
+
+#endif // TRACER_H